@@ -0,0 +1,332 @@
+/* aiv-benchmark.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib/gstdio.h>
+
+#include "benchmark-utils.h"
+#include "gtk-crusader-village-stats.h"
+
+#define SKIP_EXIT 77
+
+static const char *load_stages[] = {
+  "map.aiv-load.spawn",
+  "map.aiv-load.convert",
+  "map.aiv-load.json-parse",
+  "map.aiv-load.gvariant",
+  "map.aiv-load.strokes",
+  "map.aiv-load",
+};
+
+static const char *save_stages[] = {
+  "map.aiv-save.json",
+  "map.aiv-save.spawn",
+  "map.aiv-save.convert",
+  "map.aiv-save",
+};
+
+static char  *python_exe  = NULL;
+static char  *module_dir  = NULL;
+static char **aiv_corpora = NULL;
+static int    iterations  = 3;
+
+static void
+collect_fixtures (const char *path,
+                  gboolean    include_json,
+                  GPtrArray  *fixtures);
+
+static int
+compare_paths (gconstpointer a,
+               gconstpointer b);
+
+static char *
+convert_json_fixture (const char *json_path,
+                      const char *tmp_dir,
+                      GError    **error);
+
+static gboolean
+run_fixture (GcvItemStore *store,
+             const char   *aiv_path,
+             const char   *tmp_dir,
+             GError      **error);
+
+static void
+print_stages (const char  *title,
+              const char **stages,
+              guint        n_stages);
+
+static void
+async_done (GObject      *object,
+            GAsyncResult *result,
+            gpointer      user_data);
+
+static GAsyncResult *
+wait_for_result (GAsyncResult **slot);
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (GOptionContext) context = NULL;
+  g_autoptr (GError) local_error     = NULL;
+  g_autoptr (GPtrArray) fixtures     = NULL;
+  g_autoptr (GcvItemStore) store     = NULL;
+  g_autofree char *tmp_dir           = NULL;
+  gboolean failed                    = FALSE;
+
+  GOptionEntry entries[] = {
+    { "python", 'p', 0, G_OPTION_ARG_FILENAME, &python_exe,
+      "The python executable with Sourcehold available", "PATH" },
+    { "module-dir", 'm', 0, G_OPTION_ARG_FILENAME, &module_dir,
+      "A directory to add to PYTHONPATH", "DIR" },
+    { "aiv-corpus", 'a', 0, G_OPTION_ARG_FILENAME_ARRAY, &aiv_corpora,
+      "A directory to search for AIV files only", "DIR" },
+    { "iterations", 'n', 0, G_OPTION_ARG_INT, &iterations,
+      "How many times to load and save each fixture", "N" },
+    { NULL }
+  };
+
+  context = g_option_context_new ("FIXTURE... - time each stage of AIV import and export");
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &local_error))
+    {
+      g_printerr ("%s\n", local_error->message);
+      return 1;
+    }
+  if (python_exe == NULL)
+    python_exe = g_strdup ("python3");
+  iterations = MAX (iterations, 1);
+
+  fixtures = g_ptr_array_new_with_free_func (g_free);
+  for (int i = 1; i < argc; i++)
+    collect_fixtures (argv[i], TRUE, fixtures);
+  for (char **corpus = aiv_corpora; corpus != NULL && *corpus != NULL; corpus++)
+    collect_fixtures (*corpus, FALSE, fixtures);
+  if (fixtures->len == 0)
+    {
+      g_printerr ("No fixtures found, skipping\n");
+      return SKIP_EXIT;
+    }
+  g_ptr_array_sort (fixtures, compare_paths);
+
+  tmp_dir = g_dir_make_tmp ("gcv-aiv-benchmark-XXXXXX", &local_error);
+  if (tmp_dir == NULL)
+    {
+      g_printerr ("%s\n", local_error->message);
+      return 1;
+    }
+
+  /* The results are read back from the stats */
+  gcv_stats_enable ();
+  store = gcv_benchmark_load_items ();
+
+  for (guint i = 0; i < fixtures->len; i++)
+    {
+      const char      *fixture   = NULL;
+      g_autofree char *converted = NULL;
+
+      fixture = g_ptr_array_index (fixtures, i);
+      g_print ("%s\n", fixture);
+
+      if (g_str_has_suffix (fixture, ".json"))
+        {
+          /* The load path only takes AIV files, so convert
+           * ahead of time and leave that out of the numbers.
+           */
+          converted = convert_json_fixture (fixture, tmp_dir, &local_error);
+          if (converted == NULL)
+            {
+              g_printerr ("  could not convert: %s\n", local_error->message);
+              g_clear_error (&local_error);
+              failed = TRUE;
+              continue;
+            }
+        }
+
+      gcv_stats_reset ();
+      if (!run_fixture (store, converted != NULL ? converted : fixture, tmp_dir, &local_error))
+        {
+          g_printerr ("  failed: %s\n", local_error->message);
+          g_clear_error (&local_error);
+          failed = TRUE;
+        }
+      else
+        {
+          print_stages ("load", load_stages, G_N_ELEMENTS (load_stages));
+          print_stages ("save", save_stages, G_N_ELEMENTS (save_stages));
+        }
+
+      if (converted != NULL)
+        g_remove (converted);
+    }
+
+  g_rmdir (tmp_dir);
+  g_clear_pointer (&python_exe, g_free);
+  g_clear_pointer (&module_dir, g_free);
+  g_clear_pointer (&aiv_corpora, g_strfreev);
+
+  return failed ? 1 : 0;
+}
+
+static void
+collect_fixtures (const char *path,
+                  gboolean    include_json,
+                  GPtrArray  *fixtures)
+{
+  g_autoptr (GDir) dir = NULL;
+  const char *name     = NULL;
+
+  if (!g_file_test (path, G_FILE_TEST_IS_DIR))
+    {
+      if (g_file_test (path, G_FILE_TEST_IS_REGULAR))
+        g_ptr_array_add (fixtures, g_strdup (path));
+      return;
+    }
+
+  /* An uninitialized submodule is just an empty directory */
+  dir = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree char *child = NULL;
+
+      child = g_build_filename (path, name, NULL);
+      if (g_file_test (child, G_FILE_TEST_IS_DIR))
+        collect_fixtures (child, include_json, fixtures);
+      else if (g_str_has_suffix (name, ".aiv") ||
+               (include_json && g_str_has_suffix (name, ".json")))
+        g_ptr_array_add (fixtures, g_steal_pointer (&child));
+    }
+}
+
+static int
+compare_paths (gconstpointer a,
+               gconstpointer b)
+{
+  return g_strcmp0 (*(const char *const *) a, *(const char *const *) b);
+}
+
+static char *
+convert_json_fixture (const char *json_path,
+                      const char *tmp_dir,
+                      GError    **error)
+{
+  g_autofree char *basename                = NULL;
+  g_autofree char *aiv_path                = NULL;
+  g_autoptr (GSubprocessLauncher) launcher = NULL;
+  g_autoptr (GSubprocess) sourcehold       = NULL;
+
+  basename = g_path_get_basename (json_path);
+  aiv_path = g_strdup_printf ("%s%c%s.aiv", tmp_dir, G_DIR_SEPARATOR, basename);
+
+  launcher = g_subprocess_launcher_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE | G_SUBPROCESS_FLAGS_STDERR_SILENCE);
+  if (module_dir != NULL)
+    g_subprocess_launcher_setenv (launcher, "PYTHONPATH", module_dir, TRUE);
+  sourcehold = g_subprocess_launcher_spawn (
+      launcher,
+      error,
+      python_exe, "-m", "sourcehold", "convert", "aiv", "--input", json_path, "--output", aiv_path,
+      NULL);
+  if (sourcehold == NULL)
+    return NULL;
+  if (!g_subprocess_wait_check (sourcehold, NULL, error))
+    return NULL;
+
+  return g_steal_pointer (&aiv_path);
+}
+
+static gboolean
+run_fixture (GcvItemStore *store,
+             const char   *aiv_path,
+             const char   *tmp_dir,
+             GError      **error)
+{
+  g_autoptr (GFile) file   = NULL;
+  g_autoptr (GFile) output = NULL;
+  g_autofree char *path    = NULL;
+
+  file   = g_file_new_for_path (aiv_path);
+  path   = g_build_filename (tmp_dir, "output.aiv", NULL);
+  output = g_file_new_for_path (path);
+
+  for (int i = 0; i < iterations; i++)
+    {
+      g_autoptr (GAsyncResult) load_result = NULL;
+      g_autoptr (GAsyncResult) save_result = NULL;
+      g_autoptr (GcvMap) map               = NULL;
+
+      gcv_map_new_from_aiv_file_async (
+          file, store, python_exe, module_dir,
+          G_PRIORITY_DEFAULT, NULL, async_done, &load_result);
+      map = gcv_map_new_from_aiv_file_finish (wait_for_result (&load_result), error);
+      if (map == NULL)
+        return FALSE;
+
+      gcv_map_save_to_aiv_file_async (
+          map, output, python_exe, module_dir,
+          G_PRIORITY_DEFAULT, NULL, async_done, &save_result);
+      if (!gcv_map_save_to_aiv_file_finish (wait_for_result (&save_result), error))
+        return FALSE;
+    }
+
+  g_file_delete (output, NULL, NULL);
+  return TRUE;
+}
+
+static void
+print_stages (const char  *title,
+              const char **stages,
+              guint        n_stages)
+{
+  for (guint i = 0; i < n_stages; i++)
+    {
+      gint64 samples = 0;
+      gint64 total   = 0;
+      gint64 max     = 0;
+
+      if (!gcv_stats_lookup (stages[i], &samples, &total, &max) || samples == 0)
+        continue;
+
+      g_print ("  %-4s %-26s %12.1f %12" G_GINT64_FORMAT "\n",
+               title, stages[i], (double) total / samples, max);
+    }
+}
+
+static void
+async_done (GObject      *object,
+            GAsyncResult *result,
+            gpointer      user_data)
+{
+  GAsyncResult **slot = user_data;
+
+  *slot = g_object_ref (result);
+}
+
+static GAsyncResult *
+wait_for_result (GAsyncResult **slot)
+{
+  while (*slot == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  return *slot;
+}
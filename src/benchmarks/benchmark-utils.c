@@ -0,0 +1,258 @@
+/* benchmark-utils.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "benchmark-utils.h"
+#include "gtk-crusader-village-item-stroke.h"
+
+static gboolean
+try_place (guint8 *occupied,
+           int     size,
+           int     x,
+           int     y,
+           int     w,
+           int     h);
+
+const char *
+gcv_benchmark_scene_to_string (GcvBenchmarkScene scene)
+{
+  switch (scene)
+    {
+    case GCV_BENCHMARK_SCENE_EMPTY:
+      return "empty";
+    case GCV_BENCHMARK_SCENE_WALLS:
+      return "walls";
+    case GCV_BENCHMARK_SCENE_UNITS:
+      return "units";
+    case GCV_BENCHMARK_SCENE_MIXED:
+      return "mixed";
+    default:
+      return "unknown";
+    }
+}
+
+GcvItemStore *
+gcv_benchmark_load_items (void)
+{
+  GcvItemStore *store = NULL;
+
+  store = g_object_new (GCV_TYPE_ITEM_STORE, NULL);
+  gcv_item_store_load_builtin (store);
+
+  return store;
+}
+
+GcvItem *
+gcv_benchmark_find_item (GcvItemStore *store,
+                         GcvItemKind   kind,
+                         int           max_size)
+{
+  guint n_items = 0;
+
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (store));
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr (GcvItem) item = NULL;
+      GcvItemKind item_kind    = 0;
+      int         tile_width   = 0;
+      int         tile_height  = 0;
+
+      item = g_list_model_get_item (G_LIST_MODEL (store), i);
+      g_object_get (
+          item,
+          "kind", &item_kind,
+          "tile-width", &tile_width,
+          "tile-height", &tile_height,
+          NULL);
+
+      if (item_kind == kind &&
+          tile_width <= max_size &&
+          tile_height <= max_size)
+        return g_steal_pointer (&item);
+    }
+
+  return NULL;
+}
+
+GcvMap *
+gcv_benchmark_build_map (GcvItemStore     *store,
+                         GcvBenchmarkScene scene,
+                         int               size,
+                         guint             n_strokes,
+                         guint32           seed)
+{
+  g_autoptr (GcvMap) map          = NULL;
+  g_autoptr (GListStore) strokes  = NULL;
+  g_autoptr (GRand) rand          = NULL;
+  g_autofree guint8 *occupied     = NULL;
+  g_autoptr (GPtrArray) buildings = NULL;
+  g_autoptr (GcvItem) wall        = NULL;
+  g_autoptr (GcvItem) unit        = NULL;
+  guint n_items                   = 0;
+
+  map = g_object_new (
+      GCV_TYPE_MAP,
+      "name", gcv_benchmark_scene_to_string (scene),
+      "width", size,
+      "height", size,
+      NULL);
+  if (scene == GCV_BENCHMARK_SCENE_EMPTY)
+    return g_steal_pointer (&map);
+
+  g_object_get (
+      map,
+      "strokes", &strokes,
+      NULL);
+
+  rand     = g_rand_new_with_seed (seed);
+  occupied = g_malloc0_n (size * size, sizeof (*occupied));
+  wall     = gcv_benchmark_find_item (store, GCV_ITEM_KIND_WALL, 1);
+  unit     = gcv_benchmark_find_item (store, GCV_ITEM_KIND_UNIT, 1);
+
+  buildings = g_ptr_array_new_with_free_func (g_object_unref);
+  n_items   = g_list_model_get_n_items (G_LIST_MODEL (store));
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr (GcvItem) item = NULL;
+      GcvItemKind kind         = 0;
+
+      item = g_list_model_get_item (G_LIST_MODEL (store), i);
+      g_object_get (
+          item,
+          "kind", &kind,
+          NULL);
+      if (kind == GCV_ITEM_KIND_BUILDING)
+        g_ptr_array_add (buildings, g_steal_pointer (&item));
+    }
+
+  for (guint i = 0; i < n_strokes; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      GcvItem *item                    = NULL;
+      int      tile_width              = 0;
+      int      tile_height             = 0;
+      gboolean wall_stroke             = FALSE;
+
+      switch (scene)
+        {
+        case GCV_BENCHMARK_SCENE_WALLS:
+          item = wall;
+          break;
+        case GCV_BENCHMARK_SCENE_UNITS:
+          item = unit;
+          break;
+        case GCV_BENCHMARK_SCENE_MIXED:
+          if (buildings->len > 0 && g_rand_int_range (rand, 0, 3) == 0)
+            item = g_ptr_array_index (buildings, g_rand_int_range (rand, 0, buildings->len));
+          else
+            item = g_rand_boolean (rand) ? wall : unit;
+          break;
+        case GCV_BENCHMARK_SCENE_EMPTY:
+        default:
+          g_assert_not_reached ();
+        }
+      if (item == NULL)
+        continue;
+
+      g_object_get (
+          item,
+          "tile-width", &tile_width,
+          "tile-height", &tile_height,
+          NULL);
+      wall_stroke = item == wall;
+
+      stroke = g_object_new (
+          GCV_TYPE_ITEM_STROKE,
+          "item", item,
+          NULL);
+
+      if (wall_stroke)
+        {
+          int      x          = 0;
+          int      y          = 0;
+          int      length     = 0;
+          gboolean horizontal = FALSE;
+
+          /* A straight run, like a real wall */
+          x          = g_rand_int_range (rand, 0, size);
+          y          = g_rand_int_range (rand, 0, size);
+          length     = g_rand_int_range (rand, 4, 40);
+          horizontal = g_rand_boolean (rand);
+
+          for (int j = 0; j < length; j++)
+            {
+              int tx = horizontal ? x + j : x;
+              int ty = horizontal ? y : y + j;
+
+              if (tx >= size || ty >= size)
+                break;
+              if (try_place (occupied, size, tx, ty, 1, 1))
+                gcv_item_stroke_add_instance (stroke, (GcvItemStrokeInstance) { tx, ty });
+            }
+        }
+      else
+        {
+          int n_instances = 0;
+
+          n_instances = tile_width == 1 && tile_height == 1
+                            ? g_rand_int_range (rand, 1, 20)
+                            : 1;
+
+          for (int j = 0; j < n_instances; j++)
+            {
+              int x = 0;
+              int y = 0;
+
+              x = g_rand_int_range (rand, 0, size - tile_width + 1);
+              y = g_rand_int_range (rand, 0, size - tile_height + 1);
+
+              /* Units may stand anywhere */
+              if (item == unit ||
+                  try_place (occupied, size, x, y, tile_width, tile_height))
+                gcv_item_stroke_add_instance (stroke, (GcvItemStrokeInstance) { x, y });
+            }
+        }
+
+      g_list_store_append (strokes, stroke);
+    }
+
+  return g_steal_pointer (&map);
+}
+
+static gboolean
+try_place (guint8 *occupied,
+           int     size,
+           int     x,
+           int     y,
+           int     w,
+           int     h)
+{
+  for (int dy = 0; dy < h; dy++)
+    for (int dx = 0; dx < w; dx++)
+      if (occupied[(y + dy) * size + (x + dx)] != 0)
+        return FALSE;
+
+  for (int dy = 0; dy < h; dy++)
+    for (int dx = 0; dx < w; dx++)
+      occupied[(y + dy) * size + (x + dx)] = 1;
+
+  return TRUE;
+}
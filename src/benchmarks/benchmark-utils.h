@@ -0,0 +1,54 @@
+/* benchmark-utils.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "gtk-crusader-village-item-store.h"
+#include "gtk-crusader-village-map.h"
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GCV_BENCHMARK_SCENE_EMPTY,
+  GCV_BENCHMARK_SCENE_WALLS,
+  GCV_BENCHMARK_SCENE_UNITS,
+  GCV_BENCHMARK_SCENE_MIXED,
+} GcvBenchmarkScene;
+
+const char *
+gcv_benchmark_scene_to_string (GcvBenchmarkScene scene);
+
+GcvItemStore *
+gcv_benchmark_load_items (void);
+
+GcvItem *
+gcv_benchmark_find_item (GcvItemStore *store,
+                         GcvItemKind   kind,
+                         int           max_size);
+
+GcvMap *
+gcv_benchmark_build_map (GcvItemStore     *store,
+                         GcvBenchmarkScene scene,
+                         int               size,
+                         guint             n_strokes,
+                         guint32           seed);
+
+G_END_DECLS
@@ -0,0 +1,662 @@
+/* core-benchmark.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <json-glib/json-glib.h>
+
+#include "benchmark-utils.h"
+#include "gtk-crusader-village-item-stroke.h"
+#include "gtk-crusader-village-map-handle.h"
+
+#define MAP_SIZE         400
+#define SEED             1337
+#define MIN_RUN_TIME_US  (G_USEC_PER_SEC / 4)
+#define MIN_RUNS         3
+#define MAX_RUNS         10000
+#define N_APPENDS        64
+#define N_REORDERS       256
+#define MAX_SLOWDOWN     2.0
+#define MAX_ALLOC_GROWTH 1.5
+#define ALLOC_SLACK      1.0
+#define SKIP_EXIT        77
+
+typedef struct
+{
+  gint64  begin_time;
+  gsize   begin_allocs;
+  gint64  elapsed;
+  gsize   allocs;
+  guint64 ops;
+} Measure;
+
+typedef void (*CaseFunc) (GcvItemStore *store,
+                          guint         n_strokes,
+                          Measure      *measure);
+
+typedef struct
+{
+  const char *name;
+  CaseFunc    func;
+} Case;
+
+static void
+bench_stroke_add_instance (GcvItemStore *store,
+                           guint         n_strokes,
+                           Measure      *measure);
+
+static void
+bench_handle_cache_rebuild (GcvItemStore *store,
+                            guint         n_strokes,
+                            Measure      *measure);
+
+static void
+bench_handle_cache_append (GcvItemStore *store,
+                           guint         n_strokes,
+                           Measure      *measure);
+
+static void
+bench_undo_redo (GcvItemStore *store,
+                 guint         n_strokes,
+                 Measure      *measure);
+
+static void
+bench_reorder (GcvItemStore *store,
+               guint         n_strokes,
+               Measure      *measure);
+
+static void
+bench_compact (GcvItemStore *store,
+               guint         n_strokes,
+               Measure      *measure);
+
+static void
+bench_accessibility_mask (GcvItemStore *store,
+                          guint         n_strokes,
+                          Measure      *measure);
+
+static gboolean
+check_baseline (JsonObject *baseline,
+                const char *key,
+                double      ops_per_sec,
+                double      allocs_per_op);
+
+static GcvMapHandle *
+new_handle (GcvMap *map);
+
+static const Case cases[] = {
+  {  "stroke-add-instance",  bench_stroke_add_instance },
+  { "handle-cache-rebuild", bench_handle_cache_rebuild },
+  {  "handle-cache-append",  bench_handle_cache_append },
+  {            "undo-redo",            bench_undo_redo },
+  {              "reorder",              bench_reorder },
+  {              "compact",              bench_compact },
+  {   "accessibility-mask",   bench_accessibility_mask },
+};
+
+static const guint sizes[] = { 10, 100, 1000, 10000 };
+
+/* Bumped from any thread that allocates, GLib and GTK
+ * have worker threads of their own
+ */
+static gsize n_allocs = 0;
+
+#ifdef __GLIBC__
+/* Count allocations by interposing the allocator. GLib dropped
+ * g_mem_set_vtable () so this is the only reliable way to see them.
+ */
+#define HAVE_ALLOC_COUNTING 1
+
+#include <malloc.h>
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb,
+                            size_t size);
+extern void *__libc_realloc (void  *ptr,
+                             size_t size);
+extern void *__libc_memalign (size_t alignment,
+                              size_t size);
+
+void *
+malloc (size_t size)
+{
+  g_atomic_pointer_add (&n_allocs, 1);
+  return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb,
+        size_t size)
+{
+  g_atomic_pointer_add (&n_allocs, 1);
+  return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void  *ptr,
+         size_t size)
+{
+  g_atomic_pointer_add (&n_allocs, 1);
+  return __libc_realloc (ptr, size);
+}
+
+int
+posix_memalign (void **memptr,
+                size_t alignment,
+                size_t size)
+{
+  void *ptr = NULL;
+
+  if (alignment % sizeof (void *) != 0 ||
+      (alignment & (alignment - 1)) != 0 ||
+      alignment == 0)
+    return EINVAL;
+
+  g_atomic_pointer_add (&n_allocs, 1);
+  ptr = __libc_memalign (alignment, size);
+  if (ptr == NULL)
+    return ENOMEM;
+
+  *memptr = ptr;
+  return 0;
+}
+
+void *
+aligned_alloc (size_t alignment,
+               size_t size)
+{
+  g_atomic_pointer_add (&n_allocs, 1);
+  return __libc_memalign (alignment, size);
+}
+
+void *
+memalign (size_t alignment,
+          size_t size)
+{
+  g_atomic_pointer_add (&n_allocs, 1);
+  return __libc_memalign (alignment, size);
+}
+#endif
+
+static inline void
+measure_begin (Measure *measure)
+{
+  measure->begin_allocs = g_atomic_pointer_get (&n_allocs);
+  measure->begin_time   = g_get_monotonic_time ();
+}
+
+static inline void
+measure_end (Measure *measure,
+             guint    ops)
+{
+  measure->elapsed += g_get_monotonic_time () - measure->begin_time;
+  measure->allocs += g_atomic_pointer_get (&n_allocs) - measure->begin_allocs;
+  measure->ops += ops;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (GOptionContext) context   = NULL;
+  g_autoptr (GError) local_error       = NULL;
+  g_autofree char *baseline_path       = NULL;
+  g_autofree char *write_baseline_path = NULL;
+  g_autoptr (JsonParser) parser        = NULL;
+  JsonObject *baseline                 = NULL;
+  g_autoptr (JsonBuilder) builder      = NULL;
+  g_autoptr (GcvItemStore) store       = NULL;
+  gboolean regressed                   = FALSE;
+  gboolean no_baseline                 = FALSE;
+
+  GOptionEntry entries[] = {
+    { "baseline", 'b', 0, G_OPTION_ARG_FILENAME, &baseline_path,
+      "Fail on regressions against the results in FILE", "FILE" },
+    { "write-baseline", 'w', 0, G_OPTION_ARG_FILENAME, &write_baseline_path,
+      "Write the results to FILE for use as a baseline", "FILE" },
+    { NULL }
+  };
+
+  context = g_option_context_new ("- benchmark the core data structures");
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &local_error))
+    {
+      g_printerr ("%s\n", local_error->message);
+      return 1;
+    }
+
+  if (baseline_path != NULL)
+    {
+      JsonNode *root = NULL;
+
+      parser = json_parser_new_immutable ();
+      if (!json_parser_load_from_file (parser, baseline_path, &local_error))
+        {
+          g_printerr ("Could not load baseline: %s\n", local_error->message);
+          return 1;
+        }
+
+      root = json_parser_get_root (parser);
+      if (root != NULL && JSON_NODE_HOLDS_OBJECT (root))
+        baseline = json_node_get_object (root);
+
+      /* Asking for a comparison against nothing is a mistake */
+      if (baseline == NULL || json_object_get_size (baseline) == 0)
+        {
+          g_printerr ("%s has no results\n", baseline_path);
+          return 1;
+        }
+    }
+  else if (write_baseline_path == NULL)
+    {
+      /* Don't report a pass when nothing was compared */
+      g_printerr ("No baseline given, results are not compared. "
+                  "Configure with -Dcore_baseline=FILE to compare\n");
+      no_baseline = TRUE;
+    }
+
+#ifndef HAVE_ALLOC_COUNTING
+  g_printerr ("Allocation counting is unavailable on this platform\n");
+#endif
+
+  store = gcv_benchmark_load_items ();
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+
+  g_print ("%-22s %7s %14s %14s\n",
+           "case", "strokes", "ops/sec", "allocs/op");
+
+  for (guint i = 0; i < G_N_ELEMENTS (cases); i++)
+    {
+      for (guint j = 0; j < G_N_ELEMENTS (sizes); j++)
+        {
+          g_autofree char *key  = NULL;
+          Measure measure       = { 0 };
+          double  ops_per_sec   = 0.0;
+          double  allocs_per_op = 0.0;
+
+          for (guint run = 0;
+               run < MIN_RUNS || (measure.elapsed < MIN_RUN_TIME_US && run < MAX_RUNS);
+               run++)
+            cases[i].func (store, sizes[j], &measure);
+
+          ops_per_sec   = (double) measure.ops * G_USEC_PER_SEC / MAX (measure.elapsed, 1);
+          allocs_per_op = (double) measure.allocs / MAX (measure.ops, 1);
+
+          key = g_strdup_printf ("%s/%u", cases[i].name, sizes[j]);
+          g_print ("%-22s %7u %14.1f %14.2f\n",
+                   cases[i].name, sizes[j], ops_per_sec, allocs_per_op);
+
+          json_builder_set_member_name (builder, key);
+          json_builder_begin_object (builder);
+          json_builder_set_member_name (builder, "ops-per-sec");
+          json_builder_add_double_value (builder, ops_per_sec);
+          json_builder_set_member_name (builder, "allocs-per-op");
+          json_builder_add_double_value (builder, allocs_per_op);
+          json_builder_end_object (builder);
+
+          if (baseline != NULL &&
+              !check_baseline (baseline, key, ops_per_sec, allocs_per_op))
+            regressed = TRUE;
+        }
+    }
+
+  json_builder_end_object (builder);
+
+  if (write_baseline_path != NULL)
+    {
+      g_autoptr (JsonGenerator) generator = NULL;
+      g_autoptr (JsonNode) root           = NULL;
+
+      root      = json_builder_get_root (builder);
+      generator = json_generator_new ();
+      json_generator_set_pretty (generator, TRUE);
+      json_generator_set_root (generator, root);
+
+      if (!json_generator_to_file (generator, write_baseline_path, &local_error))
+        {
+          g_printerr ("Could not write baseline: %s\n", local_error->message);
+          return 1;
+        }
+    }
+
+  if (regressed)
+    return 1;
+  return no_baseline ? SKIP_EXIT : 0;
+}
+
+static gboolean
+check_baseline (JsonObject *baseline,
+                const char *key,
+                double      ops_per_sec,
+                double      allocs_per_op)
+{
+  JsonObject *entry                = NULL;
+  double      baseline_ops_per_sec = 0.0;
+  double      baseline_allocs      = 0.0;
+  gboolean    result               = TRUE;
+
+  /* The baseline is stale if it misses a case */
+  if (!json_object_has_member (baseline, key))
+    {
+      g_printerr ("%s: not in the baseline, regenerate it\n", key);
+      return FALSE;
+    }
+
+  entry                = json_object_get_object_member (baseline, key);
+  baseline_ops_per_sec = json_object_get_double_member_with_default (entry, "ops-per-sec", 0.0);
+  baseline_allocs      = json_object_get_double_member_with_default (entry, "allocs-per-op", 0.0);
+
+  if (ops_per_sec * MAX_SLOWDOWN < baseline_ops_per_sec)
+    {
+      g_printerr ("%s: %.1f ops/sec, baseline is %.1f\n",
+                  key, ops_per_sec, baseline_ops_per_sec);
+      result = FALSE;
+    }
+
+#ifdef HAVE_ALLOC_COUNTING
+  if (baseline_allocs > 0.0 &&
+      allocs_per_op > baseline_allocs * MAX_ALLOC_GROWTH + ALLOC_SLACK)
+    {
+      g_printerr ("%s: %.2f allocs/op, baseline is %.2f\n",
+                  key, allocs_per_op, baseline_allocs);
+      result = FALSE;
+    }
+#endif
+
+  return result;
+}
+
+static GcvMapHandle *
+new_handle (GcvMap *map)
+{
+  return g_object_new (
+      GCV_TYPE_MAP_HANDLE,
+      "map", map,
+      NULL);
+}
+
+static void
+bench_stroke_add_instance (GcvItemStore *store,
+                           guint         n_strokes,
+                           Measure      *measure)
+{
+  g_autoptr (GcvItem) wall         = NULL;
+  g_autoptr (GcvItemStroke) stroke = NULL;
+  g_autoptr (GRand) rand           = NULL;
+  g_autofree guint *order          = NULL;
+
+  /* Here the size is the number of instances in a single stroke */
+  wall   = gcv_benchmark_find_item (store, GCV_ITEM_KIND_WALL, 1);
+  stroke = g_object_new (
+      GCV_TYPE_ITEM_STROKE,
+      "item", wall,
+      NULL);
+
+  rand  = g_rand_new_with_seed (SEED);
+  order = g_malloc_n (n_strokes, sizeof (*order));
+  for (guint i = 0; i < n_strokes; i++)
+    order[i] = i;
+  for (guint i = n_strokes - 1; i > 0; i--)
+    {
+      guint j   = 0;
+      guint tmp = 0;
+
+      j        = g_rand_int_range (rand, 0, i + 1);
+      tmp      = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+
+  measure_begin (measure);
+  for (guint i = 0; i < n_strokes; i++)
+    gcv_item_stroke_add_instance (
+        stroke,
+        (GcvItemStrokeInstance) {
+            order[i] % MAP_SIZE,
+            order[i] / MAP_SIZE,
+        });
+  measure_end (measure, n_strokes);
+
+  {
+    g_autoptr (GArray) instances = NULL;
+
+    g_object_get (
+        stroke,
+        "instances", &instances,
+        NULL);
+    g_assert_cmpuint (instances->len, ==, n_strokes);
+  }
+}
+
+static void
+bench_handle_cache_rebuild (GcvItemStore *store,
+                            guint         n_strokes,
+                            Measure      *measure)
+{
+  g_autoptr (GcvMap) map          = NULL;
+  g_autoptr (GcvMapHandle) handle = NULL;
+  g_autoptr (GHashTable) grid     = NULL;
+
+  map    = gcv_benchmark_build_map (store, GCV_BENCHMARK_SCENE_MIXED, MAP_SIZE, n_strokes, SEED);
+  handle = new_handle (map);
+
+  measure_begin (measure);
+  g_object_get (
+      handle,
+      "grid", &grid,
+      NULL);
+  measure_end (measure, 1);
+
+  g_assert_nonnull (grid);
+  g_assert_cmpuint (g_hash_table_size (grid), >, 0);
+}
+
+static void
+bench_handle_cache_append (GcvItemStore *store,
+                           guint         n_strokes,
+                           Measure      *measure)
+{
+  g_autoptr (GcvMap) map          = NULL;
+  g_autoptr (GcvMapHandle) handle = NULL;
+  g_autoptr (GListStore) strokes  = NULL;
+  g_autoptr (GHashTable) warm     = NULL;
+  g_autoptr (GcvItem) unit        = NULL;
+  g_autoptr (GRand) rand          = NULL;
+
+  map    = gcv_benchmark_build_map (store, GCV_BENCHMARK_SCENE_MIXED, MAP_SIZE, n_strokes, SEED);
+  handle = new_handle (map);
+  unit   = gcv_benchmark_find_item (store, GCV_ITEM_KIND_UNIT, 1);
+  rand   = g_rand_new_with_seed (SEED);
+  g_object_get (
+      map,
+      "strokes", &strokes,
+      NULL);
+
+  /* Warm the cache so only the incremental path is measured */
+  g_object_get (
+      handle,
+      "grid", &warm,
+      NULL);
+
+  for (guint i = 0; i < N_APPENDS; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GHashTable) grid      = NULL;
+
+      stroke = g_object_new (
+          GCV_TYPE_ITEM_STROKE,
+          "item", unit,
+          NULL);
+      gcv_item_stroke_add_instance (
+          stroke,
+          (GcvItemStrokeInstance) {
+              g_rand_int_range (rand, 0, MAP_SIZE),
+              g_rand_int_range (rand, 0, MAP_SIZE),
+          });
+
+      measure_begin (measure);
+      g_list_store_append (strokes, stroke);
+      g_object_get (
+          handle,
+          "grid", &grid,
+          NULL);
+      measure_end (measure, 1);
+
+      g_assert_nonnull (grid);
+    }
+}
+
+static void
+bench_undo_redo (GcvItemStore *store,
+                 guint         n_strokes,
+                 Measure      *measure)
+{
+  g_autoptr (GcvMap) source       = NULL;
+  g_autoptr (GcvMap) map          = NULL;
+  g_autoptr (GcvMapHandle) handle = NULL;
+  g_autoptr (GListStore) read     = NULL;
+  g_autoptr (GListStore) strokes  = NULL;
+  guint n_items                   = 0;
+
+  source = gcv_benchmark_build_map (store, GCV_BENCHMARK_SCENE_MIXED, MAP_SIZE, n_strokes, SEED);
+  map    = gcv_benchmark_build_map (store, GCV_BENCHMARK_SCENE_EMPTY, MAP_SIZE, 0, SEED);
+  handle = new_handle (map);
+  g_object_get (
+      source,
+      "strokes", &read,
+      NULL);
+  g_object_get (
+      map,
+      "strokes", &strokes,
+      NULL);
+
+  /* Append one at a time so every stroke is its own undo step */
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (read));
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+
+      stroke = g_list_model_get_item (G_LIST_MODEL (read), i);
+      g_list_store_append (strokes, stroke);
+    }
+
+  measure_begin (measure);
+  while (gcv_map_handle_can_undo (handle))
+    gcv_map_handle_undo (handle);
+  while (gcv_map_handle_can_redo (handle))
+    gcv_map_handle_redo (handle);
+  measure_end (measure, n_items * 2);
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (strokes)), ==, n_items);
+}
+
+static void
+bench_reorder (GcvItemStore *store,
+               guint         n_strokes,
+               Measure      *measure)
+{
+  g_autoptr (GcvMap) map          = NULL;
+  g_autoptr (GcvMapHandle) handle = NULL;
+  g_autoptr (GListModel) model    = NULL;
+  g_autoptr (GRand) rand          = NULL;
+  guint n_items                   = 0;
+
+  map    = gcv_benchmark_build_map (store, GCV_BENCHMARK_SCENE_MIXED, MAP_SIZE, n_strokes, SEED);
+  handle = new_handle (map);
+  rand   = g_rand_new_with_seed (SEED);
+  g_object_get (
+      handle,
+      "model", &model,
+      NULL);
+
+  n_items = g_list_model_get_n_items (model);
+  if (n_items < 2)
+    return;
+
+  measure_begin (measure);
+  for (guint i = 0; i < N_REORDERS; i++)
+    {
+      guint length       = 0;
+      guint position     = 0;
+      guint new_position = 0;
+
+      /* Pick a destination outside of the moved range */
+      length       = g_rand_int_range (rand, 1, MIN (8, n_items - 1) + 1);
+      position     = g_rand_int_range (rand, 0, n_items - length + 1);
+      new_position = g_rand_int_range (rand, 0, n_items - length);
+      if (new_position >= position)
+        new_position += length + 1;
+
+      gcv_map_handle_reorder (handle, position, length, new_position);
+    }
+  measure_end (measure, N_REORDERS);
+
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, n_items);
+}
+
+static void
+bench_compact (GcvItemStore *store,
+               guint         n_strokes,
+               Measure      *measure)
+{
+  g_autoptr (GcvMap) map          = NULL;
+  g_autoptr (GcvMapHandle) handle = NULL;
+  g_autoptr (GListModel) model    = NULL;
+  guint n_items                   = 0;
+
+  /* Like an imported AIV, every unit is its own stroke */
+  map    = gcv_benchmark_build_map (store, GCV_BENCHMARK_SCENE_UNITS, MAP_SIZE, n_strokes, SEED);
+  handle = new_handle (map);
+  g_object_get (
+      handle,
+      "model", &model,
+      NULL);
+  n_items = g_list_model_get_n_items (model);
+
+  measure_begin (measure);
+  if (gcv_map_handle_compact (handle) > 0)
+    gcv_map_handle_undo (handle);
+  measure_end (measure, 1);
+
+  /* Undoing the merge must restore every stroke */
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, n_items);
+}
+
+static void
+bench_accessibility_mask (GcvItemStore *store,
+                          guint         n_strokes,
+                          Measure      *measure)
+{
+  g_autoptr (GcvMap) map          = NULL;
+  g_autoptr (GcvMapHandle) handle = NULL;
+  g_autofree guint8 *mask         = NULL;
+
+  map    = gcv_benchmark_build_map (store, GCV_BENCHMARK_SCENE_MIXED, MAP_SIZE, n_strokes, SEED);
+  handle = new_handle (map);
+
+  measure_begin (measure);
+  mask = gcv_map_handle_get_accessibilty_mask (handle);
+  measure_end (measure, 1);
+
+  g_assert_nonnull (mask);
+}
@@ -0,0 +1,340 @@
+/* core-test.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "benchmark-utils.h"
+#include "gtk-crusader-village-item-stroke.h"
+#include "gtk-crusader-village-map-handle.h"
+
+#define MAP_SIZE 200
+#define SEED     1337
+
+/* One placed instance in timeline order */
+typedef struct
+{
+  GcvItem              *item;
+  GcvItemStrokeInstance instance;
+} Placement;
+
+static GcvItemStore *store = NULL;
+
+static const guint sizes[] = { 100, 1000 };
+
+static GcvMapHandle *
+new_handle (GcvMap *map);
+
+static GArray *
+flatten (GListModel *model);
+
+static void
+assert_grids_equal (GHashTable *a,
+                    GHashTable *b);
+
+static void
+assert_planes_match_grid (GcvMapHandle *handle);
+
+static void
+test_compact (void);
+
+static void
+test_stroke_truncate (void);
+
+static void
+test_placement_planes (void);
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  store = gcv_benchmark_load_items ();
+
+  g_test_add_func ("/core/compact", test_compact);
+  g_test_add_func ("/core/stroke-truncate", test_stroke_truncate);
+  g_test_add_func ("/core/placement-planes", test_placement_planes);
+
+  return g_test_run ();
+}
+
+static GcvMapHandle *
+new_handle (GcvMap *map)
+{
+  return g_object_new (
+      GCV_TYPE_MAP_HANDLE,
+      "map", map,
+      NULL);
+}
+
+static GArray *
+flatten (GListModel *model)
+{
+  g_autoptr (GArray) placements = NULL;
+  guint n_items                 = 0;
+
+  placements = g_array_new (FALSE, FALSE, sizeof (Placement));
+  n_items    = g_list_model_get_n_items (model);
+
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GcvItem) item         = NULL;
+      g_autoptr (GArray) instances     = NULL;
+
+      stroke = g_list_model_get_item (model, i);
+      g_object_get (
+          stroke,
+          "item", &item,
+          "instances", &instances,
+          NULL);
+
+      for (guint j = 0; j < instances->len; j++)
+        {
+          Placement placement = { 0 };
+
+          /* The store keeps the items alive */
+          placement.item     = item;
+          placement.instance = g_array_index (instances, GcvItemStrokeInstance, j);
+          g_array_append_val (placements, placement);
+        }
+    }
+
+  return g_steal_pointer (&placements);
+}
+
+static void
+assert_grids_equal (GHashTable *a,
+                    GHashTable *b)
+{
+  GHashTableIter iter  = { 0 };
+  gpointer       key   = NULL;
+  gpointer       value = NULL;
+
+  g_assert_cmpuint (g_hash_table_size (a), ==, g_hash_table_size (b));
+
+  g_hash_table_iter_init (&iter, a);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    g_assert_true (g_hash_table_lookup (b, key) == value);
+}
+
+static void
+assert_planes_match_grid (GcvMapHandle *handle)
+{
+  g_autoptr (GHashTable) grid = NULL;
+  const guint64 *occupied     = NULL;
+  guint          stride       = 0;
+
+  g_object_get (
+      handle,
+      "grid", &grid,
+      NULL);
+  occupied = gcv_map_handle_get_occupied_plane (handle, &stride);
+  g_assert_cmpuint (stride, ==, (MAP_SIZE + 63) / 64);
+
+  for (int y = 0; y < MAP_SIZE; y++)
+    {
+      for (int x = 0; x < MAP_SIZE; x++)
+        {
+          GcvItem *item = NULL;
+          guint64  bit  = 0;
+
+          item = g_hash_table_lookup (grid, GUINT_TO_POINTER (y * MAP_SIZE + x));
+          bit  = G_GUINT64_CONSTANT (1) << (x % 64);
+
+          g_assert_cmpint (
+              (occupied[y * stride + x / 64] & bit) != 0, ==,
+              item != NULL);
+
+          /* Exactly the kind of the item owning the tile */
+          for (GcvItemKind kind = GCV_ITEM_KIND_BUILDING; kind <= GCV_ITEM_KIND_MOAT; kind++)
+            {
+              const guint64 *plane = NULL;
+
+              plane = gcv_map_handle_get_kind_plane (handle, kind, NULL);
+              g_assert_cmpint (
+                  (plane[y * stride + x / 64] & bit) != 0, ==,
+                  item != NULL && gcv_item_get_info (item)->kind == kind);
+            }
+        }
+    }
+}
+
+static void
+test_compact (void)
+{
+  for (guint i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      g_autoptr (GcvMap) map          = NULL;
+      g_autoptr (GcvMapHandle) handle = NULL;
+      g_autoptr (GListModel) model    = NULL;
+      g_autoptr (GHashTable) before   = NULL;
+      g_autoptr (GHashTable) after    = NULL;
+      g_autoptr (GArray) placements   = NULL;
+      g_autoptr (GArray) compacted    = NULL;
+      guint n_items                   = 0;
+      guint mergeable                 = 0;
+
+      map    = gcv_benchmark_build_map (store, GCV_BENCHMARK_SCENE_MIXED, MAP_SIZE, sizes[i], SEED);
+      handle = new_handle (map);
+      g_object_get (
+          handle,
+          "model", &model,
+          "grid", &before,
+          NULL);
+      n_items    = g_list_model_get_n_items (model);
+      placements = flatten (model);
+
+      /* The cursor starts past the end, so every run of
+       * the same item should collapse into its first stroke
+       */
+      for (guint j = 1; j < n_items; j++)
+        {
+          g_autoptr (GcvItemStroke) prev = NULL;
+          g_autoptr (GcvItemStroke) next = NULL;
+          g_autoptr (GcvItem) prev_item  = NULL;
+          g_autoptr (GcvItem) next_item  = NULL;
+
+          prev = g_list_model_get_item (model, j - 1);
+          next = g_list_model_get_item (model, j);
+          g_object_get (
+              prev,
+              "item", &prev_item,
+              NULL);
+          g_object_get (
+              next,
+              "item", &next_item,
+              NULL);
+          if (prev_item != NULL && prev_item == next_item)
+            mergeable++;
+        }
+      g_assert_cmpuint (mergeable, >, 0);
+
+      g_assert_cmpuint (gcv_map_handle_compact (handle), ==, mergeable);
+      g_assert_cmpuint (g_list_model_get_n_items (model), ==, n_items - mergeable);
+
+      /* Merging only joins neighbors, every instance
+       * stays where it was in the timeline
+       */
+      compacted = flatten (model);
+      g_assert_cmpuint (compacted->len, ==, placements->len);
+      g_assert_cmpmem (compacted->data, compacted->len * sizeof (Placement),
+                       placements->data, placements->len * sizeof (Placement));
+
+      g_object_get (
+          handle,
+          "grid", &after,
+          NULL);
+      assert_grids_equal (before, after);
+      assert_planes_match_grid (handle);
+
+      /* A second pass has nothing left to merge */
+      g_assert_cmpuint (gcv_map_handle_compact (handle), ==, 0);
+
+      gcv_map_handle_undo (handle);
+      g_assert_cmpuint (g_list_model_get_n_items (model), ==, n_items);
+    }
+}
+
+static void
+test_stroke_truncate (void)
+{
+  g_autoptr (GcvItem) wall = NULL;
+
+  wall = gcv_benchmark_find_item (store, GCV_ITEM_KIND_WALL, 1);
+  g_assert_nonnull (wall);
+
+  /* Small strokes scan their instances, large ones keep
+   * a tile set, so test on both sides of the switch
+   */
+  for (guint i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GArray) instances     = NULL;
+      guint keep                       = 0;
+
+      stroke = g_object_new (
+          GCV_TYPE_ITEM_STROKE,
+          "item", wall,
+          NULL);
+
+      for (guint j = 0; j < sizes[i]; j++)
+        g_assert_true (gcv_item_stroke_add_instance (
+            stroke, (GcvItemStrokeInstance) { j % MAP_SIZE, j / MAP_SIZE }));
+
+      keep = sizes[i] / 2;
+      gcv_item_stroke_truncate (stroke, keep);
+      /* Growing is not what truncating does */
+      gcv_item_stroke_truncate (stroke, sizes[i]);
+
+      g_object_get (
+          stroke,
+          "instances", &instances,
+          NULL);
+      g_assert_cmpuint (instances->len, ==, keep);
+
+      /* Dropped tiles are free again, kept ones are not */
+      g_assert_false (gcv_item_stroke_add_instance (
+          stroke, (GcvItemStrokeInstance) { 0, 0 }));
+      g_assert_true (gcv_item_stroke_add_instance (
+          stroke, (GcvItemStrokeInstance) { keep % MAP_SIZE, keep / MAP_SIZE }));
+      g_assert_false (gcv_item_stroke_add_instance (
+          stroke, (GcvItemStrokeInstance) { keep % MAP_SIZE, keep / MAP_SIZE }));
+    }
+}
+
+static void
+test_placement_planes (void)
+{
+  for (guint i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      g_autoptr (GcvMap) map          = NULL;
+      g_autoptr (GcvMapHandle) handle = NULL;
+      g_autoptr (GListStore) strokes  = NULL;
+      g_autoptr (GcvItem) wall        = NULL;
+      g_autoptr (GcvItemStroke) late  = NULL;
+
+      map    = gcv_benchmark_build_map (store, GCV_BENCHMARK_SCENE_MIXED, MAP_SIZE, sizes[i], SEED);
+      handle = new_handle (map);
+      g_object_get (
+          map,
+          "strokes", &strokes,
+          NULL);
+
+      assert_planes_match_grid (handle);
+
+      /* Covering a tile moves it to the new owner's plane,
+       * and that goes through the incremental path
+       */
+      wall = gcv_benchmark_find_item (store, GCV_ITEM_KIND_WALL, 1);
+      late = g_object_new (
+          GCV_TYPE_ITEM_STROKE,
+          "item", wall,
+          NULL);
+      for (int x = 0; x < MAP_SIZE; x++)
+        gcv_item_stroke_add_instance (late, (GcvItemStrokeInstance) { x, MAP_SIZE / 2 });
+      g_list_store_append (strokes, late);
+
+      assert_planes_match_grid (handle);
+
+      gcv_map_handle_undo (handle);
+      assert_planes_match_grid (handle);
+    }
+}
@@ -0,0 +1,301 @@
+/* render-benchmark.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+
+#include "benchmark-utils.h"
+#include "gtk-crusader-village-map-editor.h"
+#include "gtk-crusader-village-map-handle.h"
+#include "gtk-crusader-village-stats.h"
+
+#define N_ITERATIONS 20
+#define SKIP_EXIT    77
+#define VIEW_WIDTH   1280
+#define VIEW_HEIGHT  800
+
+typedef struct
+{
+  GcvBenchmarkScene scene;
+  int               size;
+  guint             n_strokes;
+} SceneSpec;
+
+static const SceneSpec scenes[] = {
+  {  GCV_BENCHMARK_SCENE_EMPTY, 100,    0 },
+  {  GCV_BENCHMARK_SCENE_WALLS, 100,  400 },
+  {  GCV_BENCHMARK_SCENE_UNITS, 100,  400 },
+  {  GCV_BENCHMARK_SCENE_MIXED, 100, 3000 },
+  {  GCV_BENCHMARK_SCENE_MIXED, 400, 5000 },
+};
+
+static const double zooms[] = { 0.25, 1.0, 3.0, 6.0 };
+
+static void
+allocate_view (GtkWidget *view);
+
+static GskRenderNode *
+take_snapshot (GtkWidget *editor);
+
+static void
+force_rebuild (GtkWidget *editor);
+
+static void
+wait_for_rebuild (gint64 previous);
+
+static gint64
+count_rebuilds (void);
+
+static double
+mean_time (const char *name);
+
+static void
+run_scene (GtkWidget       *editor,
+           GskRenderer     *renderer,
+           GcvItemStore    *store,
+           const SceneSpec *spec);
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (GcvItemStore) store   = NULL;
+  g_autoptr (GskRenderer) renderer = NULL;
+  g_autoptr (GError) local_error   = NULL;
+  GtkWidget *scrolled_window       = NULL;
+  GtkWidget *editor                = NULL;
+
+  /* Widgets still need a GdkDisplay even though nothing is
+   * ever shown. GTK 4 has no headless backend, so machines
+   * without Wayland or X11 have to run a Broadway server.
+   */
+  if (!gtk_init_check ())
+    {
+      g_printerr ("No display backend available, skipping\n");
+      return SKIP_EXIT;
+    }
+
+  /* The results are read back from the stats */
+  gcv_stats_enable ();
+  store = gcv_benchmark_load_items ();
+
+  editor          = g_object_new (GCV_TYPE_MAP_EDITOR, NULL);
+  scrolled_window = g_object_ref_sink (gtk_scrolled_window_new ());
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (scrolled_window), editor);
+  allocate_view (scrolled_window);
+
+  /* Render offscreen, and keep the numbers comparable
+   * between machines by always using cairo
+   */
+  renderer = gsk_cairo_renderer_new ();
+  if (!gsk_renderer_realize (renderer, NULL, &local_error))
+    {
+      g_printerr ("Could not realize renderer, skipping: %s\n", local_error->message);
+      g_object_unref (scrolled_window);
+      return SKIP_EXIT;
+    }
+
+  g_print ("%-6s %5s %6s %5s %12s %12s %12s %8s\n",
+           "scene", "size", "strokes", "zoom",
+           "rebuild-us", "cached-us", "raster-us", "nodes");
+
+  for (guint i = 0; i < G_N_ELEMENTS (scenes); i++)
+    run_scene (editor, renderer, store, scenes + i);
+
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (scrolled_window);
+
+  return 0;
+}
+
+static void
+allocate_view (GtkWidget *view)
+{
+  int min_width  = 0;
+  int min_height = 0;
+
+  gtk_widget_measure (view, GTK_ORIENTATION_HORIZONTAL, -1, &min_width, NULL, NULL, NULL);
+  gtk_widget_measure (view, GTK_ORIENTATION_VERTICAL, -1, &min_height, NULL, NULL, NULL);
+  gtk_widget_allocate (
+      view,
+      MAX (min_width, VIEW_WIDTH),
+      MAX (min_height, VIEW_HEIGHT),
+      -1, NULL);
+}
+
+static GskRenderNode *
+take_snapshot (GtkWidget *editor)
+{
+  g_autoptr (GtkSnapshot) snapshot = NULL;
+
+  /* The editor is never mapped, so draw its child layers
+   * directly instead of through gtk_widget_snapshot_child ()
+   */
+  snapshot = gtk_snapshot_new ();
+  for (GtkWidget *child = gtk_widget_get_first_child (editor);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    GTK_WIDGET_GET_CLASS (child)->snapshot (child, snapshot);
+
+  return gtk_snapshot_free_to_node (g_steal_pointer (&snapshot));
+}
+
+static void
+force_rebuild (GtkWidget *editor)
+{
+  gboolean draw_after_cursor = FALSE;
+
+  /* The cursor sits at the end of the timeline, so this invalidates
+   * the render cache without changing what gets drawn.
+   */
+  g_object_get (
+      editor,
+      "draw-after-cursor", &draw_after_cursor,
+      NULL);
+  g_object_set (
+      editor,
+      "draw-after-cursor", !draw_after_cursor,
+      NULL);
+}
+
+static gint64
+count_rebuilds (void)
+{
+  gint64 samples = 0;
+
+  gcv_stats_lookup ("editor.render-cache.rebuild", &samples, NULL, NULL);
+  return samples;
+}
+
+static void
+wait_for_rebuild (gint64 previous)
+{
+  /* Rebuilds finish on worker threads, so the snapshot
+   * that started one may still show the old cache
+   */
+  while (count_rebuilds () == previous)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static double
+mean_time (const char *name)
+{
+  gint64 samples = 0;
+  gint64 total   = 0;
+
+  if (!gcv_stats_lookup (name, &samples, &total, NULL) || samples == 0)
+    return 0.0;
+
+  return (double) total / (double) samples;
+}
+
+static void
+run_scene (GtkWidget       *editor,
+           GskRenderer     *renderer,
+           GcvItemStore    *store,
+           const SceneSpec *spec)
+{
+  g_autoptr (GcvMap) map          = NULL;
+  g_autoptr (GcvMapHandle) handle = NULL;
+
+  map    = gcv_benchmark_build_map (store, spec->scene, spec->size, spec->n_strokes, 1337);
+  handle = g_object_new (
+      GCV_TYPE_MAP_HANDLE,
+      "map", map,
+      NULL);
+  g_object_set (
+      editor,
+      "map-handle", handle,
+      NULL);
+
+  for (guint i = 0; i < G_N_ELEMENTS (zooms); i++)
+    {
+      g_autoptr (GskRenderNode) node = NULL;
+      double  rebuild_us             = 0.0;
+      double  cached_us              = 0.0;
+      gint64  raster_total           = 0;
+      gint64  nodes                  = 0;
+      gint64  rebuilds               = 0;
+
+      g_object_set (
+          editor,
+          "zoom", zooms[i],
+          NULL);
+
+      /* Let the adjustments settle for the new zoom level */
+      allocate_view (gtk_widget_get_parent (editor));
+      while (g_main_context_pending (NULL))
+        g_main_context_iteration (NULL, FALSE);
+
+      /* Warm up the label and grid caches */
+      gcv_stats_reset ();
+      force_rebuild (editor);
+      node = take_snapshot (editor);
+      wait_for_rebuild (0);
+
+      gcv_stats_reset ();
+      for (guint j = 0; j < N_ITERATIONS; j++)
+        {
+          gint64 previous = 0;
+
+          previous = count_rebuilds ();
+          g_clear_pointer (&node, gsk_render_node_unref);
+          force_rebuild (editor);
+          node = take_snapshot (editor);
+          wait_for_rebuild (previous);
+        }
+      rebuild_us = mean_time ("editor.render-cache.rebuild");
+      gcv_stats_lookup ("editor.render-cache.nodes", &rebuilds, &nodes, NULL);
+
+      gcv_stats_reset ();
+      for (guint j = 0; j < N_ITERATIONS; j++)
+        {
+          g_clear_pointer (&node, gsk_render_node_unref);
+          node = take_snapshot (editor);
+        }
+      cached_us = mean_time ("editor.snapshot");
+
+      for (guint j = 0; j < N_ITERATIONS; j++)
+        {
+          g_autoptr (GdkTexture) texture = NULL;
+          gint64 begin_time              = 0;
+
+          begin_time = g_get_monotonic_time ();
+          texture    = gsk_renderer_render_texture (renderer, node, NULL);
+          raster_total += g_get_monotonic_time () - begin_time;
+        }
+
+      g_print ("%-6s %5d %6u %5.2f %12.1f %12.1f %12.1f %8" G_GINT64_FORMAT "\n",
+               gcv_benchmark_scene_to_string (spec->scene),
+               spec->size,
+               spec->n_strokes,
+               zooms[i],
+               rebuild_us,
+               cached_us,
+               (double) raster_total / N_ITERATIONS,
+               rebuilds > 0 ? nodes / rebuilds : 0);
+    }
+
+  g_object_set (
+      editor,
+      "map-handle", NULL,
+      NULL);
+}
@@ -27,9 +27,11 @@
 #include "gtk-crusader-village-brushable.h"
 #include "gtk-crusader-village-dialog-window.h"
 #include "gtk-crusader-village-image-mask-brush.h"
+#include "gtk-crusader-village-item-stroke.h"
 #include "gtk-crusader-village-map.h"
 #include "gtk-crusader-village-preferences-window.h"
 #include "gtk-crusader-village-square-brush.h"
+#include "gtk-crusader-village-stamp.h"
 #include "gtk-crusader-village-window.h"
 
 #if defined(__APPLE__) || defined(G_OS_WIN32)
@@ -55,6 +57,7 @@ struct _GcvApplication
   GcvItemStore *item_store;
 
   GListStore *brush_store;
+  GListStore *stamp_store;
 
   GtkCssProvider *custom_css;
   GtkCssProvider *shc_theme_light_css;
@@ -157,6 +160,7 @@ gcv_application_dispose (GObject *object)
 
   g_clear_object (&self->item_store);
   g_clear_object (&self->brush_store);
+  g_clear_object (&self->stamp_store);
 
   g_clear_object (&self->custom_css);
   g_clear_object (&self->shc_theme_light_css);
@@ -196,6 +200,7 @@ gcv_application_activate (GApplication *app)
         "application", app,
         "item-store", self->item_store,
         "brush-store", self->brush_store,
+        "stamp-store", self->stamp_store,
         "settings", self->settings,
         NULL);
 
@@ -260,6 +265,54 @@ gcv_application_undo (GSimpleAction *action,
   gcv_window_undo (GCV_WINDOW (window));
 }
 
+static void
+gcv_application_copy (GSimpleAction *action,
+                      GVariant      *parameter,
+                      gpointer       user_data)
+{
+  GcvApplication *self   = user_data;
+  GtkWindow      *window = NULL;
+
+  window = gtk_application_get_active_window (GTK_APPLICATION (self));
+
+  if (!GCV_IS_WINDOW (window))
+    return;
+
+  gcv_window_copy (GCV_WINDOW (window));
+}
+
+static void
+gcv_application_paste (GSimpleAction *action,
+                       GVariant      *parameter,
+                       gpointer       user_data)
+{
+  GcvApplication *self   = user_data;
+  GtkWindow      *window = NULL;
+
+  window = gtk_application_get_active_window (GTK_APPLICATION (self));
+
+  if (!GCV_IS_WINDOW (window))
+    return;
+
+  gcv_window_paste (GCV_WINDOW (window));
+}
+
+static void
+gcv_application_compact (GSimpleAction *action,
+                         GVariant      *parameter,
+                         gpointer       user_data)
+{
+  GcvApplication *self   = user_data;
+  GtkWindow      *window = NULL;
+
+  window = gtk_application_get_active_window (GTK_APPLICATION (self));
+
+  if (!GCV_IS_WINDOW (window))
+    return;
+
+  gcv_window_compact (GCV_WINDOW (window));
+}
+
 static void
 gcv_application_subwindow (GSimpleAction *action,
                            GVariant      *parameter,
@@ -326,10 +379,31 @@ load_map_finish_cb (GObject      *source_object,
   window = gtk_application_get_active_window (GTK_APPLICATION (self));
 
   if (map != NULL)
-    g_object_set (
-        window,
-        "map", map,
-        NULL);
+    {
+      if (g_settings_get_boolean (self->settings, "compact-imported-strokes"))
+        {
+          g_autoptr (GListStore) strokes  = NULL;
+          g_autoptr (GPtrArray) compacted = NULL;
+          guint n_strokes                 = 0;
+
+          /* Units come in as one stroke each, merge
+           * them before the handle starts recording
+           */
+          g_object_get (
+              map,
+              "strokes", &strokes,
+              NULL);
+          n_strokes = g_list_model_get_n_items (G_LIST_MODEL (strokes));
+          compacted = gcv_item_stroke_compact (G_LIST_MODEL (strokes), 0, n_strokes);
+          if (compacted->len < n_strokes)
+            g_list_store_splice (strokes, 0, n_strokes, compacted->pdata, compacted->len);
+        }
+
+      g_object_set (
+          window,
+          "map", map,
+          NULL);
+    }
   else
     gcv_dialog (
         "An Error Occurred",
@@ -758,6 +832,9 @@ static const GActionEntry app_actions[] = {
   {   "subwindow",       gcv_application_subwindow },
   {        "undo",            gcv_application_undo },
   {        "redo",            gcv_application_redo },
+  {        "copy",            gcv_application_copy },
+  {       "paste",           gcv_application_paste },
+  {     "compact",         gcv_application_compact },
 };
 
 static void
@@ -805,7 +882,7 @@ gcv_application_init (GcvApplication *self)
   self->theme_setting = GCV_THEME_OPTION_DEFAULT;
 
   self->item_store = g_object_new (GCV_TYPE_ITEM_STORE, NULL);
-  gcv_item_store_read_resources (self->item_store);
+  gcv_item_store_load_builtin (self->item_store);
 
   self->brush_store = g_list_store_new (GCV_TYPE_BRUSHABLE);
   default_brush     = g_object_new (GCV_TYPE_SQUARE_BRUSH, NULL);
@@ -813,6 +890,8 @@ gcv_application_init (GcvApplication *self)
   g_signal_connect (self->brush_store, "items-changed",
                     G_CALLBACK (brushes_changed), self);
 
+  self->stamp_store = gcv_stamp_read_library (self->item_store);
+
   g_action_map_add_action_entries (
       G_ACTION_MAP (self),
       app_actions,
@@ -855,6 +934,9 @@ gcv_application_init (GcvApplication *self)
       GTK_APPLICATION (self),
       "app.redo",
       (const char *[]) { "<primary>y", "<primary><shift>z", NULL });
+  /* Copy and paste are bound in the map editor's own
+   * shortcut controller so text entries keep theirs
+   */
 }
 
 static void
@@ -23,13 +23,26 @@
 #include <gio/gio.h>
 
 #include "gtk-crusader-village-item-store.h"
+#include "gtk-crusader-village-item-table.h"
+#include "gtk-crusader-village-stats.h"
 
+/* Nothing here changes after gcv_item_store_load_builtin (),
+ * so any thread may read the store from then on. A
+ * GListStore would not do, it caches its last lookup.
+ */
 struct _GcvItemStore
 {
   GObject parent_instance;
 
-  GListStore *list_store;
-  GHashTable *id_map;
+  gboolean loaded;
+
+  GPtrArray *items;
+
+  /* The slot for an id holds its item's index + 1, or 0 */
+  guint *id_index;
+  int    max_id;
+
+  GcvItemInfo *infos;
 };
 
 static void list_model_iface_init (GListModelInterface *iface);
@@ -45,8 +58,9 @@ gcv_item_store_dispose (GObject *object)
 {
   GcvItemStore *self = GCV_ITEM_STORE (object);
 
-  g_clear_object (&self->list_store);
-  g_clear_pointer (&self->id_map, g_hash_table_unref);
+  g_clear_pointer (&self->items, g_ptr_array_unref);
+  g_clear_pointer (&self->id_index, g_free);
+  g_clear_pointer (&self->infos, g_atomic_rc_box_release);
 
   G_OBJECT_CLASS (gcv_item_store_parent_class)->dispose (object);
 }
@@ -62,15 +76,13 @@ gcv_item_store_class_init (GcvItemStoreClass *klass)
 static void
 gcv_item_store_init (GcvItemStore *self)
 {
-  self->list_store = g_list_store_new (GCV_TYPE_ITEM);
-  self->id_map     = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->items  = g_ptr_array_new_with_free_func (g_object_unref);
+  self->max_id = -1;
 }
 
 static GType
 list_model_get_item_type (GListModel *list)
 {
-  GcvItemStore *self = GCV_ITEM_STORE (list);
-
   return GCV_TYPE_ITEM;
 }
 
@@ -79,7 +91,7 @@ list_model_get_n_items (GListModel *list)
 {
   GcvItemStore *self = GCV_ITEM_STORE (list);
 
-  return g_list_model_get_n_items (G_LIST_MODEL (self->list_store));
+  return self->items->len;
 }
 
 static gpointer
@@ -88,7 +100,9 @@ list_model_get_item (GListModel *list,
 {
   GcvItemStore *self = GCV_ITEM_STORE (list);
 
-  return g_list_model_get_item (G_LIST_MODEL (self->list_store), position);
+  if (position >= self->items->len)
+    return NULL;
+  return g_object_ref (g_ptr_array_index (self->items, position));
 }
 
 static void
@@ -100,88 +114,72 @@ list_model_iface_init (GListModelInterface *iface)
 }
 
 void
-gcv_item_store_read_resources (GcvItemStore *self)
+gcv_item_store_load_builtin (GcvItemStore *self)
 {
-  g_auto (GStrv) children = NULL;
+  gint64 begin_time = 0;
 
   g_return_if_fail (GCV_IS_ITEM_STORE (self));
+  g_return_if_fail (!self->loaded);
+
+  begin_time = g_get_monotonic_time ();
 
-#define ITEMS_PATH "/am/kolunmi/Gcv/items/"
-  children = g_resources_enumerate_children (ITEMS_PATH, G_RESOURCE_LOOKUP_FLAGS_NONE, NULL);
-  if (children == NULL)
-    return;
+  /* One contiguous block for every item's info */
+  self->infos = g_atomic_rc_box_alloc0 (G_N_ELEMENTS (gcv_item_table) * sizeof (*self->infos));
 
-  for (char **path = children; *path != NULL; path++)
+  for (guint i = 0; i < G_N_ELEMENTS (gcv_item_table); i++)
+    self->max_id = MAX (self->max_id, gcv_item_table[i].id);
+  self->id_index = g_new0 (guint, self->max_id + 1);
+
+  for (guint i = 0; i < G_N_ELEMENTS (gcv_item_table); i++)
     {
-      g_autofree char *full_path     = NULL;
-      g_autoptr (GError) local_error = NULL;
-      g_autoptr (GcvItem) item       = NULL;
-      GcvItemKind kind               = 0;
-      int         id                 = 0;
-
-      full_path = g_strdup_printf (ITEMS_PATH "%s", *path);
-
-      item = gcv_item_new_for_resource (full_path, &local_error);
-      if (item == NULL)
-        {
-          g_critical ("Could not load internal item spec at %s: %s", full_path, local_error->message);
-          continue;
-        }
-
-      g_list_store_append (self->list_store, item);
-
-      g_object_get (
-          item,
-          "kind", &kind,
-          "id", &id,
+      const GcvItemTableEntry *entry = &gcv_item_table[i];
+      GcvItem                 *item  = NULL;
+
+      item = g_object_new (
+          GCV_TYPE_ITEM,
+          "id", entry->id,
+          "name", entry->name,
+          "description", entry->description,
+          "thumbnail-resource", entry->thumbnail_resource,
+          "section-icon-resource", entry->section_icon_resource,
+          "tile-resource", entry->tile_resource,
+          "kind", entry->kind,
+          "tile-width", entry->tile_width,
+          "tile-height", entry->tile_height,
+          "tile-offset-x", entry->tile_offset_x,
+          "tile-offset-y", entry->tile_offset_y,
+          "tile-impassable-rect-x", entry->tile_impassable_rect_x,
+          "tile-impassable-rect-y", entry->tile_impassable_rect_y,
+          "tile-impassable-rect-w", entry->tile_impassable_rect_w,
+          "tile-impassable-rect-h", entry->tile_impassable_rect_h,
           NULL);
+      gcv_item_share_info (item, self->infos, i);
+
+      g_ptr_array_add (self->items, item);
 
-      g_hash_table_replace (self->id_map, GINT_TO_POINTER (id), item);
+      /* Duplicate ids resolve to the last spec */
+      if (entry->id >= 0)
+        self->id_index[entry->id] = i + 1;
     }
+
+  self->loaded = TRUE;
+  gcv_stats_record_time ("item-store.load", begin_time);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), 0, 0, self->items->len);
 }
 
 GcvItem *
 gcv_item_store_query_id (GcvItemStore *self,
                          int           id)
 {
-  GcvItem *item = NULL;
+  guint index = 0;
 
   g_return_val_if_fail (GCV_IS_ITEM_STORE (self), NULL);
   g_return_val_if_fail (id > 0, NULL);
 
-  item = g_hash_table_lookup (self->id_map, GINT_TO_POINTER (id));
-
-  return item != NULL ? g_object_ref (item) : NULL;
-}
-
-GcvItemStore *
-gcv_item_store_dup (GcvItemStore *self)
-{
-  GcvItemStore *dup     = NULL;
-  guint         n_items = 0;
-
-  g_return_val_if_fail (GCV_IS_ITEM_STORE (self), NULL);
-
-  dup     = g_object_new (GCV_TYPE_ITEM_STORE, NULL);
-  n_items = g_list_model_get_n_items (G_LIST_MODEL (self));
-
-  for (guint i = 0; i < n_items; i++)
-    {
-      g_autoptr (GcvItem) item = NULL;
-      GcvItemKind kind         = 0;
-      int         id           = 0;
-
-      item = g_list_model_get_item (G_LIST_MODEL (self), i);
-      g_list_store_append (dup->list_store, item);
-
-      g_object_get (
-          item,
-          "kind", &kind,
-          "id", &id,
-          NULL);
-
-      g_hash_table_replace (dup->id_map, GINT_TO_POINTER (id), item);
-    }
+  if (id > self->max_id)
+    return NULL;
 
-  return dup;
+  index = self->id_index[id];
+  return index > 0 ? g_object_ref (g_ptr_array_index (self->items, index - 1)) : NULL;
 }
@@ -29,13 +29,10 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (GcvItemStore, gcv_item_store, GCV, ITEM_STORE, GObject)
 
 void
-gcv_item_store_read_resources (GcvItemStore *self);
+gcv_item_store_load_builtin (GcvItemStore *self);
 
 GcvItem *
 gcv_item_store_query_id (GcvItemStore *self,
                          int           id);
 
-GcvItemStore *
-gcv_item_store_dup (GcvItemStore *self);
-
 G_END_DECLS
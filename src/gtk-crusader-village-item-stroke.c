@@ -23,6 +23,11 @@
 #include "gtk-crusader-village-item-stroke.h"
 #include "gtk-crusader-village-item.h"
 
+/* Below this a linear overlap scan is cheaper than the table */
+#define OCCUPIED_THRESHOLD 32
+
+#define TILE_KEY(x, y) GUINT_TO_POINTER (((guint) (y) << 16) | ((guint) (x) & 0xffff))
+
 struct _GcvItemStroke
 {
   GObject parent_instance;
@@ -31,6 +36,8 @@ struct _GcvItemStroke
   int      item_tile_width;
   int      item_tile_height;
   GArray  *instances;
+
+  GHashTable *occupied;
 };
 
 G_DEFINE_FINAL_TYPE (GcvItemStroke, gcv_item_stroke, G_TYPE_OBJECT)
@@ -54,6 +61,7 @@ gcv_item_stroke_dispose (GObject *object)
 
   g_clear_object (&self->item);
   g_clear_pointer (&self->instances, g_array_unref);
+  g_clear_pointer (&self->occupied, g_hash_table_unref);
 
   G_OBJECT_CLASS (gcv_item_stroke_parent_class)->dispose (object);
 }
@@ -172,6 +180,23 @@ rect_insersects (int ax,
   return intersect_w > 0 && intersect_h > 0;
 }
 
+static void
+set_occupied (GcvItemStroke        *self,
+              GcvItemStrokeInstance instance,
+              gboolean              occupied)
+{
+  for (int y = 0; y < self->item_tile_height; y++)
+    {
+      for (int x = 0; x < self->item_tile_width; x++)
+        {
+          if (occupied)
+            g_hash_table_add (self->occupied, TILE_KEY (instance.x + x, instance.y + y));
+          else
+            g_hash_table_remove (self->occupied, TILE_KEY (instance.x + x, instance.y + y));
+        }
+    }
+}
+
 /* We trust that the caller won't pass an invalid instance */
 gboolean
 gcv_item_stroke_add_instance (GcvItemStroke        *self,
@@ -180,20 +205,149 @@ gcv_item_stroke_add_instance (GcvItemStroke        *self,
   g_return_val_if_fail (GCV_IS_ITEM_STROKE (self), FALSE);
   g_return_val_if_fail (self->item != NULL, FALSE);
 
-  for (guint i = 0; i < self->instances->len; i++)
+  if (self->occupied == NULL &&
+      self->instances->len >= OCCUPIED_THRESHOLD)
     {
-      GcvItemStrokeInstance check      = { 0 };
-      gboolean              intersects = FALSE;
-
-      check      = g_array_index (self->instances, GcvItemStrokeInstance, i);
-      intersects = rect_insersects (
-          check.x, check.y, self->item_tile_width, self->item_tile_height,
-          instance.x, instance.y, self->item_tile_width, self->item_tile_height);
+      self->occupied = g_hash_table_new (g_direct_hash, g_direct_equal);
+      for (guint i = 0; i < self->instances->len; i++)
+        set_occupied (self, g_array_index (self->instances, GcvItemStrokeInstance, i), TRUE);
+    }
 
-      if (intersects)
-        return FALSE;
+  if (self->occupied != NULL)
+    {
+      /* Instances never overlap, so checking the
+       * tiles they cover is enough
+       */
+      for (int y = 0; y < self->item_tile_height; y++)
+        {
+          for (int x = 0; x < self->item_tile_width; x++)
+            {
+              if (g_hash_table_contains (self->occupied, TILE_KEY (instance.x + x, instance.y + y)))
+                return FALSE;
+            }
+        }
+
+      set_occupied (self, instance, TRUE);
+    }
+  else
+    {
+      for (guint i = 0; i < self->instances->len; i++)
+        {
+          GcvItemStrokeInstance check      = { 0 };
+          gboolean              intersects = FALSE;
+
+          check      = g_array_index (self->instances, GcvItemStrokeInstance, i);
+          intersects = rect_insersects (
+              check.x, check.y, self->item_tile_width, self->item_tile_height,
+              instance.x, instance.y, self->item_tile_width, self->item_tile_height);
+
+          if (intersects)
+            return FALSE;
+        }
     }
 
   g_array_append_val (self->instances, instance);
   return TRUE;
 }
+
+/* For generated shapes. Unlike gcv_item_stroke_add_instance ()
+ * this trusts that the instances don't overlap each other or
+ * anything already in the stroke.
+ */
+void
+gcv_item_stroke_add_instances (GcvItemStroke               *self,
+                               const GcvItemStrokeInstance *instances,
+                               guint                        n_instances)
+{
+  g_return_if_fail (GCV_IS_ITEM_STROKE (self));
+  g_return_if_fail (self->item != NULL);
+  g_return_if_fail (instances != NULL || n_instances == 0);
+
+  if (self->occupied != NULL)
+    {
+      for (guint i = 0; i < n_instances; i++)
+        set_occupied (self, instances[i], TRUE);
+    }
+
+  g_array_append_vals (self->instances, instances, n_instances);
+}
+
+void
+gcv_item_stroke_truncate (GcvItemStroke *self,
+                          guint          n_instances)
+{
+  g_return_if_fail (GCV_IS_ITEM_STROKE (self));
+
+  if (n_instances >= self->instances->len)
+    return;
+
+  if (self->occupied != NULL)
+    {
+      for (guint i = n_instances; i < self->instances->len; i++)
+        set_occupied (self, g_array_index (self->instances, GcvItemStrokeInstance, i), FALSE);
+    }
+
+  g_array_set_size (self->instances, n_instances);
+}
+
+/* Merges each run of consecutive strokes with the same item in
+ * `model` into one stroke. Instances keep their order, so the
+ * finished map is the same, but the game builds a stroke as one
+ * step and the merged strokes become a single step. This changes
+ * the build order. Strokes without a neighbor to merge with are
+ * reused as they are.
+ */
+GPtrArray *
+gcv_item_stroke_compact (GListModel *model,
+                         guint       position,
+                         guint       n_strokes)
+{
+  g_autoptr (GPtrArray) compacted = NULL;
+  guint end                       = 0;
+
+  g_return_val_if_fail (G_IS_LIST_MODEL (model), NULL);
+  g_return_val_if_fail (position + n_strokes <= g_list_model_get_n_items (model), NULL);
+
+  compacted = g_ptr_array_new_with_free_func (g_object_unref);
+  end       = position + n_strokes;
+
+  for (guint i = position; i < end;)
+    {
+      g_autoptr (GcvItemStroke) first  = NULL;
+      g_autoptr (GcvItemStroke) merged = NULL;
+      guint next                       = 0;
+
+      first = g_list_model_get_item (model, i);
+
+      for (next = i + 1; next < end && first->item != NULL; next++)
+        {
+          g_autoptr (GcvItemStroke) stroke = NULL;
+
+          stroke = g_list_model_get_item (model, next);
+          if (stroke->item != first->item)
+            break;
+
+          if (merged == NULL)
+            {
+              merged = g_object_new (
+                  GCV_TYPE_ITEM_STROKE,
+                  "item", first->item,
+                  NULL);
+              g_array_append_vals (merged->instances, first->instances->data, first->instances->len);
+            }
+          /* Overlaps between the old strokes are kept and
+           * resolve the same way since the order is unchanged
+           */
+          g_array_append_vals (merged->instances, stroke->instances->data, stroke->instances->len);
+        }
+
+      g_ptr_array_add (
+          compacted,
+          merged != NULL
+              ? g_steal_pointer (&merged)
+              : g_steal_pointer (&first));
+      i = next;
+    }
+
+  return g_steal_pointer (&compacted);
+}
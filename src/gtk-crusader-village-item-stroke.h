@@ -20,7 +20,7 @@
 
 #pragma once
 
-#include <glib-object.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
@@ -38,4 +38,18 @@ gboolean
 gcv_item_stroke_add_instance (GcvItemStroke        *self,
                               GcvItemStrokeInstance instance);
 
+void
+gcv_item_stroke_add_instances (GcvItemStroke               *self,
+                               const GcvItemStrokeInstance *instances,
+                               guint                        n_instances);
+
+void
+gcv_item_stroke_truncate (GcvItemStroke *self,
+                          guint          n_instances);
+
+GPtrArray *
+gcv_item_stroke_compact (GListModel *model,
+                         guint       position,
+                         guint       n_strokes);
+
 G_END_DECLS
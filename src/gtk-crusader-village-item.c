@@ -20,8 +20,6 @@
 
 #include "config.h"
 
-#include <gio/gio.h>
-
 #include "gtk-crusader-village-item.h"
 
 G_DEFINE_ENUM_TYPE (
@@ -38,21 +36,19 @@ struct _GcvItem
 {
   GObject parent_instance;
 
-  int         id;
-  char       *name;
-  char       *description;
-  char       *thumbnail_resource;
-  char       *section_icon_resource;
-  char       *tile_resource;
-  GcvItemKind kind;
-  int         tile_width;
-  int         tile_height;
-  int         tile_offset_x;
-  int         tile_offset_y;
-  int         tile_impassable_rect_x;
-  int         tile_impassable_rect_y;
-  int         tile_impassable_rect_w;
-  int         tile_impassable_rect_h;
+  char *name;
+  char *description;
+  char *thumbnail_resource;
+  char *section_icon_resource;
+  char *tile_resource;
+
+  /* Points at own_info until a store moves it into
+   * its shared block. The fields behind it are construct
+   * only, other items may be reading the same block.
+   */
+  GcvItemInfo *info;
+  GcvItemInfo  own_info;
+  GcvItemInfo *info_block;
 
   guint tile_resource_hash;
 };
@@ -98,6 +94,16 @@ gcv_item_dispose (GObject *object)
   G_OBJECT_CLASS (gcv_item_parent_class)->dispose (object);
 }
 
+static void
+gcv_item_finalize (GObject *object)
+{
+  GcvItem *self = GCV_ITEM (object);
+
+  g_clear_pointer (&self->info_block, g_atomic_rc_box_release);
+
+  G_OBJECT_CLASS (gcv_item_parent_class)->finalize (object);
+}
+
 static void
 gcv_item_get_property (GObject    *object,
                        guint       prop_id,
@@ -109,7 +115,7 @@ gcv_item_get_property (GObject    *object,
   switch (prop_id)
     {
     case PROP_ID:
-      g_value_set_int (value, self->id);
+      g_value_set_int (value, self->info->id);
       break;
     case PROP_NAME:
       g_value_set_string (value, self->name);
@@ -127,31 +133,31 @@ gcv_item_get_property (GObject    *object,
       g_value_set_string (value, self->tile_resource);
       break;
     case PROP_KIND:
-      g_value_set_enum (value, self->kind);
+      g_value_set_enum (value, self->info->kind);
       break;
     case PROP_TILE_WIDTH:
-      g_value_set_int (value, self->tile_width);
+      g_value_set_int (value, self->info->tile_width);
       break;
     case PROP_TILE_HEIGHT:
-      g_value_set_int (value, self->tile_height);
+      g_value_set_int (value, self->info->tile_height);
       break;
     case PROP_TILE_OFFSET_X:
-      g_value_set_int (value, self->tile_offset_x);
+      g_value_set_int (value, self->info->tile_offset_x);
       break;
     case PROP_TILE_OFFSET_Y:
-      g_value_set_int (value, self->tile_offset_y);
+      g_value_set_int (value, self->info->tile_offset_y);
       break;
     case PROP_TILE_IMPASSABLE_RECT_X:
-      g_value_set_int (value, self->tile_impassable_rect_x);
+      g_value_set_int (value, self->info->tile_impassable_rect_x);
       break;
     case PROP_TILE_IMPASSABLE_RECT_Y:
-      g_value_set_int (value, self->tile_impassable_rect_y);
+      g_value_set_int (value, self->info->tile_impassable_rect_y);
       break;
     case PROP_TILE_IMPASSABLE_RECT_W:
-      g_value_set_int (value, self->tile_impassable_rect_w);
+      g_value_set_int (value, self->info->tile_impassable_rect_w);
       break;
     case PROP_TILE_IMPASSABLE_RECT_H:
-      g_value_set_int (value, self->tile_impassable_rect_h);
+      g_value_set_int (value, self->info->tile_impassable_rect_h);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -169,7 +175,7 @@ gcv_item_set_property (GObject      *object,
   switch (prop_id)
     {
     case PROP_ID:
-      self->id = g_value_get_int (value);
+      self->info->id = g_value_get_int (value);
       break;
     case PROP_NAME:
       g_clear_pointer (&self->name, g_free);
@@ -196,31 +202,31 @@ gcv_item_set_property (GObject      *object,
         self->tile_resource_hash = 0;
       break;
     case PROP_KIND:
-      self->kind = g_value_get_enum (value);
+      self->info->kind = g_value_get_enum (value);
       break;
     case PROP_TILE_WIDTH:
-      self->tile_width = g_value_get_int (value);
+      self->info->tile_width = g_value_get_int (value);
       break;
     case PROP_TILE_HEIGHT:
-      self->tile_height = g_value_get_int (value);
+      self->info->tile_height = g_value_get_int (value);
       break;
     case PROP_TILE_OFFSET_X:
-      self->tile_offset_x = g_value_get_int (value);
+      self->info->tile_offset_x = g_value_get_int (value);
       break;
     case PROP_TILE_OFFSET_Y:
-      self->tile_offset_y = g_value_get_int (value);
+      self->info->tile_offset_y = g_value_get_int (value);
       break;
     case PROP_TILE_IMPASSABLE_RECT_X:
-      self->tile_impassable_rect_x = g_value_get_int (value);
+      self->info->tile_impassable_rect_x = g_value_get_int (value);
       break;
     case PROP_TILE_IMPASSABLE_RECT_Y:
-      self->tile_impassable_rect_y = g_value_get_int (value);
+      self->info->tile_impassable_rect_y = g_value_get_int (value);
       break;
     case PROP_TILE_IMPASSABLE_RECT_W:
-      self->tile_impassable_rect_w = g_value_get_int (value);
+      self->info->tile_impassable_rect_w = g_value_get_int (value);
       break;
     case PROP_TILE_IMPASSABLE_RECT_H:
-      self->tile_impassable_rect_h = g_value_get_int (value);
+      self->info->tile_impassable_rect_h = g_value_get_int (value);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -233,6 +239,7 @@ gcv_item_class_init (GcvItemClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose      = gcv_item_dispose;
+  object_class->finalize     = gcv_item_finalize;
   object_class->get_property = gcv_item_get_property;
   object_class->set_property = gcv_item_set_property;
 
@@ -242,7 +249,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "ID",
           "The ID of this item",
           0, G_MAXINT, 0,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   props[PROP_NAME] =
       g_param_spec_string (
@@ -291,7 +298,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "The item type",
           GCV_TYPE_ITEM_KIND,
           GCV_ITEM_KIND_BUILDING,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   props[PROP_TILE_WIDTH] =
       g_param_spec_int (
@@ -299,7 +306,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "Tile Width",
           "The width of the item in tiles, if applicable",
           1, G_MAXINT, 1,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   props[PROP_TILE_HEIGHT] =
       g_param_spec_int (
@@ -307,7 +314,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "Tile Height",
           "The height of the item in tiles, if applicable",
           1, G_MAXINT, 1,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   props[PROP_TILE_OFFSET_X] =
       g_param_spec_int (
@@ -315,7 +322,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "Tile Offset X",
           "A x offset to applied to this item when loading and exporting",
           G_MININT, G_MAXINT, 0,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   props[PROP_TILE_OFFSET_Y] =
       g_param_spec_int (
@@ -323,7 +330,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "Tile Offset Y",
           "A y offset to applied to this item when loading and exporting",
           G_MININT, G_MAXINT, 0,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   props[PROP_TILE_IMPASSABLE_RECT_X] =
       g_param_spec_int (
@@ -332,7 +339,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "If this item is a building, the x component of "
           "impassable rect within the building's footprint",
           0, G_MAXINT, 0,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   props[PROP_TILE_IMPASSABLE_RECT_Y] =
       g_param_spec_int (
@@ -341,7 +348,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "If this item is a building, the y component of "
           "impassable rect within the building's footprint",
           0, G_MAXINT, 0,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   props[PROP_TILE_IMPASSABLE_RECT_W] =
       g_param_spec_int (
@@ -350,7 +357,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "If this item is a building, the width component of "
           "impassable rect within the building's footprint",
           0, G_MAXINT, 0,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   props[PROP_TILE_IMPASSABLE_RECT_H] =
       g_param_spec_int (
@@ -359,7 +366,7 @@ gcv_item_class_init (GcvItemClass *klass)
           "If this item is a building, the height component of "
           "impassable rect within the building's footprint",
           0, G_MAXINT, 0,
-          G_PARAM_READWRITE);
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
   g_object_class_install_properties (object_class, LAST_PROP, props);
 }
@@ -367,154 +374,36 @@ gcv_item_class_init (GcvItemClass *klass)
 static void
 gcv_item_init (GcvItem *self)
 {
-  self->kind        = GCV_ITEM_KIND_BUILDING;
-  self->tile_width  = 1;
-  self->tile_height = 1;
-}
-
-static void
-gcv_item_set_property_from_variant_inner (GcvItem  *self,
-                                          int       prop_id,
-                                          GVariant *variant)
-{
-#define WARN_INVALID_TYPE(need)                                                \
-  g_critical ("%s: property \"%s\" needs type " G_STRINGIFY (need) ", got %s", \
-              G_STRFUNC, props[prop_id]->name, g_variant_get_type_string (variant))
-
-#define RECEIVE_BASIC_VARIANT(type, type_def, ...)                                         \
-  G_STMT_START                                                                             \
-  {                                                                                        \
-    if (g_variant_is_of_type (variant, type_def))                                          \
-      g_object_set (self, props[prop_id]->name, g_variant_get_##type (__VA_ARGS__), NULL); \
-    else                                                                                   \
-      WARN_INVALID_TYPE (type);                                                            \
-  }                                                                                        \
-  G_STMT_END
-
-  switch (prop_id)
-    {
-    case PROP_ID:
-    case PROP_TILE_WIDTH:
-    case PROP_TILE_HEIGHT:
-    case PROP_TILE_OFFSET_X:
-    case PROP_TILE_OFFSET_Y:
-    case PROP_TILE_IMPASSABLE_RECT_X:
-    case PROP_TILE_IMPASSABLE_RECT_Y:
-    case PROP_TILE_IMPASSABLE_RECT_W:
-    case PROP_TILE_IMPASSABLE_RECT_H:
-      RECEIVE_BASIC_VARIANT (int32, G_VARIANT_TYPE_INT32, variant);
-      break;
-    case PROP_NAME:
-    case PROP_DESCRIPTION:
-    case PROP_THUMBNAIL_RESOURCE:
-    case PROP_SECTION_ICON_RESOURCE:
-    case PROP_TILE_RESOURCE:
-      RECEIVE_BASIC_VARIANT (string, G_VARIANT_TYPE_STRING, variant, NULL);
-      break;
-    case PROP_KIND:
-      if (g_variant_is_of_type (variant, G_VARIANT_TYPE_STRING))
-        {
-          const char *variant_string        = NULL;
-          g_autoptr (GEnumClass) enum_class = NULL;
-          GEnumValue *enum_value            = NULL;
-
-          variant_string = g_variant_get_string (variant, NULL);
-          enum_class     = g_type_class_ref (GCV_TYPE_ITEM_KIND);
-          enum_value     = g_enum_get_value_by_nick (enum_class, variant_string);
-
-          if (enum_value != NULL)
-            g_object_set (
-                self,
-                props[prop_id]->name, enum_value->value,
-                NULL);
-          else
-            g_critical ("%s: property \"%s\" does not accept the enum value '%s'",
-                        G_STRFUNC, props[prop_id]->name, variant_string);
-        }
-      else
-        WARN_INVALID_TYPE (string);
-      break;
-    default:
-      g_assert_not_reached ();
-      break;
-    }
-
-#undef RECEIVE_VARIANT
+  self->info              = &self->own_info;
+  self->info->kind        = GCV_ITEM_KIND_BUILDING;
+  self->info->tile_width  = 1;
+  self->info->tile_height = 1;
 }
 
-GcvItem *
-gcv_item_new_for_resource (const char *resource_path,
-                           GError    **error)
+const GcvItemInfo *
+gcv_item_get_info (GcvItem *self)
 {
-  GError *local_error               = NULL;
-  g_autoptr (GBytes) bytes          = NULL;
-  gsize       local_size            = 0;
-  const char *resource_data         = NULL;
-  g_autoptr (GVariant) data_variant = NULL;
-  g_autoptr (GcvItem) item          = NULL;
-
-  g_return_val_if_fail (resource_path != NULL, NULL);
-
-  bytes = g_resources_lookup_data (resource_path, G_RESOURCE_LOOKUP_FLAGS_NONE, &local_error);
-  if (bytes == NULL)
-    {
-      g_propagate_error (error, local_error);
-      return NULL;
-    }
-
-  resource_data = g_bytes_get_data (bytes, &local_size);
-
-  data_variant = g_variant_parse (NULL, resource_data, NULL, NULL, &local_error);
-  if (data_variant == NULL)
-    {
-      g_propagate_error (error, local_error);
-      return NULL;
-    }
-
-  item = g_object_new (GCV_TYPE_ITEM, NULL);
-
-  /* TODO: maybe add real errors and improve feedback
-   * through gui if custom items are ever a thing.
-   */
-  if (g_variant_is_of_type (data_variant, G_VARIANT_TYPE_DICTIONARY))
-    {
-      GVariantIter iter = { 0 };
-
-      g_variant_iter_init (&iter, data_variant);
-      for (;;)
-        {
-          g_autofree char *key       = NULL;
-          g_autoptr (GVariant) value = NULL;
-
-          if (!g_variant_iter_next (&iter, "{sv}", &key, &value))
-            break;
-
-          gcv_item_set_property_from_variant (item, key, value);
-        }
-    }
+  g_return_val_if_fail (GCV_IS_ITEM (self), NULL);
 
-  return g_steal_pointer (&item);
+  return self->info;
 }
 
+/* @block is a g_atomic_rc_box owned by a `GcvItemStore`,
+ * the item keeps it alive from now on
+ */
 void
-gcv_item_set_property_from_variant (GcvItem    *self,
-                                    const char *property,
-                                    GVariant   *variant)
+gcv_item_share_info (GcvItem     *self,
+                     GcvItemInfo *block,
+                     guint        index)
 {
-  gboolean found = FALSE;
+  g_return_if_fail (GCV_IS_ITEM (self));
+  g_return_if_fail (block != NULL);
+  g_return_if_fail (self->info_block == NULL);
 
-  for (int prop_id = PROP_0 + 1; prop_id < LAST_PROP; prop_id++)
-    {
-      if (g_strcmp0 (property, props[prop_id]->name) == 0)
-        {
-          gcv_item_set_property_from_variant_inner (self, prop_id, variant);
-          found = TRUE;
-          break;
-        }
-    }
+  block[index] = *self->info;
 
-  if (!found)
-    g_critical ("%s: property '%s' not found", G_STRFUNC, property);
+  self->info       = &block[index];
+  self->info_block = g_atomic_rc_box_acquire (block);
 }
 
 const char *
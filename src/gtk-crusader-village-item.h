@@ -41,14 +41,30 @@ typedef enum
 GType gcv_item_kind_get_type (void);
 #define GCV_TYPE_ITEM_KIND (gcv_item_kind_get_type ())
 
-GcvItem *
-gcv_item_new_for_resource (const char *resource_path,
-                           GError    **error);
+/* The plain fields of a `GcvItem`, for loops that would
+ * otherwise call g_object_get () per stroke or per tile
+ */
+typedef struct
+{
+  int         id;
+  GcvItemKind kind;
+  int         tile_width;
+  int         tile_height;
+  int         tile_offset_x;
+  int         tile_offset_y;
+  int         tile_impassable_rect_x;
+  int         tile_impassable_rect_y;
+  int         tile_impassable_rect_w;
+  int         tile_impassable_rect_h;
+} GcvItemInfo;
+
+const GcvItemInfo *
+gcv_item_get_info (GcvItem *self);
 
 void
-gcv_item_set_property_from_variant (GcvItem    *self,
-                                    const char *property,
-                                    GVariant   *variant);
+gcv_item_share_info (GcvItem     *self,
+                     GcvItemInfo *block,
+                     guint        index);
 
 const char *
 gcv_item_get_name (GcvItem *self);
@@ -0,0 +1,481 @@
+/* gtk-crusader-village-map-editor-minimap.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "gtk-crusader-village-map-editor-minimap.h"
+#include "gtk-crusader-village-map-editor.h"
+#include "gtk-crusader-village-map-handle.h"
+#include "gtk-crusader-village-map.h"
+
+#define MINIMAP_SIZE 180
+
+struct _GcvMapEditorMinimap
+{
+  GtkWidget parent_instance;
+
+  GcvMapEditor  *editor;
+  GcvMapHandle  *handle;
+  GtkAdjustment *hadjustment;
+  GtkAdjustment *vadjustment;
+
+  GtkGesture *drag_gesture;
+  double      drag_start_x;
+  double      drag_start_y;
+};
+
+G_DEFINE_FINAL_TYPE (GcvMapEditorMinimap, gcv_map_editor_minimap, GTK_TYPE_WIDGET)
+
+enum
+{
+  PROP_0,
+
+  PROP_EDITOR,
+
+  LAST_PROP
+};
+
+static GParamSpec *props[LAST_PROP] = { 0 };
+
+static void
+map_handle_changed (GcvMapEditor        *editor,
+                    GParamSpec          *pspec,
+                    GcvMapEditorMinimap *minimap);
+
+static void
+adjustments_changed (GcvMapEditor        *editor,
+                     GParamSpec          *pspec,
+                     GcvMapEditorMinimap *minimap);
+
+static void
+needs_redraw (GObject             *object,
+              GParamSpec          *pspec,
+              GcvMapEditorMinimap *minimap);
+
+static void
+adjustment_changed (GtkAdjustment       *adjustment,
+                    GcvMapEditorMinimap *minimap);
+
+static void
+drag_gesture_begin (GtkGestureDrag      *self,
+                    double               start_x,
+                    double               start_y,
+                    GcvMapEditorMinimap *minimap);
+
+static void
+drag_gesture_update (GtkGestureDrag      *self,
+                     double               offset_x,
+                     double               offset_y,
+                     GcvMapEditorMinimap *minimap);
+
+static void
+read_map_handle (GcvMapEditorMinimap *self);
+
+static void
+read_adjustments (GcvMapEditorMinimap *self);
+
+static gboolean
+get_layout (GcvMapEditorMinimap *self,
+            double              *offset_x,
+            double              *offset_y,
+            double              *scale);
+
+static void
+scroll_to_point (GcvMapEditorMinimap *self,
+                 double               x,
+                 double               y);
+
+static void
+gcv_map_editor_minimap_dispose (GObject *object)
+{
+  GcvMapEditorMinimap *self = GCV_MAP_EDITOR_MINIMAP (object);
+
+  if (self->editor != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (self->editor, map_handle_changed, self);
+      g_signal_handlers_disconnect_by_func (self->editor, adjustments_changed, self);
+      g_signal_handlers_disconnect_by_func (self->editor, needs_redraw, self);
+    }
+  g_clear_object (&self->editor);
+
+  read_map_handle (self);
+  read_adjustments (self);
+
+  G_OBJECT_CLASS (gcv_map_editor_minimap_parent_class)->dispose (object);
+}
+
+static void
+gcv_map_editor_minimap_get_property (GObject    *object,
+                                     guint       prop_id,
+                                     GValue     *value,
+                                     GParamSpec *pspec)
+{
+  GcvMapEditorMinimap *self = GCV_MAP_EDITOR_MINIMAP (object);
+
+  switch (prop_id)
+    {
+    case PROP_EDITOR:
+      g_value_set_object (value, self->editor);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gcv_map_editor_minimap_set_property (GObject      *object,
+                                     guint         prop_id,
+                                     const GValue *value,
+                                     GParamSpec   *pspec)
+{
+  GcvMapEditorMinimap *self = GCV_MAP_EDITOR_MINIMAP (object);
+
+  switch (prop_id)
+    {
+    case PROP_EDITOR:
+      {
+        if (self->editor != NULL)
+          {
+            g_signal_handlers_disconnect_by_func (self->editor, map_handle_changed, self);
+            g_signal_handlers_disconnect_by_func (self->editor, adjustments_changed, self);
+            g_signal_handlers_disconnect_by_func (self->editor, needs_redraw, self);
+          }
+        g_clear_object (&self->editor);
+
+        self->editor = g_value_dup_object (value);
+
+        if (self->editor != NULL)
+          {
+            g_signal_connect (self->editor, "notify::map-handle",
+                              G_CALLBACK (map_handle_changed), self);
+            g_signal_connect (self->editor, "notify::hadjustment",
+                              G_CALLBACK (adjustments_changed), self);
+            g_signal_connect (self->editor, "notify::vadjustment",
+                              G_CALLBACK (adjustments_changed), self);
+            g_signal_connect (self->editor, "notify::zoom",
+                              G_CALLBACK (needs_redraw), self);
+            g_signal_connect (self->editor, "notify::draw-after-cursor",
+                              G_CALLBACK (needs_redraw), self);
+          }
+
+        read_map_handle (self);
+        read_adjustments (self);
+        gtk_widget_queue_draw (GTK_WIDGET (self));
+      }
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gcv_map_editor_minimap_measure (GtkWidget     *widget,
+                                GtkOrientation orientation,
+                                int            for_size,
+                                int           *minimum,
+                                int           *natural,
+                                int           *minimum_baseline,
+                                int           *natural_baseline)
+{
+  *minimum = MINIMAP_SIZE / 2;
+  *natural = MINIMAP_SIZE;
+}
+
+static void
+gcv_map_editor_minimap_snapshot (GtkWidget   *widget,
+                                 GtkSnapshot *snapshot)
+{
+  GcvMapEditorMinimap *self     = GCV_MAP_EDITOR_MINIMAP (widget);
+  GdkTexture          *overview = NULL;
+  double               offset_x = 0.0;
+  double               offset_y = 0.0;
+  double               scale    = 0.0;
+  graphene_rect_t      bounds   = { 0 };
+  graphene_rect_t      visible  = { 0 };
+
+  if (self->editor == NULL || !get_layout (self, &offset_x, &offset_y, &scale))
+    return;
+
+  /* The editor keeps this up to date incrementally, so
+   * this is just a texture draw unless something changed
+   */
+  overview = gcv_map_editor_get_overview (self->editor);
+  if (overview == NULL)
+    return;
+
+  bounds = GRAPHENE_RECT_INIT (
+      offset_x, offset_y,
+      gdk_texture_get_width (overview) * scale,
+      gdk_texture_get_height (overview) * scale);
+
+  gtk_snapshot_append_color (
+      snapshot,
+      &(GdkRGBA) { 0.0, 0.0, 0.0, 0.5 },
+      &bounds);
+  gtk_snapshot_append_scaled_texture (
+      snapshot, overview,
+      scale >= 1.0 ? GSK_SCALING_FILTER_NEAREST : GSK_SCALING_FILTER_LINEAR,
+      &bounds);
+
+  if (gcv_map_editor_get_visible_area (self->editor, &visible))
+    {
+      graphene_rect_t frame = { 0 };
+
+      frame = GRAPHENE_RECT_INIT (
+          offset_x + visible.origin.x * scale,
+          offset_y + visible.origin.y * scale,
+          visible.size.width * scale,
+          visible.size.height * scale);
+
+      if (graphene_rect_intersection (&frame, &bounds, &frame))
+        {
+          gtk_snapshot_append_color (
+              snapshot,
+              &(GdkRGBA) { 1.0, 1.0, 1.0, 0.15 },
+              &frame);
+          gtk_snapshot_append_border (
+              snapshot,
+              &GSK_ROUNDED_RECT_INIT (
+                  frame.origin.x, frame.origin.y,
+                  frame.size.width, frame.size.height),
+              (float[4]) { 1.5, 1.5, 1.5, 1.5 },
+              (GdkRGBA[4]) {
+                  { 1.0, 1.0, 1.0, 1.0 },
+                  { 1.0, 1.0, 1.0, 1.0 },
+                  { 1.0, 1.0, 1.0, 1.0 },
+                  { 1.0, 1.0, 1.0, 1.0 },
+              });
+        }
+    }
+}
+
+static void
+gcv_map_editor_minimap_class_init (GcvMapEditorMinimapClass *klass)
+{
+  GObjectClass   *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->dispose      = gcv_map_editor_minimap_dispose;
+  object_class->get_property = gcv_map_editor_minimap_get_property;
+  object_class->set_property = gcv_map_editor_minimap_set_property;
+
+  props[PROP_EDITOR] =
+      g_param_spec_object (
+          "editor",
+          "Editor",
+          "The map editor this widget will navigate",
+          GCV_TYPE_MAP_EDITOR,
+          G_PARAM_READWRITE);
+
+  g_object_class_install_properties (object_class, LAST_PROP, props);
+
+  widget_class->measure  = gcv_map_editor_minimap_measure;
+  widget_class->snapshot = gcv_map_editor_minimap_snapshot;
+}
+
+static void
+gcv_map_editor_minimap_init (GcvMapEditorMinimap *self)
+{
+  self->drag_gesture = gtk_gesture_drag_new ();
+  g_signal_connect (self->drag_gesture, "drag-begin", G_CALLBACK (drag_gesture_begin), self);
+  g_signal_connect (self->drag_gesture, "drag-update", G_CALLBACK (drag_gesture_update), self);
+  gtk_widget_add_controller (GTK_WIDGET (self), GTK_EVENT_CONTROLLER (self->drag_gesture));
+
+  gtk_widget_set_cursor_from_name (GTK_WIDGET (self), "pointer");
+}
+
+static void
+map_handle_changed (GcvMapEditor        *editor,
+                    GParamSpec          *pspec,
+                    GcvMapEditorMinimap *minimap)
+{
+  read_map_handle (minimap);
+  gtk_widget_queue_draw (GTK_WIDGET (minimap));
+}
+
+static void
+adjustments_changed (GcvMapEditor        *editor,
+                     GParamSpec          *pspec,
+                     GcvMapEditorMinimap *minimap)
+{
+  read_adjustments (minimap);
+  gtk_widget_queue_draw (GTK_WIDGET (minimap));
+}
+
+static void
+needs_redraw (GObject             *object,
+              GParamSpec          *pspec,
+              GcvMapEditorMinimap *minimap)
+{
+  gtk_widget_queue_draw (GTK_WIDGET (minimap));
+}
+
+static void
+adjustment_changed (GtkAdjustment       *adjustment,
+                    GcvMapEditorMinimap *minimap)
+{
+  gtk_widget_queue_draw (GTK_WIDGET (minimap));
+}
+
+static void
+drag_gesture_begin (GtkGestureDrag      *self,
+                    double               start_x,
+                    double               start_y,
+                    GcvMapEditorMinimap *minimap)
+{
+  minimap->drag_start_x = start_x;
+  minimap->drag_start_y = start_y;
+  scroll_to_point (minimap, start_x, start_y);
+}
+
+static void
+drag_gesture_update (GtkGestureDrag      *self,
+                     double               offset_x,
+                     double               offset_y,
+                     GcvMapEditorMinimap *minimap)
+{
+  scroll_to_point (
+      minimap,
+      minimap->drag_start_x + offset_x,
+      minimap->drag_start_y + offset_y);
+}
+
+static void
+read_map_handle (GcvMapEditorMinimap *self)
+{
+  if (self->handle != NULL)
+    g_signal_handlers_disconnect_by_func (self->handle, needs_redraw, self);
+  g_clear_object (&self->handle);
+
+  if (self->editor == NULL)
+    return;
+
+  g_object_get (
+      self->editor,
+      "map-handle", &self->handle,
+      NULL);
+
+  /* Only fires once a stroke is committed, never while
+   * one is being painted
+   */
+  if (self->handle != NULL)
+    {
+      g_signal_connect (self->handle, "notify::grid",
+                        G_CALLBACK (needs_redraw), self);
+      g_signal_connect (self->handle, "notify::cursor",
+                        G_CALLBACK (needs_redraw), self);
+      g_signal_connect (self->handle, "notify::cursor-len",
+                        G_CALLBACK (needs_redraw), self);
+    }
+}
+
+static void
+read_adjustments (GcvMapEditorMinimap *self)
+{
+  if (self->hadjustment != NULL)
+    g_signal_handlers_disconnect_by_func (self->hadjustment, adjustment_changed, self);
+  g_clear_object (&self->hadjustment);
+  if (self->vadjustment != NULL)
+    g_signal_handlers_disconnect_by_func (self->vadjustment, adjustment_changed, self);
+  g_clear_object (&self->vadjustment);
+
+  if (self->editor == NULL)
+    return;
+
+  g_object_get (
+      self->editor,
+      "hadjustment", &self->hadjustment,
+      "vadjustment", &self->vadjustment,
+      NULL);
+
+  if (self->hadjustment != NULL)
+    {
+      g_signal_connect (self->hadjustment, "value-changed",
+                        G_CALLBACK (adjustment_changed), self);
+      g_signal_connect (self->hadjustment, "changed",
+                        G_CALLBACK (adjustment_changed), self);
+    }
+  if (self->vadjustment != NULL)
+    {
+      g_signal_connect (self->vadjustment, "value-changed",
+                        G_CALLBACK (adjustment_changed), self);
+      g_signal_connect (self->vadjustment, "changed",
+                        G_CALLBACK (adjustment_changed), self);
+    }
+}
+
+static gboolean
+get_layout (GcvMapEditorMinimap *self,
+            double              *offset_x,
+            double              *offset_y,
+            double              *scale)
+{
+  g_autoptr (GcvMap) map = NULL;
+  int    map_tile_width  = 0;
+  int    map_tile_height = 0;
+  double width           = 0.0;
+  double height          = 0.0;
+
+  if (self->handle == NULL)
+    return FALSE;
+
+  g_object_get (
+      self->handle,
+      "map", &map,
+      NULL);
+  if (map == NULL)
+    return FALSE;
+
+  g_object_get (
+      map,
+      "width", &map_tile_width,
+      "height", &map_tile_height,
+      NULL);
+  if (map_tile_width <= 0 || map_tile_height <= 0)
+    return FALSE;
+
+  width  = gtk_widget_get_width (GTK_WIDGET (self));
+  height = gtk_widget_get_height (GTK_WIDGET (self));
+
+  /* Fit the whole map, centered */
+  *scale    = MIN (width / (double) map_tile_width, height / (double) map_tile_height);
+  *offset_x = (width - (double) map_tile_width * *scale) / 2.0;
+  *offset_y = (height - (double) map_tile_height * *scale) / 2.0;
+
+  return *scale > 0.0;
+}
+
+static void
+scroll_to_point (GcvMapEditorMinimap *self,
+                 double               x,
+                 double               y)
+{
+  double offset_x = 0.0;
+  double offset_y = 0.0;
+  double scale    = 0.0;
+
+  if (self->editor == NULL || !get_layout (self, &offset_x, &offset_y, &scale))
+    return;
+
+  gcv_map_editor_scroll_to (
+      self->editor,
+      (x - offset_x) / scale,
+      (y - offset_y) / scale);
+}
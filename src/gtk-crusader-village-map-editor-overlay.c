@@ -20,12 +20,17 @@
 
 #include "config.h"
 
+#include "gtk-crusader-village-dialog-window.h"
+#include "gtk-crusader-village-map-editor-minimap.h"
 #include "gtk-crusader-village-map-editor-overlay.h"
 #include "gtk-crusader-village-map-editor.h"
 #include "gtk-crusader-village-map-handle.h"
+#include "gtk-crusader-village-stamp.h"
+#include "gtk-crusader-village-stats.h"
 
 #define TOOLBAR_HIDDEN_MAX_POINTER_DISTANCE 150.0
 #define TOOLBAR_HIDDEN_MIN_OPACITY          0.3
+#define STATS_REFRESH_INTERVAL_MS           500
 
 struct _GcvMapEditorOverlay
 {
@@ -34,25 +39,41 @@ struct _GcvMapEditorOverlay
   GcvMapEditor *editor;
   GcvMapHandle *handle;
   GListStore   *model;
+  GListStore   *stamp_store;
 
   double   x;
   double   y;
   gboolean drawing;
 
-  GBinding *line_mode_binding;
   GBinding *draw_after_cursor_binding;
   GBinding *accessible_overlay_binding;
 
+  guint stats_source;
+
   /* Template widgets */
-  GtkOverlay        *overlay;
-  GtkScrolledWindow *scrolled_window;
-  GtkFrame          *frame;
-  GtkToggleButton   *pencil;
-  GtkToggleButton   *draw_line;
-  GtkToggleButton   *draw_after_cursor;
-  GtkToggleButton   *accessible_overlay;
-  GtkButton         *undo;
-  GtkButton         *redo;
+  GtkOverlay          *overlay;
+  GtkScrolledWindow   *scrolled_window;
+  GtkFrame            *frame;
+  GtkToggleButton     *pencil;
+  GtkToggleButton     *draw_line;
+  GtkToggleButton     *fill;
+  GtkToggleButton     *rectangle;
+  GtkToggleButton     *rectangle_outline;
+  GtkToggleButton     *ellipse;
+  GtkToggleButton     *stamp;
+  GtkListView         *stamp_list;
+  GtkEntry            *stamp_name;
+  GtkButton           *save_stamp;
+  GtkDropDown         *symmetry;
+  GtkToggleButton     *draw_after_cursor;
+  GtkToggleButton     *accessible_overlay;
+  GtkButton           *undo;
+  GtkButton           *redo;
+  GtkToggleButton     *stats_toggle;
+  GtkLabel            *stats_label;
+  GtkButton           *stats_reset;
+  GtkButton           *stats_copy;
+  GcvMapEditorMinimap *minimap;
 };
 
 G_DEFINE_FINAL_TYPE (GcvMapEditorOverlay, gcv_map_editor_overlay, GCV_TYPE_UTIL_BIN)
@@ -62,6 +83,7 @@ enum
   PROP_0,
 
   PROP_EDITOR,
+  PROP_STAMP_STORE,
 
   LAST_PROP
 };
@@ -73,6 +95,35 @@ map_handle_changed (GcvMapEditor        *editor,
                     GParamSpec          *pspec,
                     GcvMapEditorOverlay *overlay);
 
+static void
+setup_stamp_listitem (GtkListItemFactory  *factory,
+                      GtkListItem         *list_item,
+                      GcvMapEditorOverlay *overlay);
+
+static void
+bind_stamp_listitem (GtkListItemFactory  *factory,
+                     GtkListItem         *list_item,
+                     GcvMapEditorOverlay *overlay);
+
+static void
+unbind_stamp_listitem (GtkListItemFactory  *factory,
+                       GtkListItem         *list_item,
+                       GcvMapEditorOverlay *overlay);
+
+static void
+stamp_activated (GtkListView         *list_view,
+                 guint                position,
+                 GcvMapEditorOverlay *overlay);
+
+static void
+stamp_loaded (GObject      *source_object,
+              GAsyncResult *res,
+              gpointer      data);
+
+static void
+save_stamp_clicked (GtkButton           *self,
+                    GcvMapEditorOverlay *overlay);
+
 static void
 model_items_changed (GListModel          *self,
                      guint                position,
@@ -91,7 +142,21 @@ drawing_changed (GcvMapEditor        *editor,
                  GcvMapEditorOverlay *overlay);
 
 static void
-line_mode_changed (GcvMapEditor        *editor,
+tool_changed (GcvMapEditor        *editor,
+              GParamSpec          *pspec,
+              GcvMapEditorOverlay *overlay);
+
+static void
+tool_toggled (GtkToggleButton     *button,
+              GcvMapEditorOverlay *overlay);
+
+static void
+symmetry_changed (GcvMapEditor        *editor,
+                  GParamSpec          *pspec,
+                  GcvMapEditorOverlay *overlay);
+
+static void
+symmetry_selected (GtkDropDown         *drop_down,
                    GParamSpec          *pspec,
                    GcvMapEditorOverlay *overlay);
 
@@ -119,6 +184,21 @@ static void
 redo_clicked (GtkButton           *self,
               GcvMapEditorOverlay *overlay);
 
+static void
+stats_toggled (GtkToggleButton     *self,
+               GcvMapEditorOverlay *overlay);
+
+static void
+stats_reset_clicked (GtkButton           *self,
+                     GcvMapEditorOverlay *overlay);
+
+static void
+stats_copy_clicked (GtkButton           *self,
+                    GcvMapEditorOverlay *overlay);
+
+static gboolean
+refresh_stats (GcvMapEditorOverlay *self);
+
 static void
 update_ui_opacity (GcvMapEditorOverlay *self);
 
@@ -137,8 +217,8 @@ gcv_map_editor_overlay_dispose (GObject *object)
     {
       g_signal_handlers_disconnect_by_func (self->editor, map_handle_changed, self);
       g_signal_handlers_disconnect_by_func (self->editor, drawing_changed, self);
-      g_signal_handlers_disconnect_by_func (self->editor, line_mode_changed, self);
-      g_binding_unbind (self->line_mode_binding);
+      g_signal_handlers_disconnect_by_func (self->editor, tool_changed, self);
+      g_signal_handlers_disconnect_by_func (self->editor, symmetry_changed, self);
       g_binding_unbind (self->draw_after_cursor_binding);
       g_binding_unbind (self->accessible_overlay_binding);
     }
@@ -152,6 +232,13 @@ gcv_map_editor_overlay_dispose (GObject *object)
     g_signal_handlers_disconnect_by_func (self->model, model_items_changed, self);
   g_clear_object (&self->model);
 
+  if (self->stats_source != 0)
+    {
+      g_clear_handle_id (&self->stats_source, g_source_remove);
+      gcv_stats_disable ();
+    }
+  g_clear_object (&self->stamp_store);
+
   G_OBJECT_CLASS (gcv_map_editor_overlay_parent_class)->dispose (object);
 }
 
@@ -168,6 +255,9 @@ gcv_map_editor_overlay_get_property (GObject    *object,
     case PROP_EDITOR:
       g_value_set_object (value, self->editor);
       break;
+    case PROP_STAMP_STORE:
+      g_value_set_object (value, self->stamp_store);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -189,8 +279,8 @@ gcv_map_editor_overlay_set_property (GObject      *object,
           {
             g_signal_handlers_disconnect_by_func (self->editor, map_handle_changed, self);
             g_signal_handlers_disconnect_by_func (self->editor, drawing_changed, self);
-            g_signal_handlers_disconnect_by_func (self->editor, line_mode_changed, self);
-            g_binding_unbind (self->line_mode_binding);
+            g_signal_handlers_disconnect_by_func (self->editor, tool_changed, self);
+            g_signal_handlers_disconnect_by_func (self->editor, symmetry_changed, self);
             g_binding_unbind (self->draw_after_cursor_binding);
             g_binding_unbind (self->accessible_overlay_binding);
           }
@@ -211,13 +301,13 @@ gcv_map_editor_overlay_set_property (GObject      *object,
                               G_CALLBACK (map_handle_changed), self);
             g_signal_connect (self->editor, "notify::drawing",
                               G_CALLBACK (drawing_changed), self);
-            g_signal_connect (self->editor, "notify::line-mode",
-                              G_CALLBACK (line_mode_changed), self);
+            g_signal_connect (self->editor, "notify::tool",
+                              G_CALLBACK (tool_changed), self);
+            tool_changed (self->editor, NULL, self);
+            g_signal_connect (self->editor, "notify::symmetry",
+                              G_CALLBACK (symmetry_changed), self);
+            symmetry_changed (self->editor, NULL, self);
 
-            self->line_mode_binding = g_object_bind_property (
-                self->editor, "line-mode",
-                self->draw_line, "active",
-                G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
             self->draw_after_cursor_binding = g_object_bind_property (
                 self->editor, "draw-after-cursor",
                 self->draw_after_cursor, "active",
@@ -231,6 +321,22 @@ gcv_map_editor_overlay_set_property (GObject      *object,
           update_ui_for_model (self);
 
         gtk_scrolled_window_set_child (self->scrolled_window, GTK_WIDGET (self->editor));
+        g_object_set (
+            self->minimap,
+            "editor", self->editor,
+            NULL);
+      }
+      break;
+    case PROP_STAMP_STORE:
+      {
+        g_autoptr (GtkNoSelection) selection = NULL;
+
+        g_clear_object (&self->stamp_store);
+        self->stamp_store = g_value_dup_object (value);
+
+        if (self->stamp_store != NULL)
+          selection = gtk_no_selection_new (g_object_ref (G_LIST_MODEL (self->stamp_store)));
+        gtk_list_view_set_model (self->stamp_list, GTK_SELECTION_MODEL (selection));
       }
       break;
     default:
@@ -256,32 +362,82 @@ gcv_map_editor_overlay_class_init (GcvMapEditorOverlayClass *klass)
           GCV_TYPE_MAP_EDITOR,
           G_PARAM_READWRITE);
 
+  props[PROP_STAMP_STORE] =
+      g_param_spec_object (
+          "stamp-store",
+          "Stamp Store",
+          "The library of saved `GcvStamp`s",
+          G_TYPE_LIST_STORE,
+          G_PARAM_READWRITE);
+
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
+  g_type_ensure (GCV_TYPE_MAP_EDITOR_MINIMAP);
+
   gtk_widget_class_set_template_from_resource (widget_class, "/am/kolunmi/Gcv/gtk-crusader-village-map-editor-overlay.ui");
   gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, overlay);
   gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, scrolled_window);
   gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, frame);
   gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, pencil);
   gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, draw_line);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, fill);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, rectangle);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, rectangle_outline);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, ellipse);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, stamp);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, stamp_list);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, stamp_name);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, save_stamp);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, symmetry);
   gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, draw_after_cursor);
   gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, accessible_overlay);
   gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, undo);
   gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, redo);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, stats_toggle);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, stats_label);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, stats_reset);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, stats_copy);
+  gtk_widget_class_bind_template_child (widget_class, GcvMapEditorOverlay, minimap);
 }
 
 static void
 gcv_map_editor_overlay_init (GcvMapEditorOverlay *self)
 {
-  GtkEventController *motion_controller = NULL;
+  GtkEventController *motion_controller     = NULL;
+  g_autoptr (GtkListItemFactory) factory = NULL;
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_stamp_listitem), self);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_stamp_listitem), self);
+  g_signal_connect (factory, "unbind", G_CALLBACK (unbind_stamp_listitem), self);
+  gtk_list_view_set_factory (self->stamp_list, factory);
+  g_signal_connect (self->stamp_list, "activate", G_CALLBACK (stamp_activated), self);
+  g_signal_connect (self->save_stamp, "clicked", G_CALLBACK (save_stamp_clicked), self);
+
   gtk_toggle_button_set_group (self->draw_line, self->pencil);
+  gtk_toggle_button_set_group (self->fill, self->pencil);
+  gtk_toggle_button_set_group (self->rectangle, self->pencil);
+  gtk_toggle_button_set_group (self->rectangle_outline, self->pencil);
+  gtk_toggle_button_set_group (self->ellipse, self->pencil);
+  gtk_toggle_button_set_group (self->stamp, self->pencil);
   gtk_toggle_button_set_active (self->pencil, TRUE);
 
+  g_signal_connect (self->pencil, "toggled", G_CALLBACK (tool_toggled), self);
+  g_signal_connect (self->draw_line, "toggled", G_CALLBACK (tool_toggled), self);
+  g_signal_connect (self->fill, "toggled", G_CALLBACK (tool_toggled), self);
+  g_signal_connect (self->rectangle, "toggled", G_CALLBACK (tool_toggled), self);
+  g_signal_connect (self->rectangle_outline, "toggled", G_CALLBACK (tool_toggled), self);
+  g_signal_connect (self->ellipse, "toggled", G_CALLBACK (tool_toggled), self);
+  g_signal_connect (self->stamp, "toggled", G_CALLBACK (tool_toggled), self);
+  g_signal_connect (self->symmetry, "notify::selected", G_CALLBACK (symmetry_selected), self);
+
   g_signal_connect (self->undo, "clicked", G_CALLBACK (undo_clicked), self);
   g_signal_connect (self->redo, "clicked", G_CALLBACK (redo_clicked), self);
+  g_signal_connect (self->stats_toggle, "toggled", G_CALLBACK (stats_toggled), self);
+  g_signal_connect (self->stats_reset, "clicked", G_CALLBACK (stats_reset_clicked), self);
+  g_signal_connect (self->stats_copy, "clicked", G_CALLBACK (stats_copy_clicked), self);
 
   motion_controller = gtk_event_controller_motion_new ();
   g_signal_connect (motion_controller, "enter", G_CALLBACK (motion_enter), self);
@@ -298,6 +454,194 @@ map_handle_changed (GcvMapEditor        *editor,
   read_map_handle (overlay);
 }
 
+static void
+setup_stamp_listitem (GtkListItemFactory  *factory,
+                      GtkListItem         *list_item,
+                      GcvMapEditorOverlay *overlay)
+{
+  GtkWidget *box     = NULL;
+  GtkWidget *picture = NULL;
+  GtkWidget *label   = NULL;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 10);
+
+  picture = gtk_picture_new ();
+  gtk_widget_set_size_request (picture, 48, 48);
+  gtk_picture_set_content_fit (GTK_PICTURE (picture), GTK_CONTENT_FIT_CONTAIN);
+  gtk_box_append (GTK_BOX (box), picture);
+
+  label = gtk_label_new (NULL);
+  gtk_label_set_xalign (GTK_LABEL (label), 0.0);
+  gtk_label_set_ellipsize (GTK_LABEL (label), PANGO_ELLIPSIZE_END);
+  gtk_widget_set_hexpand (label, TRUE);
+  gtk_box_append (GTK_BOX (box), label);
+
+  gtk_list_item_set_child (list_item, box);
+}
+
+static void
+bind_stamp_listitem (GtkListItemFactory  *factory,
+                     GtkListItem         *list_item,
+                     GcvMapEditorOverlay *overlay)
+{
+  GcvStamp        *stamp     = NULL;
+  GtkWidget       *box       = NULL;
+  GtkWidget       *picture   = NULL;
+  GtkWidget       *label     = NULL;
+  g_autofree char *name      = NULL;
+  g_autoptr (GdkTexture) tex = NULL;
+  GBinding *binding          = NULL;
+
+  stamp   = GCV_STAMP (gtk_list_item_get_item (list_item));
+  box     = gtk_list_item_get_child (list_item);
+  picture = gtk_widget_get_first_child (box);
+  label   = gtk_widget_get_next_sibling (picture);
+
+  g_object_get (
+      stamp,
+      "name", &name,
+      "thumbnail", &tex,
+      NULL);
+  gtk_label_set_label (GTK_LABEL (label), name);
+
+  binding = g_object_bind_property (
+      stamp, "thumbnail",
+      picture, "paintable",
+      G_BINDING_SYNC_CREATE);
+  g_object_set_data (G_OBJECT (list_item), "thumbnail-binding", binding);
+
+  /* Stamps are only read once they scroll into view */
+  if (tex == NULL)
+    gcv_stamp_load_async (stamp, G_PRIORITY_LOW, NULL, NULL, NULL);
+}
+
+static void
+unbind_stamp_listitem (GtkListItemFactory  *factory,
+                       GtkListItem         *list_item,
+                       GcvMapEditorOverlay *overlay)
+{
+  GBinding *binding = NULL;
+
+  binding = g_object_steal_data (G_OBJECT (list_item), "thumbnail-binding");
+  if (binding != NULL)
+    g_binding_unbind (binding);
+}
+
+static void
+stamp_activated (GtkListView         *list_view,
+                 guint                position,
+                 GcvMapEditorOverlay *overlay)
+{
+  g_autoptr (GcvStamp) stamp = NULL;
+
+  if (overlay->stamp_store == NULL)
+    return;
+
+  stamp = g_list_model_get_item (G_LIST_MODEL (overlay->stamp_store), position);
+  if (stamp == NULL)
+    return;
+
+  gcv_stamp_load_async (
+      stamp, G_PRIORITY_DEFAULT, NULL,
+      stamp_loaded, g_object_ref (overlay));
+}
+
+static void
+stamp_loaded (GObject      *source_object,
+              GAsyncResult *res,
+              gpointer      data)
+{
+  g_autoptr (GcvMapEditorOverlay) overlay = data;
+  g_autoptr (GError) local_error          = NULL;
+  g_autoptr (GListModel) strokes          = NULL;
+
+  strokes = gcv_stamp_load_finish (GCV_STAMP (source_object), res, &local_error);
+
+  if (strokes == NULL)
+    {
+      gcv_dialog_for_widget (
+          "An Error Occurred",
+          "Could not load the stamp",
+          local_error->message,
+          FALSE, GTK_WIDGET (overlay), NULL);
+      return;
+    }
+
+  if (overlay->editor == NULL)
+    return;
+
+  g_object_set (
+      overlay->editor,
+      "stamp", strokes,
+      "tool", GCV_MAP_EDITOR_TOOL_STAMP,
+      NULL);
+}
+
+static void
+save_stamp_clicked (GtkButton           *self,
+                    GcvMapEditorOverlay *overlay)
+{
+  const char *name               = NULL;
+  g_autoptr (GListModel) strokes = NULL;
+  g_autoptr (GError) local_error = NULL;
+  g_autoptr (GcvStamp) stamp     = NULL;
+  g_autoptr (GFile) file         = NULL;
+  guint n_stamps                 = 0;
+
+  if (overlay->editor == NULL || overlay->stamp_store == NULL)
+    return;
+
+  name = gtk_editable_get_text (GTK_EDITABLE (overlay->stamp_name));
+  g_object_get (
+      overlay->editor,
+      "stamp", &strokes,
+      NULL);
+  if (name == NULL || *name == '\0' || strokes == NULL)
+    return;
+
+  stamp = gcv_stamp_save_to_library (strokes, name, &local_error);
+  if (stamp == NULL)
+    {
+      gcv_dialog_for_widget (
+          "An Error Occurred",
+          "Could not save the stamp",
+          local_error->message,
+          FALSE, GTK_WIDGET (overlay), NULL);
+      return;
+    }
+
+  g_object_get (
+      stamp,
+      "file", &file,
+      NULL);
+
+  /* Saving under an existing name replaced its file, so
+   * replace its row too rather than listing it twice
+   */
+  n_stamps = g_list_model_get_n_items (G_LIST_MODEL (overlay->stamp_store));
+  for (guint i = 0; i < n_stamps; i++)
+    {
+      g_autoptr (GcvStamp) other   = NULL;
+      g_autoptr (GFile) other_file = NULL;
+
+      other = g_list_model_get_item (G_LIST_MODEL (overlay->stamp_store), i);
+      g_object_get (
+          other,
+          "file", &other_file,
+          NULL);
+
+      if (other_file != NULL && g_file_equal (file, other_file))
+        {
+          g_list_store_splice (overlay->stamp_store, i, 1, (gpointer *) &stamp, 1);
+          gtk_editable_set_text (GTK_EDITABLE (overlay->stamp_name), "");
+          return;
+        }
+    }
+
+  g_list_store_append (overlay->stamp_store, stamp);
+  gtk_editable_set_text (GTK_EDITABLE (overlay->stamp_name), "");
+}
+
 static void
 model_items_changed (GListModel          *self,
                      guint                position,
@@ -330,21 +674,108 @@ drawing_changed (GcvMapEditor        *editor,
 }
 
 static void
-line_mode_changed (GcvMapEditor        *editor,
-                   GParamSpec          *pspec,
-                   GcvMapEditorOverlay *overlay)
+tool_changed (GcvMapEditor        *editor,
+              GParamSpec          *pspec,
+              GcvMapEditorOverlay *overlay)
 {
-  gboolean line_mode = FALSE;
+  GcvMapEditorTool tool = GCV_MAP_EDITOR_TOOL_PENCIL;
 
   g_object_get (
       editor,
-      "line-mode", &line_mode,
+      "tool", &tool,
       NULL);
 
-  if (line_mode)
-    gtk_toggle_button_set_active (overlay->draw_line, TRUE);
-  else
-    gtk_toggle_button_set_active (overlay->pencil, TRUE);
+  switch (tool)
+    {
+    case GCV_MAP_EDITOR_TOOL_LINE:
+      gtk_toggle_button_set_active (overlay->draw_line, TRUE);
+      break;
+    case GCV_MAP_EDITOR_TOOL_FILL:
+      gtk_toggle_button_set_active (overlay->fill, TRUE);
+      break;
+    case GCV_MAP_EDITOR_TOOL_RECTANGLE:
+      gtk_toggle_button_set_active (overlay->rectangle, TRUE);
+      break;
+    case GCV_MAP_EDITOR_TOOL_RECTANGLE_OUTLINE:
+      gtk_toggle_button_set_active (overlay->rectangle_outline, TRUE);
+      break;
+    case GCV_MAP_EDITOR_TOOL_ELLIPSE:
+      gtk_toggle_button_set_active (overlay->ellipse, TRUE);
+      break;
+    case GCV_MAP_EDITOR_TOOL_STAMP:
+      gtk_toggle_button_set_active (overlay->stamp, TRUE);
+      break;
+    case GCV_MAP_EDITOR_TOOL_PENCIL:
+    default:
+      gtk_toggle_button_set_active (overlay->pencil, TRUE);
+      break;
+    }
+}
+
+static void
+tool_toggled (GtkToggleButton     *button,
+              GcvMapEditorOverlay *overlay)
+{
+  GcvMapEditorTool tool = GCV_MAP_EDITOR_TOOL_PENCIL;
+
+  if (overlay->editor == NULL ||
+      !gtk_toggle_button_get_active (button))
+    return;
+
+  if (button == overlay->draw_line)
+    tool = GCV_MAP_EDITOR_TOOL_LINE;
+  else if (button == overlay->fill)
+    tool = GCV_MAP_EDITOR_TOOL_FILL;
+  else if (button == overlay->rectangle)
+    tool = GCV_MAP_EDITOR_TOOL_RECTANGLE;
+  else if (button == overlay->rectangle_outline)
+    tool = GCV_MAP_EDITOR_TOOL_RECTANGLE_OUTLINE;
+  else if (button == overlay->ellipse)
+    tool = GCV_MAP_EDITOR_TOOL_ELLIPSE;
+  else if (button == overlay->stamp)
+    tool = GCV_MAP_EDITOR_TOOL_STAMP;
+
+  g_object_set (
+      overlay->editor,
+      "tool", tool,
+      NULL);
+}
+
+static void
+symmetry_changed (GcvMapEditor        *editor,
+                  GParamSpec          *pspec,
+                  GcvMapEditorOverlay *overlay)
+{
+  GcvMapEditorSymmetry symmetry = GCV_MAP_EDITOR_SYMMETRY_NONE;
+
+  g_object_get (
+      editor,
+      "symmetry", &symmetry,
+      NULL);
+
+  /* The dropdown rows follow the enum order */
+  if (gtk_drop_down_get_selected (overlay->symmetry) != (guint) symmetry)
+    gtk_drop_down_set_selected (overlay->symmetry, symmetry);
+}
+
+static void
+symmetry_selected (GtkDropDown         *drop_down,
+                   GParamSpec          *pspec,
+                   GcvMapEditorOverlay *overlay)
+{
+  guint selected = 0;
+
+  if (overlay->editor == NULL)
+    return;
+
+  selected = gtk_drop_down_get_selected (drop_down);
+  if (selected == GTK_INVALID_LIST_POSITION)
+    return;
+
+  g_object_set (
+      overlay->editor,
+      "symmetry", (GcvMapEditorSymmetry) selected,
+      NULL);
 }
 
 static void
@@ -400,6 +831,54 @@ redo_clicked (GtkButton           *self,
     }
 }
 
+static void
+stats_toggled (GtkToggleButton     *self,
+               GcvMapEditorOverlay *overlay)
+{
+  if (overlay->stats_source != 0)
+    {
+      g_clear_handle_id (&overlay->stats_source, g_source_remove);
+      gcv_stats_disable ();
+    }
+
+  if (gtk_toggle_button_get_active (self))
+    {
+      gcv_stats_enable ();
+      refresh_stats (overlay);
+      overlay->stats_source = g_timeout_add (
+          STATS_REFRESH_INTERVAL_MS, (GSourceFunc) refresh_stats, overlay);
+    }
+}
+
+static void
+stats_reset_clicked (GtkButton           *self,
+                     GcvMapEditorOverlay *overlay)
+{
+  gcv_stats_reset ();
+  refresh_stats (overlay);
+}
+
+static void
+stats_copy_clicked (GtkButton           *self,
+                    GcvMapEditorOverlay *overlay)
+{
+  g_autofree char *json = NULL;
+
+  json = gcv_stats_dump_json ();
+  gdk_clipboard_set_text (gtk_widget_get_clipboard (GTK_WIDGET (overlay)), json);
+}
+
+static gboolean
+refresh_stats (GcvMapEditorOverlay *self)
+{
+  g_autofree char *text = NULL;
+
+  text = gcv_stats_dump_text ();
+  gtk_label_set_label (self->stats_label, text[0] != '\0' ? text : "No samples yet");
+
+  return G_SOURCE_CONTINUE;
+}
+
 static double
 distance_to_rect (double rx,
                   double ry,
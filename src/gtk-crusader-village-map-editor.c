@@ -29,8 +29,131 @@
 #include "gtk-crusader-village-map-editor.h"
 #include "gtk-crusader-village-map-handle.h"
 #include "gtk-crusader-village-map.h"
+#include "gtk-crusader-village-stats.h"
 
 #define BASE_TILE_SIZE 16.0
+#define MIN_ZOOM       0.05
+#define LOD_ZOOM       0.25
+#define MAX_ZOOM       7.5
+
+#define LABEL_CACHE_SIZE         512
+#define LABEL_CACHE_WIDTH_BUCKET 8.0
+
+#define MAX_RENDER_REGIONS 8
+
+#define ZOOM_SETTLE_MS          150
+#define MAX_ZOOM_TEXTURE_PIXELS (4096 * 2048)
+
+G_DEFINE_ENUM_TYPE (
+    GcvMapEditorTool,
+    gcv_map_editor_tool,
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_TOOL_PENCIL, "pencil"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_TOOL_LINE, "line"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_TOOL_FILL, "fill"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_TOOL_RECTANGLE, "rectangle"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_TOOL_RECTANGLE_OUTLINE, "rectangle-outline"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_TOOL_ELLIPSE, "ellipse"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_TOOL_STAMP, "stamp"))
+
+G_DEFINE_ENUM_TYPE (
+    GcvMapEditorSymmetry,
+    gcv_map_editor_symmetry,
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_SYMMETRY_NONE, "none"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_SYMMETRY_HORIZONTAL, "horizontal"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_SYMMETRY_VERTICAL, "vertical"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_SYMMETRY_FOUR_WAY, "four-way"),
+    G_DEFINE_ENUM_VALUE (GCV_MAP_EDITOR_SYMMETRY_ROTATIONAL, "rotational"))
+
+#define IS_SHAPE_TOOL(tool)                          \
+  ((tool) == GCV_MAP_EDITOR_TOOL_RECTANGLE ||         \
+   (tool) == GCV_MAP_EDITOR_TOOL_RECTANGLE_OUTLINE || \
+   (tool) == GCV_MAP_EDITOR_TOOL_ELLIPSE)
+
+typedef struct
+{
+  GList          link;
+  char          *key;
+  PangoLayout   *layout;
+  PangoRectangle extents;
+  double         width;
+  GskRenderNode *node;
+  GdkRGBA        node_rgba;
+} LabelCacheEntry;
+
+enum
+{
+  RENDER_LAYER_BASE,
+  RENDER_LAYER_TILES,
+  RENDER_LAYER_UNITS,
+  RENDER_LAYER_LABELS,
+
+  N_RENDER_LAYERS,
+};
+
+/* Everything a render worker needs, captured on the main
+ * thread so workers never touch the model or the widget
+ */
+typedef struct
+{
+  guint          index;
+  GcvItemKind    kind;
+  int            tile_width;
+  int            tile_height;
+  GdkTexture    *texture;
+  GskRenderNode *label_node;
+  PangoRectangle label_extents;
+  double         label_width;
+} RenderStroke;
+
+/* A visible instance, bucketed into the band
+ * that draws it when the job is built
+ */
+typedef struct
+{
+  guint           stroke;
+  graphene_rect_t rect;
+} RenderInstance;
+
+typedef struct
+{
+  GArray         *strokes;
+  guint           cursor;
+  guint           cursor_len;
+  double          tile_size;
+  double          map_width;
+  double          map_height;
+  int             map_tile_width;
+  int             map_tile_height;
+  graphene_rect_t extents;
+  GdkRGBA         bg_rgba;
+  gboolean        dark_theme;
+} RenderInput;
+
+typedef struct
+{
+  GArray        *instances;
+  GskRenderNode *layers[N_RENDER_LAYERS];
+  gint64         n_nodes;
+} RenderRegion;
+
+typedef struct
+{
+  RenderInput     input;
+  graphene_rect_t viewport;
+  double          zoom;
+  guint           n_regions;
+  guint           n_pending;
+  RenderRegion   *regions;
+  gint64          n_culled;
+  guint           generation;
+  gint64          begin_time;
+} RenderJob;
+
+typedef struct
+{
+  RenderJob *job;
+  guint      region;
+} RenderTaskData;
 
 struct _GcvMapEditor
 {
@@ -50,21 +173,52 @@ struct _GcvMapEditor
   GcvItemArea  *item_area;
   GcvBrushArea *brush_area;
 
+  GcvMapEditorTool tool;
+
+  /* Axis in half tiles, -1 follows the keep at the map center */
+  GcvMapEditorSymmetry symmetry;
+  int                  symmetry_x2;
+  int                  symmetry_y2;
+  GArray              *mirror_batch;
+
   int      border_gap;
-  gboolean line_mode;
   gboolean draw_after_cursor;
 
-  gboolean show_accessibility;
-  guint8  *accessibility_mask;
+  gboolean    show_accessibility;
+  guint8     *accessibility_mask;
+  guint8     *accessibility_pixels;
+  GdkTexture *accessibility_tex;
+
+  GListModel *lod_model;
+  guint      *lod_owners;
+  GByteArray *lod_kinds;
+  guint       lod_n_strokes;
+  guint       lod_cursor;
+  guint       lod_cursor_len;
+  gboolean    lod_stale;
+  guint8     *lod_pixels;
+  GdkTexture *lod_tex;
 
   GHashTable     *tile_textures;
+  GHashTable     *label_cache;
+  GQueue          label_lru;
   GskRenderNode  *render_cache;
+  const char     *render_cache_reason;
+  double          render_cache_zoom;
+  gboolean        render_cache_dirty;
+  RenderJob      *render_job;
+  guint           render_generation;
+  GCancellable   *render_cancellable;
   graphene_rect_t viewport;
   GdkTexture     *bg_image_tex;
 
   double   zoom;
   gboolean queue_center;
 
+  GdkTexture     *zoom_tex;
+  graphene_rect_t zoom_tex_bounds;
+  guint           zoom_settle_source;
+
   double pointer_x;
   double pointer_y;
   int    hover_x;
@@ -89,13 +243,37 @@ struct _GcvMapEditor
   GtkGesture *zoom_gesture;
 
   GcvItemStroke *current_stroke;
+
+  /* Last committed stroke, drawn over the stale render
+   * cache until a cache that includes it arrives
+   */
+  GcvItemStroke *pending_stroke;
+  guint          pending_generation;
   GArray        *stroke_tracker;
+  GArray        *stroke_tracker_counts;
+  GArray        *draw_samples;
+  guint          draw_tick;
 
-  guint8        *brush_mask;
+  guint64       *brush_mask;
+  guint          brush_stride;
   int            brush_width;
   int            brush_height;
   GskRenderNode *brush_node;
   GtkAdjustment *brush_adjustment;
+
+  GListModel    *stamp;
+  GskRenderNode *stamp_node;
+  int            stamp_x;
+  int            stamp_y;
+  int            stamp_width;
+  int            stamp_height;
+
+  GListModel    *diagnostics;
+  GskRenderNode *diagnostics_node;
+  double         diagnostics_zoom;
+
+  GtkWidget *map_layer;
+  GtkWidget *cursor_layer;
 };
 
 static void scrollable_iface_init (GtkScrollableInterface *iface);
@@ -106,6 +284,51 @@ G_DEFINE_TYPE_WITH_CODE (
     GTK_TYPE_WIDGET,
     G_IMPLEMENT_INTERFACE (GTK_TYPE_SCROLLABLE, scrollable_iface_init))
 
+typedef void (*LayerSnapshotFunc) (GcvMapEditor *editor,
+                                   GtkSnapshot  *snapshot);
+
+/* A child that just forwards its snapshot to the editor. GTK keeps
+ * the render node of every child that did not queue a draw, so
+ * the layers can be invalidated independently of each other.
+ */
+#define GCV_TYPE_MAP_EDITOR_LAYER (gcv_map_editor_layer_get_type ())
+G_DECLARE_FINAL_TYPE (GcvMapEditorLayer, gcv_map_editor_layer, GCV, MAP_EDITOR_LAYER, GtkWidget)
+
+struct _GcvMapEditorLayer
+{
+  GtkWidget parent_instance;
+
+  GcvMapEditor     *editor;
+  LayerSnapshotFunc snapshot_func;
+};
+
+G_DEFINE_FINAL_TYPE (GcvMapEditorLayer, gcv_map_editor_layer, GTK_TYPE_WIDGET)
+
+static void
+gcv_map_editor_layer_snapshot (GtkWidget   *widget,
+                               GtkSnapshot *snapshot)
+{
+  GcvMapEditorLayer *self = GCV_MAP_EDITOR_LAYER (widget);
+
+  if (self->editor != NULL)
+    self->snapshot_func (self->editor, snapshot);
+}
+
+static void
+gcv_map_editor_layer_class_init (GcvMapEditorLayerClass *klass)
+{
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  widget_class->snapshot = gcv_map_editor_layer_snapshot;
+}
+
+static void
+gcv_map_editor_layer_init (GcvMapEditorLayer *self)
+{
+  gtk_widget_set_can_target (GTK_WIDGET (self), FALSE);
+  gtk_widget_set_overflow (GTK_WIDGET (self), GTK_OVERFLOW_HIDDEN);
+}
+
 enum
 {
   PROP_0,
@@ -119,8 +342,13 @@ enum
   PROP_HOVER_Y,
   PROP_DRAWING,
   PROP_LINE_MODE,
+  PROP_TOOL,
+  PROP_STAMP,
+  PROP_SYMMETRY,
+  PROP_DIAGNOSTICS,
   PROP_DRAW_AFTER_CURSOR,
   PROP_SHOW_ACCESSIBILITY,
+  PROP_ZOOM,
 
   LAST_NATIVE_PROP,
 
@@ -153,6 +381,27 @@ static void
 gcv_map_editor_snapshot (GtkWidget   *widget,
                          GtkSnapshot *snapshot);
 
+static GtkWidget *
+new_layer (GcvMapEditor     *self,
+           LayerSnapshotFunc snapshot_func);
+
+static void
+allocate_layer (GtkWidget *layer,
+                int        width,
+                int        height,
+                int        baseline);
+
+static void
+snapshot_map_layer (GcvMapEditor *editor,
+                    GtkSnapshot  *snapshot);
+
+static void
+snapshot_cursor_layer (GcvMapEditor *editor,
+                       GtkSnapshot  *snapshot);
+
+static void
+queue_draw_layers (GcvMapEditor *self);
+
 static void
 back_page_cb (GtkWidget  *widget,
               const char *action_name,
@@ -262,6 +511,64 @@ draw_gesture_update (GtkGestureDrag *gesture,
                      double          offset_y,
                      GcvMapEditor   *editor);
 
+static inline guint64
+blocked_bits (const guint64 *occupied,
+              const guint64 *buildings,
+              guint          stride,
+              int            map_width,
+              GcvItemKind    kind,
+              int            x,
+              int            y);
+
+static inline int
+lowest_bit (guint64 bits);
+
+static void
+queue_draw_sample (GcvMapEditor *self,
+                   double        x,
+                   double        y);
+
+static guint
+mirror_instance (GcvMapEditor          *self,
+                 GcvItemStrokeInstance  instance,
+                 int                    item_tile_width,
+                 int                    item_tile_height,
+                 int                    map_tile_width,
+                 int                    map_tile_height,
+                 GcvItemStrokeInstance *images);
+
+static void
+place_mirror_batch (GcvMapEditor  *self,
+                    GcvItemKind    item_kind,
+                    int            item_tile_width,
+                    int            item_tile_height,
+                    const guint64 *occupied,
+                    const guint64 *buildings,
+                    guint          stride,
+                    int            map_tile_width,
+                    int            map_tile_height);
+
+static gboolean
+draw_tick_cb (GtkWidget     *widget,
+              GdkFrameClock *frame_clock,
+              GcvMapEditor  *editor);
+
+static void
+flush_draw_samples (GcvMapEditor *editor);
+
+static void
+place_shape (GcvMapEditor         *self,
+             GcvItemStrokeInstance from,
+             GcvItemStrokeInstance to,
+             GcvItemKind           item_kind,
+             int                   item_tile_width,
+             int                   item_tile_height,
+             const guint64        *occupied,
+             const guint64        *buildings,
+             guint                 stride,
+             int                   map_tile_width,
+             int                   map_tile_height);
+
 static void
 draw_gesture_end (GtkGestureDrag *gesture,
                   double          offset_x,
@@ -273,6 +580,34 @@ draw_gesture_end_gesture (GtkGesture       *self,
                           GdkEventSequence *sequence,
                           GcvMapEditor     *editor);
 
+static void
+commit_stroke (GcvMapEditor  *self,
+               GcvItemStroke *stroke);
+
+static void
+set_tool (GcvMapEditor    *self,
+          GcvMapEditorTool tool);
+
+static void
+fill_at (GcvMapEditor *self,
+         GcvItem      *item,
+         double        x,
+         double        y);
+
+static void
+set_stamp (GcvMapEditor *self,
+           GListModel   *stamp);
+
+static void
+place_stamp (GcvMapEditor *self,
+             double        x,
+             double        y);
+
+static void
+set_symmetry_axis (GcvMapEditor *self,
+                   double        x,
+                   double        y);
+
 static void
 cancel_gesture_begin_gesture (GtkGesture       *self,
                               GdkEventSequence *sequence,
@@ -360,6 +695,116 @@ read_brush (GcvMapEditor *self,
 static void
 read_background_image (GcvMapEditor *self);
 
+static void
+update_accessibility_texture (GcvMapEditor *self,
+                              int           map_tile_width,
+                              int           map_tile_height);
+
+static void
+ensure_accessibility_texture (GcvMapEditor *self,
+                              int           map_tile_width,
+                              int           map_tile_height);
+
+static void
+update_lod_texture (GcvMapEditor *self,
+                    int           map_tile_width,
+                    int           map_tile_height);
+
+static GdkTexture *
+upload_tile_pixels (const guint8 *pixels,
+                    int           width,
+                    int           height,
+                    GdkTexture   *update_texture,
+                    int           min_x,
+                    int           min_y,
+                    int           max_x,
+                    int           max_y);
+
+static void
+lod_strokes_changed (GListModel   *model,
+                     guint         position,
+                     guint         removed,
+                     guint         added,
+                     GcvMapEditor *editor);
+
+static void
+diagnostics_changed (GListModel   *model,
+                     guint         position,
+                     guint         removed,
+                     guint         added,
+                     GcvMapEditor *editor);
+
+static GskRenderNode *
+build_diagnostics_node (GcvMapEditor *self,
+                        double        tile_size);
+
+static void
+invalidate_render_cache (GcvMapEditor *self,
+                         const char   *reason);
+
+static gboolean
+capture_zoom_texture (GcvMapEditor *self);
+
+static void
+begin_interim_zoom (GcvMapEditor *self);
+
+static void
+end_interim_zoom (GcvMapEditor *self);
+
+static gboolean
+zoom_settle_timeout (GcvMapEditor *self);
+
+static LabelCacheEntry *
+ensure_label (GcvMapEditor *self,
+              const char   *text,
+              double        width,
+              guint         font_hash);
+
+static void
+destroy_label_cache_entry (gpointer data);
+
+static GskRenderNode *
+ensure_label_node (GcvMapEditor    *self,
+                   LabelCacheEntry *label,
+                   const GdkRGBA   *rgba);
+
+static void
+start_render_job (GcvMapEditor          *self,
+                  const graphene_rect_t *viewport,
+                  int                    map_tile_width,
+                  int                    map_tile_height,
+                  gboolean               synchronous);
+
+static void
+finish_render_job (GcvMapEditor *self);
+
+static void
+cancel_render_job (GcvMapEditor *self);
+
+static void
+build_render_region (RenderJob *job,
+                     guint      region);
+
+static void
+render_region_async_thread (GTask        *task,
+                            gpointer      object,
+                            gpointer      task_data,
+                            GCancellable *cancellable);
+
+static void
+render_region_finish_cb (GObject      *source_object,
+                         GAsyncResult *res,
+                         gpointer      data);
+
+static void
+clear_render_stroke (gpointer data);
+
+static void
+release_render_job (gpointer data);
+
+static void
+destroy_render_task_data (gpointer data);
+
 static void
 background_texture_load_async_thread (GTask        *task,
                                       gpointer      object,
@@ -414,18 +859,53 @@ gcv_map_editor_dispose (GObject *object)
   g_clear_object (&self->hadjustment);
   g_clear_object (&self->vadjustment);
   g_clear_object (&self->current_stroke);
+  g_clear_object (&self->pending_stroke);
   g_clear_pointer (&self->stroke_tracker, g_array_unref);
+  g_clear_pointer (&self->stroke_tracker_counts, g_array_unref);
+  if (self->draw_tick != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->draw_tick);
+      self->draw_tick = 0;
+    }
+  g_clear_pointer (&self->draw_samples, g_array_unref);
+  g_clear_pointer (&self->mirror_batch, g_array_unref);
   g_clear_pointer (&self->tile_textures, g_hash_table_unref);
+  g_clear_pointer (&self->label_cache, g_hash_table_unref);
+  g_queue_init (&self->label_lru);
   g_clear_object (&self->bg_image_tex);
+  cancel_render_job (self);
   g_clear_pointer (&self->render_cache, gsk_render_node_unref);
   g_clear_pointer (&self->brush_node, gsk_render_node_unref);
+  g_clear_object (&self->stamp);
+  g_clear_pointer (&self->stamp_node, gsk_render_node_unref);
   g_clear_pointer (&self->accessibility_mask, g_free);
+  g_clear_pointer (&self->accessibility_pixels, g_free);
+  g_clear_object (&self->accessibility_tex);
+
+  if (self->lod_model != NULL)
+    g_signal_handlers_disconnect_by_func (self->lod_model, lod_strokes_changed, self);
+  g_clear_object (&self->lod_model);
+  g_clear_pointer (&self->lod_owners, g_free);
+  g_clear_pointer (&self->lod_kinds, g_byte_array_unref);
+  g_clear_pointer (&self->lod_pixels, g_free);
+  g_clear_object (&self->lod_tex);
 
   if (self->brush_adjustment != NULL)
     g_signal_handlers_disconnect_by_func (
         self->brush_adjustment, selected_brush_adjustment_value_changed, self);
   g_clear_object (&self->brush_adjustment);
 
+  if (self->diagnostics != NULL)
+    g_signal_handlers_disconnect_by_func (self->diagnostics, diagnostics_changed, self);
+  g_clear_object (&self->diagnostics);
+  g_clear_pointer (&self->diagnostics_node, gsk_render_node_unref);
+
+  g_clear_handle_id (&self->zoom_settle_source, g_source_remove);
+  g_clear_object (&self->zoom_tex);
+
+  g_clear_pointer (&self->map_layer, gtk_widget_unparent);
+  g_clear_pointer (&self->cursor_layer, gtk_widget_unparent);
+
   G_OBJECT_CLASS (gcv_map_editor_parent_class)->dispose (object);
 }
 
@@ -464,7 +944,19 @@ gcv_map_editor_get_property (GObject    *object,
       g_value_set_boolean (value, self->current_stroke != NULL);
       break;
     case PROP_LINE_MODE:
-      g_value_set_boolean (value, self->line_mode);
+      g_value_set_boolean (value, self->tool == GCV_MAP_EDITOR_TOOL_LINE);
+      break;
+    case PROP_TOOL:
+      g_value_set_enum (value, self->tool);
+      break;
+    case PROP_STAMP:
+      g_value_set_object (value, self->stamp);
+      break;
+    case PROP_SYMMETRY:
+      g_value_set_enum (value, self->symmetry);
+      break;
+    case PROP_DIAGNOSTICS:
+      g_value_set_object (value, self->diagnostics);
       break;
     case PROP_DRAW_AFTER_CURSOR:
       g_value_set_boolean (value, self->draw_after_cursor);
@@ -472,6 +964,9 @@ gcv_map_editor_get_property (GObject    *object,
     case PROP_SHOW_ACCESSIBILITY:
       g_value_set_boolean (value, self->show_accessibility);
       break;
+    case PROP_ZOOM:
+      g_value_set_double (value, self->zoom);
+      break;
     case PROP_HADJUSTMENT:
       g_value_set_object (value, self->hadjustment);
       break;
@@ -535,7 +1030,7 @@ gcv_map_editor_set_property (GObject      *object,
           self->show_gradient = TRUE;
         }
 
-      gtk_widget_queue_draw (GTK_WIDGET (self));
+      queue_draw_layers (self);
       break;
 
     case PROP_MAP_HANDLE:
@@ -564,9 +1059,15 @@ gcv_map_editor_set_property (GObject      *object,
         }
 
       self->queue_center = TRUE;
+      invalidate_render_cache (self, "map-handle");
+      g_clear_object (&self->pending_stroke);
+      /* Never show the old map while the new one is built */
+      cancel_render_job (self);
       g_clear_pointer (&self->render_cache, gsk_render_node_unref);
       g_clear_pointer (&self->accessibility_mask, g_free);
-      gtk_widget_queue_draw (GTK_WIDGET (self));
+      g_clear_handle_id (&self->zoom_settle_source, g_source_remove);
+      g_clear_object (&self->zoom_tex);
+      queue_draw_layers (self);
       break;
 
     case PROP_ITEM_AREA:
@@ -600,7 +1101,48 @@ gcv_map_editor_set_property (GObject      *object,
       break;
 
     case PROP_LINE_MODE:
-      self->line_mode = g_value_get_boolean (value);
+      if (g_value_get_boolean (value))
+        set_tool (self, GCV_MAP_EDITOR_TOOL_LINE);
+      else if (self->tool == GCV_MAP_EDITOR_TOOL_LINE)
+        set_tool (self, GCV_MAP_EDITOR_TOOL_PENCIL);
+      break;
+
+    case PROP_TOOL:
+      set_tool (self, g_value_get_enum (value));
+      break;
+
+    case PROP_STAMP:
+      set_stamp (self, g_value_get_object (value));
+      break;
+
+    case PROP_SYMMETRY:
+      {
+        GcvMapEditorSymmetry new_val = GCV_MAP_EDITOR_SYMMETRY_NONE;
+
+        new_val = g_value_get_enum (value);
+        if (new_val != self->symmetry)
+          {
+            self->symmetry = new_val;
+            if (self->cursor_layer != NULL)
+              gtk_widget_queue_draw (self->cursor_layer);
+            g_object_notify_by_pspec (object, props[PROP_SYMMETRY]);
+          }
+      }
+      break;
+
+    case PROP_DIAGNOSTICS:
+      if (self->diagnostics != NULL)
+        g_signal_handlers_disconnect_by_func (
+            self->diagnostics, diagnostics_changed, self);
+      g_clear_object (&self->diagnostics);
+      g_clear_pointer (&self->diagnostics_node, gsk_render_node_unref);
+
+      self->diagnostics = g_value_dup_object (value);
+      if (self->diagnostics != NULL)
+        g_signal_connect (self->diagnostics, "items-changed",
+                          G_CALLBACK (diagnostics_changed), self);
+      if (self->cursor_layer != NULL)
+        gtk_widget_queue_draw (self->cursor_layer);
       break;
 
     case PROP_DRAW_AFTER_CURSOR:
@@ -611,8 +1153,9 @@ gcv_map_editor_set_property (GObject      *object,
         if (self->draw_after_cursor != new_val)
           {
             self->draw_after_cursor = new_val;
-            g_clear_pointer (&self->render_cache, gsk_render_node_unref);
-            gtk_widget_queue_draw (GTK_WIDGET (self));
+            invalidate_render_cache (self, "draw-after-cursor");
+            self->lod_stale = TRUE;
+            queue_draw_layers (self);
           }
       }
       break;
@@ -625,9 +1168,30 @@ gcv_map_editor_set_property (GObject      *object,
         if (self->show_accessibility != new_val)
           {
             self->show_accessibility = new_val;
-            g_clear_pointer (&self->render_cache, gsk_render_node_unref);
+            invalidate_render_cache (self, "show-accessibility");
             g_clear_pointer (&self->accessibility_mask, g_free);
-            gtk_widget_queue_draw (GTK_WIDGET (self));
+            if (!new_val)
+              {
+                g_clear_pointer (&self->accessibility_pixels, g_free);
+                g_clear_object (&self->accessibility_tex);
+              }
+            queue_draw_layers (self);
+          }
+      }
+      break;
+
+    case PROP_ZOOM:
+      {
+        double new_val = 0.0;
+
+        new_val = g_value_get_double (value);
+        if (self->zoom != new_val)
+          {
+            self->zoom = new_val;
+            invalidate_render_cache (self, "zoom");
+            update_scrollable (self, FALSE);
+            queue_draw_layers (self);
+            g_object_notify_by_pspec (object, props[PROP_ZOOM]);
           }
       }
       break;
@@ -771,6 +1335,40 @@ gcv_map_editor_class_init (GcvMapEditorClass *klass)
           "Line Mode",
           "Whether this widget draws lines instead of freehand",
           FALSE,
+          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
+  props[PROP_TOOL] =
+      g_param_spec_enum (
+          "tool",
+          "Tool",
+          "The tool used when drawing on the map",
+          GCV_TYPE_MAP_EDITOR_TOOL,
+          GCV_MAP_EDITOR_TOOL_PENCIL,
+          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
+  props[PROP_STAMP] =
+      g_param_spec_object (
+          "stamp",
+          "Stamp",
+          "A list of `GcvItemStroke`s placed together by the stamp tool",
+          G_TYPE_LIST_MODEL,
+          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
+  props[PROP_SYMMETRY] =
+      g_param_spec_enum (
+          "symmetry",
+          "Symmetry",
+          "How drawn instances are mirrored around the symmetry axis",
+          GCV_TYPE_MAP_EDITOR_SYMMETRY,
+          GCV_MAP_EDITOR_SYMMETRY_NONE,
+          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
+  props[PROP_DIAGNOSTICS] =
+      g_param_spec_object (
+          "diagnostics",
+          "Diagnostics",
+          "A list of `GcvDiagnostic`s to mark on the map",
+          G_TYPE_LIST_MODEL,
           G_PARAM_READWRITE);
 
   props[PROP_DRAW_AFTER_CURSOR] =
@@ -789,6 +1387,14 @@ gcv_map_editor_class_init (GcvMapEditorClass *klass)
           FALSE,
           G_PARAM_READWRITE);
 
+  props[PROP_ZOOM] =
+      g_param_spec_double (
+          "zoom",
+          "Zoom",
+          "The scale at which the map is drawn",
+          MIN_ZOOM, MAX_ZOOM, 1.0,
+          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, LAST_NATIVE_PROP, props);
 
   g_object_class_override_property (object_class, PROP_HADJUSTMENT, "hadjustment");
@@ -819,7 +1425,12 @@ gcv_map_editor_init (GcvMapEditor *self)
 
   self->border_gap        = 2;
   self->zoom              = 1.0;
-  self->line_mode         = FALSE;
+  self->render_cache_zoom = 1.0;
+  self->lod_kinds         = g_byte_array_new ();
+  self->tool              = GCV_MAP_EDITOR_TOOL_PENCIL;
+  self->symmetry          = GCV_MAP_EDITOR_SYMMETRY_NONE;
+  self->symmetry_x2       = -1;
+  self->symmetry_y2       = -1;
   self->draw_after_cursor = TRUE;
 
   self->pointer_x    = -1.0;
@@ -831,10 +1442,16 @@ gcv_map_editor_init (GcvMapEditor *self)
   self->canvas_x     = -1.0;
   self->canvas_y     = -1.0;
 
-  self->stroke_tracker = g_array_new (FALSE, FALSE, sizeof (GcvItemStrokeInstance));
+  self->stroke_tracker        = g_array_new (FALSE, FALSE, sizeof (GcvItemStrokeInstance));
+  self->stroke_tracker_counts = g_array_new (FALSE, FALSE, sizeof (guint));
+  self->mirror_batch          = g_array_new (FALSE, FALSE, sizeof (GcvItemStrokeInstance));
+  self->draw_samples          = g_array_new (FALSE, FALSE, sizeof (GcvItemStrokeInstance));
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
+  self->map_layer    = new_layer (self, snapshot_map_layer);
+  self->cursor_layer = new_layer (self, snapshot_cursor_layer);
+
   self->gtk_settings = gtk_settings_get_default ();
   g_signal_connect (self->gtk_settings, "notify::gtk-application-prefer-dark-theme",
                     G_CALLBACK (dark_theme_changed), self);
@@ -844,6 +1461,8 @@ gcv_map_editor_init (GcvMapEditor *self)
       NULL);
 
   self->tile_textures = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_object_unref);
+  self->label_cache   = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, destroy_label_cache_entry);
+  g_queue_init (&self->label_lru);
 
   self->drag_gesture = gtk_gesture_drag_new ();
   gtk_gesture_single_set_button (GTK_GESTURE_SINGLE (self->drag_gesture), 2);
@@ -934,11 +1553,56 @@ gcv_map_editor_size_allocate (GtkWidget *widget,
   GcvMapEditor *editor = GCV_MAP_EDITOR (widget);
 
   update_scrollable (editor, FALSE);
+
+  allocate_layer (editor->map_layer, widget_width, widget_height, baseline);
+  allocate_layer (editor->cursor_layer, widget_width, widget_height, baseline);
 }
 
 static void
 gcv_map_editor_snapshot (GtkWidget   *widget,
                          GtkSnapshot *snapshot)
+{
+  GcvMapEditor *editor = GCV_MAP_EDITOR (widget);
+
+  gtk_widget_snapshot_child (widget, editor->map_layer, snapshot);
+  gtk_widget_snapshot_child (widget, editor->cursor_layer, snapshot);
+}
+
+static GtkWidget *
+new_layer (GcvMapEditor     *self,
+           LayerSnapshotFunc snapshot_func)
+{
+  GcvMapEditorLayer *layer = NULL;
+
+  layer                = g_object_new (GCV_TYPE_MAP_EDITOR_LAYER, NULL);
+  layer->editor        = self;
+  layer->snapshot_func = snapshot_func;
+  gtk_widget_set_parent (GTK_WIDGET (layer), GTK_WIDGET (self));
+
+  return GTK_WIDGET (layer);
+}
+
+static void
+allocate_layer (GtkWidget *layer,
+                int        width,
+                int        height,
+                int        baseline)
+{
+  int min_width  = 0;
+  int min_height = 0;
+
+  /* GTK requires a measure before every allocation,
+   * even though the layers always fill the editor
+   */
+  gtk_widget_measure (layer, GTK_ORIENTATION_HORIZONTAL, -1, &min_width, NULL, NULL, NULL);
+  gtk_widget_measure (layer, GTK_ORIENTATION_VERTICAL, width, &min_height, NULL, NULL, NULL);
+
+  gtk_widget_allocate (layer, MAX (width, min_width), MAX (height, min_height), baseline, NULL);
+}
+
+static void
+snapshot_map_layer (GcvMapEditor *editor,
+                    GtkSnapshot  *snapshot)
 {
 #define BORDER_WIDTH(w)           ((float[4]) { (w), (w), (w), (w) })
 #define BORDER_COLOR_LITERAL(...) ((GdkRGBA[4]) { __VA_ARGS__, __VA_ARGS__, __VA_ARGS__, __VA_ARGS__ })
@@ -951,25 +1615,19 @@ gcv_map_editor_snapshot (GtkWidget   *widget,
     { 0.25, { 0.55, 0.20, 0.40, 1.0 } },
     {  1.0, { 0.90, 0.40, 0.30, 1.0 } },
   };
-  const GskColorStop cursor_radial_gradient_color_stops[2] = {
-    { 0.0, { 0.3, 0.2, 0.4, 0.5 } },
-    { 1.0, { 0.1, 0.1, 0.1, 0.0 } },
-  };
 
-  GcvMapEditor   *editor        = GCV_MAP_EDITOR (widget);
-  int             widget_width  = 0;
-  int             widget_height = 0;
-  graphene_rect_t viewport      = { 0 };
-  graphene_rect_t extents       = { 0 };
-  double          tile_size     = 0.0;
-  g_autoptr (GListStore) model  = NULL;
-  guint   cursor                = 0;
-  guint   cursor_len            = 0;
-  int     map_tile_width        = 0;
-  int     map_tile_height       = 0;
-  double  map_width             = 0.0;
-  double  map_height            = 0.0;
-  GdkRGBA widget_rgba           = { 0 };
+  GtkWidget      *widget          = GTK_WIDGET (editor);
+  int             widget_width    = 0;
+  int             widget_height   = 0;
+  graphene_rect_t viewport        = { 0 };
+  double          tile_size       = 0.0;
+  int             map_tile_width  = 0;
+  int             map_tile_height = 0;
+  double          map_width       = 0.0;
+  double          map_height      = 0.0;
+  gint64          begin_time      = 0;
+
+  begin_time = g_get_monotonic_time ();
 
   widget_width  = gtk_widget_get_width (widget);
   widget_height = gtk_widget_get_height (widget);
@@ -1002,10 +1660,10 @@ gcv_map_editor_snapshot (GtkWidget   *widget,
           NULL);
 
       gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (-value_x, -value_y));
-      viewport = extents = GRAPHENE_RECT_INIT (value_x, value_y, (float) widget_width, (float) widget_height);
+      viewport = GRAPHENE_RECT_INIT (value_x, value_y, (float) widget_width, (float) widget_height);
     }
   else
-    viewport = extents = GRAPHENE_RECT_INIT (0, 0, (float) widget_width, (float) widget_height);
+    viewport = GRAPHENE_RECT_INIT (0, 0, (float) widget_width, (float) widget_height);
 
   viewport.origin.x /= editor->zoom;
   viewport.origin.y /= editor->zoom;
@@ -1014,13 +1672,6 @@ gcv_map_editor_snapshot (GtkWidget   *widget,
 
   tile_size = BASE_TILE_SIZE * editor->zoom;
 
-  g_object_get (
-      editor->handle,
-      "model", &model,
-      "cursor", &cursor,
-      "cursor-len", &cursor_len,
-      NULL);
-
   g_object_get (
       editor->map,
       "width", &map_tile_width,
@@ -1036,8 +1687,6 @@ gcv_map_editor_snapshot (GtkWidget   *widget,
           (double) editor->border_gap * tile_size));
   viewport.origin.x -= (double) editor->border_gap * BASE_TILE_SIZE;
   viewport.origin.y -= (double) editor->border_gap * BASE_TILE_SIZE;
-  extents.origin.x -= (double) editor->border_gap * tile_size;
-  extents.origin.y -= (double) editor->border_gap * tile_size;
 
   if (editor->bg_image_tex != NULL)
     gtk_snapshot_append_scaled_texture (
@@ -1054,7 +1703,7 @@ gcv_map_editor_snapshot (GtkWidget   *widget,
         editor->dark_theme ? bg_radial_gradient_color_stops_dark : bg_radial_gradient_color_stops,
         editor->dark_theme ? G_N_ELEMENTS (bg_radial_gradient_color_stops_dark) : G_N_ELEMENTS (bg_radial_gradient_color_stops));
 
-  if (editor->show_grid)
+  if (editor->show_grid && editor->zoom >= LOD_ZOOM)
     {
       gtk_snapshot_push_repeat (
           snapshot,
@@ -1076,370 +1725,188 @@ gcv_map_editor_snapshot (GtkWidget   *widget,
       BASE_TILE_SIZE / 2.0 * editor->zoom,
       BASE_TILE_SIZE * 2.0 * editor->zoom);
 
-  if (editor->render_cache == NULL ||
-      editor->viewport.origin.x > viewport.origin.x ||
-      editor->viewport.origin.y > viewport.origin.y ||
-      editor->viewport.origin.x + editor->viewport.size.width < viewport.origin.x + viewport.size.width ||
-      editor->viewport.origin.y + editor->viewport.size.height < viewport.origin.y + viewport.size.height)
+  if (editor->zoom < LOD_ZOOM)
     {
-      g_clear_pointer (&editor->render_cache, gsk_render_node_unref);
+      /* Individual tiles are a few pixels wide at most
+       * here, so draw one texel per tile instead
+       */
+      update_lod_texture (editor, map_tile_width, map_tile_height);
+      if (editor->lod_tex != NULL)
+        gtk_snapshot_append_scaled_texture (
+            snapshot,
+            editor->lod_tex,
+            GSK_SCALING_FILTER_NEAREST,
+            &GRAPHENE_RECT_INIT (0, 0, map_width, map_height));
 
-      editor->viewport = GRAPHENE_RECT_INIT (
-          viewport.origin.x - viewport.size.width / 2.0,
-          viewport.origin.y - viewport.size.height / 2.0,
-          viewport.size.width * 2.0,
-          viewport.size.height * 2.0);
-      extents = GRAPHENE_RECT_INIT (
-          extents.origin.x - extents.size.width / 2.0,
-          extents.origin.y - extents.size.height / 2.0,
-          extents.size.width * 2.0,
-          extents.size.height * 2.0);
+      if (editor->show_accessibility)
+        {
+          ensure_accessibility_texture (editor, map_tile_width, map_tile_height);
+          if (editor->accessibility_tex != NULL)
+            gtk_snapshot_append_scaled_texture (
+                snapshot,
+                editor->accessibility_tex,
+                GSK_SCALING_FILTER_NEAREST,
+                &GRAPHENE_RECT_INIT (0, 0, map_width, map_height));
+        }
     }
-
-  if (editor->render_cache == NULL)
+  else if (editor->zoom_tex != NULL)
+    {
+      /* Mid-zoom: stretch the last frame and leave the
+       * rebuild for when the zoom level settles
+       */
+      gtk_snapshot_append_scaled_texture (
+          snapshot,
+          editor->zoom_tex,
+          GSK_SCALING_FILTER_LINEAR,
+          &GRAPHENE_RECT_INIT (
+              editor->zoom_tex_bounds.origin.x * editor->zoom,
+              editor->zoom_tex_bounds.origin.y * editor->zoom,
+              editor->zoom_tex_bounds.size.width * editor->zoom,
+              editor->zoom_tex_bounds.size.height * editor->zoom));
+      gcv_stats_add_count ("editor.zoom.interim", 1);
+    }
+  else
     {
-      g_autoptr (GtkSnapshot) regen   = NULL;
-      g_autoptr (GtkSnapshot) units   = NULL;
-      g_autoptr (GtkSnapshot) layouts = NULL;
+      if ((editor->render_cache == NULL ||
+           !graphene_rect_contains_rect (&editor->viewport, &viewport)) &&
+          (editor->render_job == NULL ||
+           !graphene_rect_contains_rect (&editor->render_job->viewport, &viewport)))
+        invalidate_render_cache (editor, "viewport");
 
-      g_autoptr (GHashTable) texture_to_mask = NULL;
-      guint   total_strokes                  = 0;
-      guint   total_drawn_strokes            = 0;
-      GdkRGBA bg_rgba                        = { 0 };
+      if (editor->render_cache_dirty)
+        {
+          graphene_rect_t cache_viewport = { 0 };
+
+          cache_viewport = GRAPHENE_RECT_INIT (
+              viewport.origin.x - viewport.size.width / 2.0,
+              viewport.origin.y - viewport.size.height / 2.0,
+              viewport.size.width * 2.0,
+              viewport.size.height * 2.0);
+
+          /* With nothing to show in the meantime, just build it here */
+          start_render_job (
+              editor, &cache_viewport,
+              map_tile_width, map_tile_height,
+              editor->render_cache == NULL);
+        }
+      else
+        gcv_stats_add_count ("editor.render-cache.hit", 1);
 
-      GHashTableIter iter = { 0 };
+      if (editor->render_cache != NULL)
+        {
+          /* The cache may be stale and built for another
+           * zoom level while its replacement is in progress
+           */
+          gtk_snapshot_save (snapshot);
+          gtk_snapshot_scale (
+              snapshot,
+              editor->zoom / editor->render_cache_zoom,
+              editor->zoom / editor->render_cache_zoom);
+          gtk_snapshot_append_node (snapshot, editor->render_cache);
+          gtk_snapshot_restore (snapshot);
+        }
+    }
 
-      g_autoptr (GskRenderNode) units_node   = NULL;
-      g_autoptr (GskRenderNode) layouts_node = NULL;
+  gtk_snapshot_pop (snapshot);
 
-      g_autoptr (GskPathBuilder) keep_path_builder  = NULL;
-      g_autoptr (GskPath) keep_path                 = NULL;
-      g_autoptr (GskStroke) keep_stroke             = NULL;
-      g_autoptr (GskPathBuilder) units_path_builder = NULL;
-      g_autoptr (GskPath) units_path                = NULL;
-      g_autoptr (GskStroke) units_stroke            = NULL;
+  gcv_stats_record_time ("editor.snapshot", begin_time);
+}
 
-      regen           = gtk_snapshot_new ();
-      units           = gtk_snapshot_new ();
-      layouts         = gtk_snapshot_new ();
-      texture_to_mask = g_hash_table_new (g_direct_hash, g_direct_equal);
+static void
+snapshot_cursor_layer (GcvMapEditor *editor,
+                       GtkSnapshot  *snapshot)
+{
+  const GskColorStop cursor_radial_gradient_color_stops[2] = {
+    { 0.0, { 0.3, 0.2, 0.4, 0.5 } },
+    { 1.0, { 0.1, 0.1, 0.1, 0.0 } },
+  };
 
-      total_strokes       = g_list_model_get_n_items (G_LIST_MODEL (model));
-      total_drawn_strokes = editor->draw_after_cursor
-                                ? total_strokes
-                                : MIN (total_strokes, cursor + cursor_len);
+  double tile_size  = 0.0;
+  gint64 begin_time = 0;
 
-      gtk_widget_get_color (GTK_WIDGET (editor), &widget_rgba);
-      bg_rgba = (GdkRGBA) {
-        .red   = 1.0 - widget_rgba.red,
-        .green = 1.0 - widget_rgba.green,
-        .blue  = 1.0 - widget_rgba.blue,
-        .alpha = 0.75,
-      };
+  if (editor->map == NULL)
+    return;
 
-      gtk_snapshot_push_mask (units, GSK_MASK_MODE_ALPHA);
+  begin_time = g_get_monotonic_time ();
+  tile_size  = BASE_TILE_SIZE * editor->zoom;
 
-      for (guint i = 0; i < total_drawn_strokes; i++)
-        {
-          g_autoptr (GcvItemStroke) stroke    = NULL;
-          g_autoptr (GcvItem) item            = NULL;
-          g_autoptr (GArray) instances        = NULL;
-          int         item_tile_width         = 0;
-          int         item_tile_height        = 0;
-          GcvItemKind item_kind               = 0;
-          gpointer    tile_hash               = NULL;
-          GdkTexture *tile_texture            = NULL;
-          gboolean    wants_layout            = FALSE;
-          g_autoptr (PangoLayout) tile_layout = NULL;
-          PangoRectangle tile_layout_rect     = { 0 };
-
-          stroke = g_list_model_get_item (G_LIST_MODEL (model), i);
-          g_object_get (
-              stroke,
-              "item", &item,
-              "instances", &instances,
-              NULL);
-          g_object_get (
-              item,
-              "kind", &item_kind,
-              "tile-width", &item_tile_width,
-              "tile-height", &item_tile_height,
-              NULL);
+  if (editor->hadjustment != NULL && editor->vadjustment != NULL)
+    gtk_snapshot_translate (
+        snapshot,
+        &GRAPHENE_POINT_INIT (
+            -gtk_adjustment_get_value (editor->hadjustment),
+            -gtk_adjustment_get_value (editor->vadjustment)));
+  gtk_snapshot_translate (
+      snapshot,
+      &GRAPHENE_POINT_INIT (
+          (double) editor->border_gap * tile_size,
+          (double) editor->border_gap * tile_size));
 
-          wants_layout = i < cursor + cursor_len &&
-                         editor->zoom >= 0.5 &&
-                         (editor->zoom >= 3.5 ||
-                          item_tile_width > 1 ||
-                          item_tile_height > 1 ||
-                          item_kind == GCV_ITEM_KIND_UNIT);
+  if (editor->diagnostics != NULL)
+    {
+      /* Only rebuilt when the diagnostics or the zoom change */
+      if (editor->diagnostics_node == NULL ||
+          editor->diagnostics_zoom != editor->zoom)
+        {
+          g_clear_pointer (&editor->diagnostics_node, gsk_render_node_unref);
+          editor->diagnostics_node = build_diagnostics_node (editor, tile_size);
+          editor->diagnostics_zoom = editor->zoom;
+        }
 
-          if (item_kind != GCV_ITEM_KIND_UNIT)
+      if (editor->diagnostics_node != NULL)
+        {
+          graphene_rect_t visible = { 0 };
+
+          visible = GRAPHENE_RECT_INIT (
+              -(double) editor->border_gap * tile_size,
+              -(double) editor->border_gap * tile_size,
+              gtk_widget_get_width (GTK_WIDGET (editor)),
+              gtk_widget_get_height (GTK_WIDGET (editor)));
+          if (editor->hadjustment != NULL && editor->vadjustment != NULL)
             {
-              tile_hash = gcv_item_get_tile_resource_hash (item);
-              if (tile_hash != NULL)
-                {
-                  tile_texture = g_hash_table_lookup (editor->tile_textures, tile_hash);
-                  if (tile_texture == NULL)
-                    {
-                      g_autofree char *tile_resource = NULL;
-
-                      g_object_get (
-                          item,
-                          "tile-resource", &tile_resource,
-                          NULL);
-
-                      tile_texture = gdk_texture_new_from_resource (tile_resource);
-                      g_hash_table_replace (editor->tile_textures, tile_hash, tile_texture);
-                    }
-                }
+              visible.origin.x += gtk_adjustment_get_value (editor->hadjustment);
+              visible.origin.y += gtk_adjustment_get_value (editor->vadjustment);
             }
 
-          for (guint j = 0; j < instances->len; j++)
-            {
-              GcvItemStrokeInstance instance = { 0 };
-              graphene_rect_t       rect     = { 0 };
+          gtk_snapshot_push_clip (snapshot, &visible);
+          gtk_snapshot_append_node (snapshot, editor->diagnostics_node);
+          gtk_snapshot_pop (snapshot);
+        }
+    }
 
-              instance = g_array_index (instances, GcvItemStrokeInstance, j);
+  if (editor->symmetry != GCV_MAP_EDITOR_SYMMETRY_NONE)
+    {
+      int    map_tile_width  = 0;
+      int    map_tile_height = 0;
+      double axis_x          = 0.0;
+      double axis_y          = 0.0;
+      double line_width      = 0.0;
 
-              rect = GRAPHENE_RECT_INIT (
-                  instance.x * tile_size - 1.0,
-                  instance.y * tile_size - 1.0,
-                  item_tile_width * tile_size + 2.0,
-                  item_tile_height * tile_size + 2.0);
+      g_object_get (
+          editor->map,
+          "width", &map_tile_width,
+          "height", &map_tile_height,
+          NULL);
 
-              if (graphene_rect_intersection (&extents, &rect, NULL))
-                {
-                  if (item_kind == GCV_ITEM_KIND_UNIT)
-                    gtk_snapshot_append_color (
-                        units,
-                        &(GdkRGBA) { 1.0, 1.0, 1.0, 1.0 },
-                        &rect);
-                  else
-                    {
-                      graphene_rect_t draw_rect = rect;
-
-                      if (i >= cursor && i < cursor + cursor_len)
-                        {
-                          gtk_snapshot_append_color (
-                              regen,
-                              &(GdkRGBA) { 0.0, 0.0, 0.0, 1.0 },
-                              &draw_rect);
-
-                          draw_rect.origin.x += tile_size * 0.2;
-                          draw_rect.origin.y += tile_size * 0.2;
-                          draw_rect.size.width -= tile_size * 0.4;
-                          draw_rect.size.height -= tile_size * 0.4;
-                        }
-
-                      if (tile_texture != NULL)
-                        {
-                          GtkSnapshot *mask = NULL;
-
-                          mask = g_hash_table_lookup (texture_to_mask, tile_texture);
-                          if (mask == NULL)
-                            {
-                              mask = gtk_snapshot_new ();
-                              g_hash_table_replace (texture_to_mask, tile_texture, mask);
-
-                              gtk_snapshot_push_mask (mask, GSK_MASK_MODE_ALPHA);
-                            }
-
-                          gtk_snapshot_append_color (
-                              mask,
-                              i < cursor
-                                  ? &(GdkRGBA) { 1.0, 1.0, 1.0, 1.0 }
-                                  : (i < cursor + cursor_len
-                                         ? &(GdkRGBA) { 1.0, 1.0, 1.0, 0.9 }
-                                         : &(GdkRGBA) { 1.0, 1.0, 1.0, 0.3 }),
-                              &draw_rect);
-                        }
-                      else
-                        gtk_snapshot_append_color (
-                            regen,
-                            i < cursor
-                                ? &(GdkRGBA) { 0.1, 0.5, 1.0, 1.0 }
-                                : (i < cursor + cursor_len
-                                       ? &(GdkRGBA) { 0.1, 0.1, 1.0, 0.9 }
-                                       : &(GdkRGBA) { 0.1, 0.1, 1.0, 0.3 }),
-                            &draw_rect);
-                    }
-
-                  if (wants_layout && tile_layout == NULL)
-                    {
-                      const char *item_name = NULL;
-                      char        buf[256]  = { 0 };
-                      const char *ptr       = NULL;
-
-                      item_name = gcv_item_get_name (item);
-
-                      if (editor->zoom >= 4.5)
-                        {
-                          g_snprintf (buf, sizeof (buf), "%s (stroke %d)", item_name, i);
-                          ptr = buf;
-                        }
-                      else if (item_name != NULL &&
-                               editor->zoom <= 0.5 &&
-                               (item_tile_width <= 5 || item_tile_height <= 5))
-                        {
-                          g_snprintf (buf, sizeof (buf), "%c", item_name[0]);
-                          ptr = buf;
-                        }
-                      else
-                        ptr = item_name;
-
-                      tile_layout = gtk_widget_create_pango_layout (GTK_WIDGET (editor), ptr);
-                      pango_layout_set_single_paragraph_mode (tile_layout, TRUE);
-                      pango_layout_set_alignment (tile_layout, PANGO_ALIGN_CENTER);
-                      pango_layout_set_width (tile_layout, pango_units_from_double ((double) item_tile_width * tile_size));
-
-                      pango_layout_get_extents (tile_layout, NULL, &tile_layout_rect);
-                    }
-
-                  if (tile_layout != NULL)
-                    {
-                      gtk_snapshot_save (layouts);
-                      gtk_snapshot_translate (
-                          layouts,
-                          &GRAPHENE_POINT_INIT (
-                              rect.origin.x,
-                              rect.origin.y + rect.size.height / 2.0 -
-                                  (float) PANGO_PIXELS ((float) tile_layout_rect.height / 2.0)));
-
-                      gtk_snapshot_append_color (
-                          layouts, &bg_rgba,
-                          &GRAPHENE_RECT_INIT (
-                              (rect.size.width - (float) PANGO_PIXELS (tile_layout_rect.width)) / 2.0,
-                              0.0,
-                              (float) PANGO_PIXELS (tile_layout_rect.width),
-                              (float) PANGO_PIXELS (tile_layout_rect.height)));
-                      gtk_snapshot_append_layout (layouts, tile_layout, &widget_rgba);
-
-                      gtk_snapshot_restore (layouts);
-                    }
-                }
-            }
-        }
-
-      g_hash_table_iter_init (&iter, texture_to_mask);
-      for (;;)
-        {
-          GdkTexture  *texture                = NULL;
-          GtkSnapshot *mask                   = NULL;
-          g_autoptr (GskRenderNode) mask_node = NULL;
-
-          if (!g_hash_table_iter_next (
-                  &iter, (gpointer *) &texture, (gpointer *) &mask))
-            break;
-
-          gtk_snapshot_pop (mask);
-
-          gtk_snapshot_push_repeat (
-              mask, &extents,
-              &GRAPHENE_RECT_INIT (0, 0, tile_size, tile_size / 2));
-          gtk_snapshot_append_scaled_texture (
-              mask, texture, GSK_SCALING_FILTER_NEAREST,
-              &GRAPHENE_RECT_INIT (0, 0, tile_size, tile_size / 2));
-          gtk_snapshot_pop (mask);
-
-          gtk_snapshot_pop (mask);
-
-          mask_node = gtk_snapshot_free_to_node (mask);
-          if (mask_node != NULL)
-            gtk_snapshot_append_node (regen, mask_node);
-        }
-
-      keep_path_builder = gsk_path_builder_new ();
-      /* Stone Keep outline */
-      gsk_path_builder_move_to (keep_path_builder, map_width / 2.0 - 7.0 * tile_size, map_height / 2.0 - 7.0 * tile_size);
-      gsk_path_builder_rel_line_to (keep_path_builder, 7.0 * tile_size, 0.0);
-      gsk_path_builder_rel_line_to (keep_path_builder, 0.0, 2.0 * tile_size);
-      gsk_path_builder_rel_line_to (keep_path_builder, 5.0 * tile_size, 0.0);
-      gsk_path_builder_rel_line_to (keep_path_builder, 0.0, 5.0 * tile_size);
-      gsk_path_builder_rel_line_to (keep_path_builder, -7.0 * tile_size, 0.0);
-      gsk_path_builder_rel_line_to (keep_path_builder, 0.0, 1.0 * tile_size);
-      gsk_path_builder_rel_line_to (keep_path_builder, 2.0 * tile_size, 0.0);
-      gsk_path_builder_rel_line_to (keep_path_builder, 0.0, 7.0 * tile_size);
-      gsk_path_builder_rel_line_to (keep_path_builder, -7.0 * tile_size, 0.0);
-      gsk_path_builder_rel_line_to (keep_path_builder, 0.0, -7.0 * tile_size);
-      gsk_path_builder_rel_line_to (keep_path_builder, 2.0 * tile_size, 0.0);
-      gsk_path_builder_rel_line_to (keep_path_builder, 0.0, -1.0 * tile_size);
-      gsk_path_builder_rel_line_to (keep_path_builder, -2.0 * tile_size, 0.0);
-      gsk_path_builder_close (keep_path_builder);
-      gsk_path_builder_add_circle (
-          keep_path_builder,
-          &GRAPHENE_POINT_INIT (map_width / 2.0 - 3.5 * tile_size, map_height / 2.0 + 4.5 * tile_size),
-          1.5 * tile_size);
-      keep_path = gsk_path_builder_free_to_path (g_steal_pointer (&keep_path_builder));
-
-      keep_stroke = gsk_stroke_new (tile_size * 0.25);
-      gsk_stroke_set_dash (keep_stroke, (const float[]) { tile_size * 0.25, tile_size * 0.5 }, 2);
-      gsk_stroke_set_line_cap (keep_stroke, GSK_LINE_CAP_SQUARE);
-
-      gtk_snapshot_append_stroke (
-          regen, keep_path, keep_stroke,
-          editor->dark_theme
-              ? &(const GdkRGBA) { 1.0, 1.0, 1.0, 1.0 }
-              : &(const GdkRGBA) { 0.0, 0.0, 0.0, 1.0 });
-
-      units_path_builder = gsk_path_builder_new ();
-      gsk_path_builder_add_circle (
-          units_path_builder,
-          &GRAPHENE_POINT_INIT (tile_size / 2.0, tile_size / 2.0),
-          tile_size / 3.0);
-      units_path = gsk_path_builder_free_to_path (g_steal_pointer (&units_path_builder));
-
-      units_stroke = gsk_stroke_new (tile_size * 0.15);
-      gsk_stroke_set_dash (units_stroke, (const float[]) { tile_size * 0.25, tile_size * 0.1 }, 2);
-      gsk_stroke_set_line_cap (units_stroke, GSK_LINE_CAP_BUTT);
-
-      gtk_snapshot_pop (units);
-      gtk_snapshot_push_repeat (
-          units, &extents,
-          &GRAPHENE_RECT_INIT (0, 0, tile_size, tile_size));
-      gtk_snapshot_append_stroke (
-          units, units_path, units_stroke,
-          editor->dark_theme
-              ? &(const GdkRGBA) { 1.0, 0.25, 0.75, 1.0 }
-              : &(const GdkRGBA) { 0.75, 0.25, 1.0, 1.0 });
-      gtk_snapshot_pop (units);
-      gtk_snapshot_pop (units);
-      units_node = gtk_snapshot_to_node (units);
-      if (units_node != NULL)
-        gtk_snapshot_append_node (regen, units_node);
-
-      layouts_node = gtk_snapshot_to_node (layouts);
-      if (layouts_node != NULL)
-        gtk_snapshot_append_node (regen, layouts_node);
-
-      if (editor->show_accessibility)
-        {
-          if (editor->accessibility_mask == NULL)
-            editor->accessibility_mask = gcv_map_handle_get_accessibilty_mask (editor->handle);
-
-          for (guint y = 0; y < map_tile_height; y++)
-            {
-              for (guint x = 0; x < map_tile_width; x++)
-                {
-                  guint idx = 0;
-
-                  idx = y * map_tile_width + x;
-                  gtk_snapshot_append_color (
-                      regen,
-                      editor->accessibility_mask[idx] == 1
-                          ? &(GdkRGBA) { 0.0, 1.0, 0.2, 0.5 }
-                          : &(GdkRGBA) { 1.0, 0.2, 0.0, 0.5 },
-                      &GRAPHENE_RECT_INIT (
-                          x * tile_size, y * tile_size,
-                          tile_size, tile_size));
-                }
-            }
-        }
-
-      editor->render_cache = gtk_snapshot_to_node (regen);
-    }
-
-  if (editor->render_cache != NULL)
-    gtk_snapshot_append_node (snapshot, editor->render_cache);
+      axis_x     = (editor->symmetry_x2 >= 0 ? editor->symmetry_x2 : map_tile_width) * tile_size / 2.0;
+      axis_y     = (editor->symmetry_y2 >= 0 ? editor->symmetry_y2 : map_tile_height) * tile_size / 2.0;
+      line_width = MAX (1.0, tile_size / 8.0);
+
+      if (editor->symmetry != GCV_MAP_EDITOR_SYMMETRY_VERTICAL)
+        gtk_snapshot_append_color (
+            snapshot,
+            &(GdkRGBA) { 0.9, 0.3, 0.3, 0.6 },
+            &GRAPHENE_RECT_INIT (
+                axis_x - line_width / 2.0, 0.0,
+                line_width, map_tile_height * tile_size));
+      if (editor->symmetry != GCV_MAP_EDITOR_SYMMETRY_HORIZONTAL)
+        gtk_snapshot_append_color (
+            snapshot,
+            &(GdkRGBA) { 0.9, 0.3, 0.3, 0.6 },
+            &GRAPHENE_RECT_INIT (
+                0.0, axis_y - line_width / 2.0,
+                map_tile_width * tile_size, line_width));
+    }
 
   if (!gtk_gesture_is_recognized (editor->drag_gesture) &&
       !gtk_gesture_is_recognized (editor->zoom_gesture) &&
@@ -1454,7 +1921,7 @@ gcv_map_editor_snapshot (GtkWidget   *widget,
             editor->current_stroke,
             "item", &current_item,
             NULL);
-      else
+      else if (editor->item_area != NULL)
         g_object_get (
             editor->item_area,
             "selected-item", &current_item,
@@ -1494,9 +1961,56 @@ gcv_map_editor_snapshot (GtkWidget   *widget,
             }
         }
 
-      if (current_item != NULL &&
-          editor->real_hover_x != G_MAXINT &&
-          editor->real_hover_y != G_MAXINT)
+      if (editor->pending_stroke != NULL)
+        {
+          g_autoptr (GcvItem) pending_item = NULL;
+          g_autoptr (GArray) instances     = NULL;
+          const GcvItemInfo *info          = NULL;
+
+          g_object_get (
+              editor->pending_stroke,
+              "item", &pending_item,
+              "instances", &instances,
+              NULL);
+          info = gcv_item_get_info (pending_item);
+
+          for (guint i = 0; i < instances->len; i++)
+            {
+              GcvItemStrokeInstance instance = { 0 };
+
+              instance = g_array_index (instances, GcvItemStrokeInstance, i);
+              gtk_snapshot_append_color (
+                  snapshot,
+                  &(GdkRGBA) { 0.2, 0.37, 0.9, 0.5 },
+                  &GRAPHENE_RECT_INIT (
+                      instance.x * tile_size,
+                      instance.y * tile_size,
+                      info->tile_width * tile_size,
+                      info->tile_height * tile_size));
+            }
+        }
+
+      if (editor->tool == GCV_MAP_EDITOR_TOOL_STAMP)
+        {
+          if (editor->stamp_node != NULL &&
+              editor->real_hover_x != G_MAXINT &&
+              editor->real_hover_y != G_MAXINT)
+            {
+              /* Same anchoring as place_stamp () */
+              gtk_snapshot_save (snapshot);
+              gtk_snapshot_translate (
+                  snapshot,
+                  &GRAPHENE_POINT_INIT (
+                      (editor->real_hover_x - editor->stamp_x - editor->stamp_width / 2) * tile_size,
+                      (editor->real_hover_y - editor->stamp_y - editor->stamp_height / 2) * tile_size));
+              gtk_snapshot_scale (snapshot, tile_size, tile_size);
+              gtk_snapshot_append_node (snapshot, editor->stamp_node);
+              gtk_snapshot_restore (snapshot);
+            }
+        }
+      else if (current_item != NULL &&
+               editor->real_hover_x != G_MAXINT &&
+               editor->real_hover_y != G_MAXINT)
         {
           if (item_tile_width == 1 &&
               item_tile_height == 1 &&
@@ -1562,7 +2076,16 @@ gcv_map_editor_snapshot (GtkWidget   *widget,
         }
     }
 
-  gtk_snapshot_pop (snapshot);
+  gcv_stats_record_time ("editor.cursor-layer", begin_time);
+}
+
+static void
+queue_draw_layers (GcvMapEditor *self)
+{
+  if (self->map_layer != NULL)
+    gtk_widget_queue_draw (self->map_layer);
+  if (self->cursor_layer != NULL)
+    gtk_widget_queue_draw (self->cursor_layer);
 }
 
 static gboolean
@@ -1723,10 +2246,10 @@ dark_theme_changed (GtkSettings  *settings,
       "gtk-application-prefer-dark-theme", &editor->dark_theme,
       NULL);
 
-  g_clear_pointer (&editor->render_cache, gsk_render_node_unref);
+  invalidate_render_cache (editor, "theme");
   read_brush (editor, FALSE);
 
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
+  queue_draw_layers (editor);
 }
 
 static void
@@ -1735,7 +2258,7 @@ show_grid_changed (GSettings    *self,
                    GcvMapEditor *editor)
 {
   editor->show_grid = g_settings_get_boolean (self, key);
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
+  queue_draw_layers (editor);
 }
 
 static void
@@ -1744,7 +2267,7 @@ show_gradient_changed (GSettings    *self,
                        GcvMapEditor *editor)
 {
   editor->show_gradient = g_settings_get_boolean (self, key);
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
+  queue_draw_layers (editor);
 }
 
 static void
@@ -1753,7 +2276,7 @@ show_cursor_glow_changed (GSettings    *self,
                           GcvMapEditor *editor)
 {
   editor->show_cursor_glow = g_settings_get_boolean (self, key);
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
+  gtk_widget_queue_draw (editor->cursor_layer);
 }
 
 static void
@@ -1768,7 +2291,7 @@ static void
 adjustment_value_changed (GtkAdjustment *adjustment,
                           GcvMapEditor  *editor)
 {
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
+  queue_draw_layers (editor);
 }
 
 static void
@@ -1792,7 +2315,7 @@ drag_gesture_begin (GtkGestureDrag *self,
   editor->drag_start_vadjustment_val = gtk_adjustment_get_value (editor->vadjustment);
 
   gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "move");
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
+  queue_draw_layers (editor);
 }
 
 static void
@@ -1820,7 +2343,7 @@ drag_gesture_end (GtkGestureDrag *gesture,
                   GcvMapEditor   *editor)
 {
   update_motion (editor, editor->pointer_x, editor->pointer_y);
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
+  queue_draw_layers (editor);
 }
 
 static void
@@ -1850,6 +2373,22 @@ draw_gesture_begin (GtkGestureDrag *self,
 {
   g_autoptr (GcvItem) selected_item = NULL;
 
+  if (editor->symmetry != GCV_MAP_EDITOR_SYMMETRY_NONE &&
+      (gtk_event_controller_get_current_event_state (GTK_EVENT_CONTROLLER (self)) & GDK_ALT_MASK))
+    {
+      set_symmetry_axis (editor, start_x, start_y);
+      gtk_gesture_set_state (GTK_GESTURE (self), GTK_EVENT_SEQUENCE_DENIED);
+      return;
+    }
+
+  if (editor->tool == GCV_MAP_EDITOR_TOOL_STAMP)
+    {
+      /* Every click is its own stamp */
+      place_stamp (editor, start_x, start_y);
+      gtk_gesture_set_state (GTK_GESTURE (self), GTK_EVENT_SEQUENCE_DENIED);
+      return;
+    }
+
   g_object_get (
       editor->item_area,
       "selected-item", &selected_item,
@@ -1860,6 +2399,14 @@ draw_gesture_begin (GtkGestureDrag *self,
       return;
     }
 
+  if (editor->tool == GCV_MAP_EDITOR_TOOL_FILL)
+    {
+      /* A fill happens all at once, there is nothing to drag */
+      fill_at (editor, selected_item, start_x, start_y);
+      gtk_gesture_set_state (GTK_GESTURE (self), GTK_EVENT_SEQUENCE_DENIED);
+      return;
+    }
+
   gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "crosshair");
 
   g_clear_object (&editor->current_stroke);
@@ -1868,8 +2415,11 @@ draw_gesture_begin (GtkGestureDrag *self,
       "item", selected_item,
       NULL);
   g_array_set_size (editor->stroke_tracker, 0);
+  g_array_set_size (editor->stroke_tracker_counts, 0);
+  g_array_set_size (editor->draw_samples, 0);
 
-  draw_gesture_update (self, 0.0, 0.0, editor);
+  queue_draw_sample (editor, start_x, start_y);
+  flush_draw_samples (editor);
 
   g_object_set (
       editor->handle,
@@ -1885,815 +2435,3203 @@ draw_gesture_update (GtkGestureDrag *gesture,
                      double          offset_y,
                      GcvMapEditor   *editor)
 {
-  g_autoptr (GHashTable) grid            = NULL;
-  int map_tile_width                     = 0;
-  int map_tile_height                    = 0;
-  g_autoptr (GcvItem) item               = NULL;
-  g_autoptr (GArray) instances           = NULL;
-  GcvItemKind           item_kind        = 0;
-  int                   item_tile_width  = 0;
-  int                   item_tile_height = 0;
-  GcvItemStrokeInstance last_instance    = { 0 };
-  int                   dx               = 0;
-  int                   dy               = 0;
-  int                   divisor          = 0;
+  GdkEvent *event   = NULL;
+  double    start_x = 0.0;
+  double    start_y = 0.0;
 
   g_assert (editor->current_stroke != NULL);
 
-  g_object_get (
-      editor->handle,
-      "grid", &grid,
-      NULL);
-  g_object_get (
-      editor->map,
-      "width", &map_tile_width,
-      "height", &map_tile_height,
-      NULL);
-  g_object_get (
-      editor->current_stroke,
-      "item", &item,
-      "instances", &instances,
-      NULL);
-  g_object_get (
-      item,
-      "kind", &item_kind,
-      "tile-width", &item_tile_width,
-      "tile-height", &item_tile_height,
-      NULL);
-
-  if (editor->stroke_tracker->len == 0)
-    last_instance = (GcvItemStrokeInstance) {
-      .x = editor->real_hover_x,
-      .y = editor->real_hover_y
-    };
-  else if (editor->line_mode)
-    last_instance = g_array_index (
-        editor->stroke_tracker,
-        GcvItemStrokeInstance, 0);
-  else
-    last_instance = g_array_index (
-        editor->stroke_tracker,
-        GcvItemStrokeInstance,
-        editor->stroke_tracker->len - 1);
-
-  if (editor->line_mode)
+  /* Fast mice deliver several positions per event, keep all of them */
+  event = gtk_event_controller_get_current_event (GTK_EVENT_CONTROLLER (gesture));
+  if (event != NULL && gdk_event_get_event_type (event) == GDK_MOTION_NOTIFY)
     {
-      g_array_set_size (instances, 0);
-      g_array_set_size (editor->stroke_tracker, 0);
-    }
-
-  dx = editor->real_hover_x - last_instance.x;
-  dy = editor->real_hover_y - last_instance.y;
-  dx += CLAMP (dx, -1, 1);
-  dy += CLAMP (dy, -1, 1);
-  divisor = MAX (MAX (ABS (dx), ABS (dy)), 1);
+      g_autofree GdkTimeCoord *history   = NULL;
+      guint                    n_history = 0;
 
-  for (int i = 0; i < divisor; i++)
-    {
-      GcvItemStrokeInstance instance = { 0 };
+      history = gdk_event_get_history (event, &n_history);
+      if (history != NULL)
+        {
+          GtkNative *native    = NULL;
+          double     surface_x = 0.0;
+          double     surface_y = 0.0;
 
-      instance.x = last_instance.x + i * dx / divisor;
-      instance.y = last_instance.y + i * dy / divisor;
+          native = gtk_widget_get_native (GTK_WIDGET (editor));
+          gtk_native_get_surface_transform (native, &surface_x, &surface_y);
 
-      g_array_append_val (editor->stroke_tracker, instance);
+          for (guint i = 0; i < n_history; i++)
+            {
+              graphene_point_t point = { 0 };
+
+              if (!(history[i].flags & GDK_AXIS_FLAG_X) ||
+                  !(history[i].flags & GDK_AXIS_FLAG_Y))
+                continue;
+
+              if (gtk_widget_compute_point (
+                      GTK_WIDGET (native),
+                      GTK_WIDGET (editor),
+                      &GRAPHENE_POINT_INIT (
+                          history[i].axes[GDK_AXIS_X] - surface_x,
+                          history[i].axes[GDK_AXIS_Y] - surface_y),
+                      &point))
+                queue_draw_sample (editor, point.x, point.y);
+            }
+        }
+    }
 
-      if (item_tile_height == 1 &&
-          item_tile_width == 1 &&
-          editor->brush_mask != NULL)
-        {
-          int bx = 0;
-          int by = 0;
+  gtk_gesture_drag_get_start_point (gesture, &start_x, &start_y);
+  queue_draw_sample (editor, start_x + offset_x, start_y + offset_y);
 
-          bx = instance.x - editor->brush_width / 2;
-          by = instance.y - editor->brush_height / 2;
+  if (editor->draw_tick == 0)
+    editor->draw_tick = gtk_widget_add_tick_callback (
+        GTK_WIDGET (editor), (GtkTickCallback) draw_tick_cb, editor, NULL);
+}
 
-          for (int y = 0; y < editor->brush_height; y++)
-            {
-              for (int x = 0; x < editor->brush_width; x++)
-                {
-                  guint    tile_idx = 0;
-                  GcvItem *existing = NULL;
-                  gboolean add      = TRUE;
+/* Index of the lowest set bit, @bits must not be 0 */
+static inline int
+lowest_bit (guint64 bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll (bits);
+#else
+  if ((guint32) bits != 0)
+    return g_bit_nth_lsf ((guint32) bits, -1);
+  return 32 + g_bit_nth_lsf ((guint32) (bits >> 32), -1);
+#endif
+}
 
-                  if (bx + x < 0 ||
-                      by + y < 0 ||
-                      bx + x >= map_tile_width ||
-                      by + y >= map_tile_height ||
-                      editor->brush_mask[y * editor->brush_width + x] == 0)
-                    continue;
+/* Bit i is set if tile (x + i, y) can't take an item of
+ * `kind`. Units may go on top of buildings, nothing else
+ * may overlap, and tiles off the map are always blocked.
+ */
+static inline guint64
+blocked_bits (const guint64 *occupied,
+              const guint64 *buildings,
+              guint          stride,
+              int            map_width,
+              GcvItemKind    kind,
+              int            x,
+              int            y)
+{
+  const guint64 *occupied_row  = NULL;
+  const guint64 *buildings_row = NULL;
+  guint64        bits          = 0;
+  guint64        outside       = 0;
 
-                  tile_idx = (by + y) * map_tile_width + (bx + x);
-                  existing = g_hash_table_lookup (grid, GUINT_TO_POINTER (tile_idx));
+  occupied_row  = occupied + (gsize) y * stride;
+  buildings_row = buildings + (gsize) y * stride;
 
-                  if (existing != NULL)
-                    {
-                      GcvItemKind existing_kind = 0;
+  if (x >= 0)
+    {
+      guint word  = x / 64;
+      guint shift = x % 64;
 
-                      g_object_get (
-                          existing,
-                          "kind", &existing_kind,
-                          NULL);
+      if (word < stride)
+        bits = occupied_row[word] >> shift;
+      if (shift > 0 && word + 1 < stride)
+        bits |= occupied_row[word + 1] << (64 - shift);
 
-                      add = item_kind == GCV_ITEM_KIND_UNIT &&
-                            existing_kind == GCV_ITEM_KIND_BUILDING;
-                    }
+      if (kind == GCV_ITEM_KIND_UNIT)
+        {
+          guint64 building_bits = 0;
 
-                  if (add)
-                    gcv_item_stroke_add_instance (
-                        editor->current_stroke,
-                        (GcvItemStrokeInstance) {
-                            .x = bx + x,
-                            .y = by + y,
-                        });
-                }
-            }
+          if (word < stride)
+            building_bits = buildings_row[word] >> shift;
+          if (shift > 0 && word + 1 < stride)
+            building_bits |= buildings_row[word + 1] << (64 - shift);
+          bits &= ~building_bits;
         }
-      else
-        {
-          gboolean add = TRUE;
+    }
+  else if (x > -64)
+    {
+      bits = occupied_row[0] << -x;
+      if (kind == GCV_ITEM_KIND_UNIT)
+        bits &= ~(buildings_row[0] << -x);
+    }
 
-          if (instance.x < 0 ||
-              instance.y < 0 ||
-              instance.x + item_tile_width > map_tile_width ||
-              instance.y + item_tile_height > map_tile_height)
-            continue;
+  if (x < 0)
+    outside |= x <= -64 ? G_MAXUINT64 : (G_GUINT64_CONSTANT (1) << -x) - 1;
+  if (map_width - x < 64)
+    outside |= map_width - x <= 0 ? G_MAXUINT64 : ~((G_GUINT64_CONSTANT (1) << (map_width - x)) - 1);
 
-          for (int y = 0; y < item_tile_height; y++)
-            {
-              for (int x = 0; x < item_tile_width; x++)
-                {
-                  guint    tile_idx = 0;
-                  GcvItem *existing = NULL;
+  return bits | outside;
+}
 
-                  tile_idx = (instance.y + y) * map_tile_width + (instance.x + x);
-                  existing = g_hash_table_lookup (grid, GUINT_TO_POINTER (tile_idx));
+static void
+queue_draw_sample (GcvMapEditor *self,
+                   double        x,
+                   double        y)
+{
+  double                map_offset = 0.0;
+  GcvItemStrokeInstance sample     = { 0 };
 
-                  if (existing != NULL)
-                    {
-                      GcvItemKind existing_kind = 0;
+  map_offset = (double) self->border_gap * BASE_TILE_SIZE * self->zoom;
+  sample.x   = floor ((x + gtk_adjustment_get_value (self->hadjustment) - map_offset) / (BASE_TILE_SIZE * self->zoom));
+  sample.y   = floor ((y + gtk_adjustment_get_value (self->vadjustment) - map_offset) / (BASE_TILE_SIZE * self->zoom));
 
-                      g_object_get (
-                          existing,
-                          "kind", &existing_kind,
-                          NULL);
+  if (self->draw_samples->len > 0)
+    {
+      GcvItemStrokeInstance last = { 0 };
 
-                      add = item_kind == GCV_ITEM_KIND_UNIT &&
-                            existing_kind == GCV_ITEM_KIND_BUILDING;
-                      if (!add)
-                        break;
-                    }
-                }
+      last = g_array_index (self->draw_samples, GcvItemStrokeInstance, self->draw_samples->len - 1);
+      if (last.x == sample.x && last.y == sample.y)
+        return;
+    }
 
-              if (!add)
-                break;
-            }
+  g_array_append_val (self->draw_samples, sample);
+}
 
-          if (add)
-            gcv_item_stroke_add_instance (editor->current_stroke, instance);
+/* Writes the images of an instance under the current
+ * symmetry into `images` and returns how many there are
+ */
+static guint
+mirror_instance (GcvMapEditor          *self,
+                 GcvItemStrokeInstance  instance,
+                 int                    item_tile_width,
+                 int                    item_tile_height,
+                 int                    map_tile_width,
+                 int                    map_tile_height,
+                 GcvItemStrokeInstance *images)
+{
+  int   cx2      = 0;
+  int   cy2      = 0;
+  int   mirror_x = 0;
+  int   mirror_y = 0;
+  guint n_images = 0;
+
+  cx2      = self->symmetry_x2 >= 0 ? self->symmetry_x2 : map_tile_width;
+  cy2      = self->symmetry_y2 >= 0 ? self->symmetry_y2 : map_tile_height;
+  mirror_x = cx2 - instance.x - item_tile_width;
+  mirror_y = cy2 - instance.y - item_tile_height;
+
+  switch (self->symmetry)
+    {
+    case GCV_MAP_EDITOR_SYMMETRY_HORIZONTAL:
+      images[n_images++] = (GcvItemStrokeInstance) { mirror_x, instance.y };
+      break;
+    case GCV_MAP_EDITOR_SYMMETRY_VERTICAL:
+      images[n_images++] = (GcvItemStrokeInstance) { instance.x, mirror_y };
+      break;
+    case GCV_MAP_EDITOR_SYMMETRY_FOUR_WAY:
+      images[n_images++] = (GcvItemStrokeInstance) { mirror_x, instance.y };
+      images[n_images++] = (GcvItemStrokeInstance) { instance.x, mirror_y };
+      images[n_images++] = (GcvItemStrokeInstance) { mirror_x, mirror_y };
+      break;
+    case GCV_MAP_EDITOR_SYMMETRY_ROTATIONAL:
+      images[n_images++] = (GcvItemStrokeInstance) { mirror_x, mirror_y };
+      /* Quarter turns only land on whole tiles for square
+       * footprints around an axis that allows it
+       */
+      if (item_tile_width == item_tile_height && (cx2 + cy2) % 2 == 0)
+        {
+          int sum  = (cx2 + cy2) / 2;
+          int diff = (cx2 - cy2) / 2;
+
+          images[n_images++] = (GcvItemStrokeInstance) {
+            sum - instance.y - item_tile_height,
+            instance.x - diff,
+          };
+          images[n_images++] = (GcvItemStrokeInstance) {
+            instance.y + diff,
+            sum - instance.x - item_tile_width,
+          };
         }
+      break;
+    case GCV_MAP_EDITOR_SYMMETRY_NONE:
+    default:
+      break;
     }
+
+  return n_images;
 }
 
 static void
-draw_gesture_end (GtkGestureDrag *gesture,
-                  double          offset_x,
-                  double          offset_y,
-                  GcvMapEditor   *editor)
+place_mirror_batch (GcvMapEditor  *self,
+                    GcvItemKind    item_kind,
+                    int            item_tile_width,
+                    int            item_tile_height,
+                    const guint64 *occupied,
+                    const guint64 *buildings,
+                    guint          stride,
+                    int            map_tile_width,
+                    int            map_tile_height)
 {
-  g_autoptr (GcvItem) item     = NULL;
-  g_autoptr (GArray) instances = NULL;
-
-  if (editor->current_stroke == NULL)
-    return;
+  guint64 footprint = 0;
+  guint   n_placed  = 0;
 
-  g_object_get (
-      editor->current_stroke,
-      "item", &item,
-      "instances", &instances,
-      NULL);
+  footprint = item_tile_width >= 64
+                  ? G_MAXUINT64
+                  : (G_GUINT64_CONSTANT (1) << item_tile_width) - 1;
 
-  if (instances->len > 0)
+  for (guint i = 0; i < self->mirror_batch->len; i++)
     {
-      guint cursor                   = 0;
-      g_autoptr (GListStore) strokes = NULL;
+      GcvItemStrokeInstance images[3] = { 0 };
+      guint                 n_images  = 0;
 
-      g_object_get (
-          editor->handle,
-          "cursor", &cursor,
-          "model", &strokes,
-          NULL);
-      g_list_store_insert (
-          strokes, cursor, editor->current_stroke);
-      g_object_set (
-          editor->handle,
-          "cursor", cursor + 1,
-          NULL);
+      n_images = mirror_instance (
+          self,
+          g_array_index (self->mirror_batch, GcvItemStrokeInstance, i),
+          item_tile_width, item_tile_height,
+          map_tile_width, map_tile_height,
+          images);
 
-      if (editor->settings != NULL)
+      for (guint j = 0; j < n_images; j++)
         {
-          g_autofree char *name                 = NULL;
-          g_autoptr (GVariant) frequencies      = NULL;
-          g_autoptr (GVariantDict) variant_dict = NULL;
-          guint count                           = 0;
-          g_autoptr (GVariant) reinitialized    = NULL;
-
-          g_object_get (
-              item,
-              "name", &name,
-              NULL);
+          gboolean add = TRUE;
 
-          /* Update the recency list */
-          frequencies  = g_settings_get_value (editor->settings, "item-frequencies");
-          variant_dict = g_variant_dict_new (frequencies);
+          if (images[j].x < 0 ||
+              images[j].y < 0 ||
+              images[j].x + item_tile_width > map_tile_width ||
+              images[j].y + item_tile_height > map_tile_height)
+            continue;
 
-          if (g_variant_dict_contains (variant_dict, name))
-            g_variant_dict_lookup (variant_dict, name, "u", &count);
-          g_variant_dict_insert (variant_dict, name, "u", count + 1);
+          for (int y = 0; y < item_tile_height && add; y++)
+            add = (blocked_bits (occupied, buildings, stride, map_tile_width,
+                                 item_kind, images[j].x, images[j].y + y) &
+                   footprint) == 0;
 
-          reinitialized = g_variant_ref_sink (g_variant_dict_end (variant_dict));
-          g_settings_set_value (editor->settings, "item-frequencies", reinitialized);
+          /* Images landing on the original are refused here */
+          if (add && gcv_item_stroke_add_instance (self->current_stroke, images[j]))
+            n_placed++;
         }
     }
 
-  g_clear_object (&editor->current_stroke);
-  g_array_set_size (editor->stroke_tracker, 0);
-
-  g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_DRAWING]);
+  gcv_stats_add_count ("editor.mirror-instances", n_placed);
+  g_array_set_size (self->mirror_batch, 0);
 }
 
-static void
-draw_gesture_end_gesture (GtkGesture       *self,
-                          GdkEventSequence *sequence,
-                          GcvMapEditor     *editor)
+static gboolean
+draw_tick_cb (GtkWidget     *widget,
+              GdkFrameClock *frame_clock,
+              GcvMapEditor  *editor)
 {
-  g_object_set (
-      editor->handle,
-      "lock-hinted", FALSE,
-      NULL);
-
-  if (editor->current_stroke == NULL)
-    g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_DRAWING]);
+  editor->draw_tick = 0;
+  flush_draw_samples (editor);
 
-  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "crosshair");
+  return G_SOURCE_REMOVE;
 }
 
 static void
-cancel_gesture_begin_gesture (GtkGesture       *self,
-                              GdkEventSequence *sequence,
-                              GcvMapEditor     *editor)
+flush_draw_samples (GcvMapEditor *editor)
 {
-  g_clear_object (&editor->current_stroke);
+  const guint64 *occupied                = NULL;
+  const guint64 *buildings               = NULL;
+  guint          stride                  = 0;
+  int            map_tile_width          = 0;
+  int            map_tile_height         = 0;
+  g_autoptr (GcvItem) item               = NULL;
+  g_autoptr (GArray) instances           = NULL;
+  GcvItemKind           item_kind        = 0;
+  int                   item_tile_width  = 0;
+  int                   item_tile_height = 0;
+  guint                 first            = 0;
+  gint64                begin_time       = 0;
 
-  gtk_gesture_set_state (GTK_GESTURE (self), GTK_EVENT_SEQUENCE_CLAIMED);
-  gtk_gesture_set_state (editor->draw_gesture, GTK_EVENT_SEQUENCE_DENIED);
+  if (editor->draw_tick != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (editor), editor->draw_tick);
+      editor->draw_tick = 0;
+    }
 
-  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "not-allowed");
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
-}
+  if (editor->current_stroke == NULL ||
+      editor->draw_samples->len == 0)
+    {
+      g_array_set_size (editor->draw_samples, 0);
+      return;
+    }
 
-static void
-cancel_gesture_end_gesture (GtkGesture       *self,
-                            GdkEventSequence *sequence,
-                            GcvMapEditor     *editor)
-{
-  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "crosshair");
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
-}
+  begin_time = g_get_monotonic_time ();
 
-static void
-zoom_gesture_begin (GtkGesture       *self,
-                    GdkEventSequence *sequence,
-                    GcvMapEditor     *editor)
-{
-  gtk_gesture_set_state (editor->draw_gesture, GTK_EVENT_SEQUENCE_DENIED);
+  occupied  = gcv_map_handle_get_occupied_plane (editor->handle, &stride);
+  buildings = gcv_map_handle_get_kind_plane (editor->handle, GCV_ITEM_KIND_BUILDING, NULL);
+  g_object_get (
+      editor->map,
+      "width", &map_tile_width,
+      "height", &map_tile_height,
+      NULL);
+  g_object_get (
+      editor->current_stroke,
+      "item", &item,
+      "instances", &instances,
+      NULL);
+  item_kind        = gcv_item_get_info (item)->kind;
+  item_tile_width  = gcv_item_get_info (item)->tile_width;
+  item_tile_height = gcv_item_get_info (item)->tile_height;
+
+  /* A line only depends on where the pointer ended up */
+  if (editor->tool == GCV_MAP_EDITOR_TOOL_LINE)
+    first = editor->draw_samples->len - 1;
+  else if (IS_SHAPE_TOOL (editor->tool))
+    {
+      GcvItemStrokeInstance sample = { 0 };
+
+      /* Shapes are regenerated whole from the anchor
+       * to the latest sample, nothing else matters
+       */
+      sample = g_array_index (editor->draw_samples, GcvItemStrokeInstance,
+                              editor->draw_samples->len - 1);
+      if (editor->stroke_tracker->len == 0)
+        g_array_append_val (editor->stroke_tracker, sample);
+
+      gcv_item_stroke_truncate (editor->current_stroke, 0);
+      place_shape (
+          editor,
+          g_array_index (editor->stroke_tracker, GcvItemStrokeInstance, 0),
+          sample,
+          item_kind, item_tile_width, item_tile_height,
+          occupied, buildings, stride,
+          map_tile_width, map_tile_height);
+
+      first = editor->draw_samples->len;
+    }
 
-  editor->zoom_gesture_start_val = editor->zoom;
+  for (guint s = first; s < editor->draw_samples->len; s++)
+    {
+      GcvItemStrokeInstance sample        = { 0 };
+      GcvItemStrokeInstance last_instance = { 0 };
+      int                   dx            = 0;
+      int                   dy            = 0;
+      int                   divisor       = 0;
+      int                   keep          = 0;
+
+      sample = g_array_index (editor->draw_samples, GcvItemStrokeInstance, s);
+
+      if (editor->stroke_tracker->len == 0)
+        last_instance = (GcvItemStrokeInstance) {
+          .x = sample.x,
+          .y = sample.y
+        };
+      else if (editor->tool == GCV_MAP_EDITOR_TOOL_LINE)
+        last_instance = g_array_index (
+            editor->stroke_tracker,
+            GcvItemStrokeInstance, 0);
+      else
+        last_instance = g_array_index (
+            editor->stroke_tracker,
+            GcvItemStrokeInstance,
+            editor->stroke_tracker->len - 1);
+
+      dx = sample.x - last_instance.x;
+      dy = sample.y - last_instance.y;
+      dx += CLAMP (dx, -1, 1);
+      dy += CLAMP (dy, -1, 1);
+      divisor = MAX (MAX (ABS (dx), ABS (dy)), 1);
+
+      if (editor->tool == GCV_MAP_EDITOR_TOOL_LINE)
+        {
+          /* Points are placed in order and can block later ones,
+           * so everything up to the first point that moved is
+           * still valid. Only redo the rest of the line.
+           */
+          while (keep < divisor && keep < (int) editor->stroke_tracker->len)
+            {
+              GcvItemStrokeInstance old = { 0 };
 
-  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), NULL);
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
-}
+              old = g_array_index (editor->stroke_tracker, GcvItemStrokeInstance, keep);
+              if (old.x != last_instance.x + keep * dx / divisor ||
+                  old.y != last_instance.y + keep * dy / divisor)
+                break;
+              keep++;
+            }
 
-static void
-zoom_gesture_scale_changed (GtkGestureZoom *self,
-                            double          scale,
-                            GcvMapEditor   *editor)
-{
-  double scale_delta = 0.0;
+          if (keep < (int) editor->stroke_tracker_counts->len)
+            gcv_item_stroke_truncate (
+                editor->current_stroke,
+                g_array_index (editor->stroke_tracker_counts, guint, keep));
+          g_array_set_size (editor->stroke_tracker, keep);
+          g_array_set_size (editor->stroke_tracker_counts, keep);
+          gcv_stats_add_count ("editor.line-kept", keep);
+        }
 
-  scale_delta  = gtk_gesture_zoom_get_scale_delta (self);
-  editor->zoom = CLAMP (editor->zoom_gesture_start_val + scale_delta * editor->zoom, 0.25, 7.5);
+      for (int i = keep; i < divisor; i++)
+        {
+          GcvItemStrokeInstance instance = { 0 };
 
-  g_clear_pointer (&editor->render_cache, gsk_render_node_unref);
-  update_motion (editor, editor->pointer_x, editor->pointer_y);
-}
+          instance.x = last_instance.x + i * dx / divisor;
+          instance.y = last_instance.y + i * dy / divisor;
 
-static void
-zoom_gesture_end (GtkGesture       *self,
-                  GdkEventSequence *sequence,
-                  GcvMapEditor     *editor)
-{
-  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "crosshair");
-}
+          g_array_append_val (editor->stroke_tracker, instance);
+          g_array_append_val (editor->stroke_tracker_counts, instances->len);
 
-static gboolean
-scroll_event (GtkEventControllerScroll *self,
-              double                    dx,
-              double                    dy,
-              GcvMapEditor             *editor)
-{
-  if (gtk_gesture_is_recognized (editor->drag_gesture) ||
-      gtk_gesture_is_recognized (editor->draw_gesture) ||
-      gtk_gesture_is_recognized (editor->zoom_gesture))
-    return GDK_EVENT_STOP;
+          if (item_tile_height == 1 &&
+              item_tile_width == 1 &&
+              editor->brush_mask != NULL)
+            {
+              int bx = 0;
+              int by = 0;
 
-  gtk_widget_grab_focus (GTK_WIDGET (editor));
+              bx = instance.x - editor->brush_width / 2;
+              by = instance.y - editor->brush_height / 2;
 
-  editor->zoom += dy * -0.06 * editor->zoom;
-  editor->zoom = CLAMP (editor->zoom, 0.25, 7.5);
+              for (int y = MAX (0, -by); y < editor->brush_height && by + y < map_tile_height; y++)
+                {
+                  for (int x = 0; x < editor->brush_width; x += 64)
+                    {
+                      guint64 bits = 0;
 
-  g_clear_pointer (&editor->render_cache, gsk_render_node_unref);
+                      bits = editor->brush_mask[y * editor->brush_stride + x / 64];
 
-  update_scrollable (editor, FALSE);
-  /* Sometimes two scroll events happend before motion
-   * is invoked for some reason, update now to be safe.
-   */
-  update_motion (editor, editor->pointer_x, editor->pointer_y);
+                      /* Images are tested in one batch once the
+                       * whole brush has been placed
+                       */
+                      if (editor->symmetry != GCV_MAP_EDITOR_SYMMETRY_NONE)
+                        {
+                          for (guint64 image_bits = bits; image_bits != 0; image_bits &= image_bits - 1)
+                            g_array_append_val (
+                                editor->mirror_batch,
+                                ((GcvItemStrokeInstance) {
+                                    .x = bx + x + lowest_bit (image_bits),
+                                    .y = by + y,
+                                }));
+                        }
 
-  return GDK_EVENT_STOP;
-}
+                      bits &= ~blocked_bits (occupied, buildings, stride, map_tile_width,
+                                             item_kind, bx + x, by + y);
 
-static void
-motion_enter (GtkEventControllerMotion *self,
-              gdouble                   x,
-              gdouble                   y,
-              GcvMapEditor             *editor)
-{
-  gtk_widget_grab_focus (GTK_WIDGET (editor));
-  update_motion (editor, x, y);
-}
+                      while (bits != 0)
+                        {
+                          int bit = 0;
 
-static void
-motion_event (GtkEventControllerMotion *self,
-              double                    x,
-              double                    y,
-              GcvMapEditor             *editor)
-{
-  update_motion (editor, x, y);
-}
+                          bit = lowest_bit (bits);
+                          bits &= bits - 1;
 
-static void
-motion_leave (GtkEventControllerMotion *self,
-              GcvMapEditor             *editor)
-{
-  editor->real_hover_x = G_MAXINT;
-  editor->real_hover_y = G_MAXINT;
+                          gcv_item_stroke_add_instance (
+                              editor->current_stroke,
+                              (GcvItemStrokeInstance) {
+                                  .x = bx + x + bit,
+                                  .y = by + y,
+                              });
+                        }
+                    }
+                }
+            }
+          else
+            {
+              guint64  footprint = 0;
+              gboolean add       = TRUE;
 
-  if (editor->hover_x >= 0)
-    {
-      editor->hover_x = -1;
-      g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_HOVER_X]);
-    }
-  if (editor->hover_y >= 0)
-    {
-      editor->hover_y = -1;
-      g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_HOVER_Y]);
-    }
+              if (editor->symmetry != GCV_MAP_EDITOR_SYMMETRY_NONE)
+                g_array_append_val (editor->mirror_batch, instance);
 
-  editor->pointer_x = (double) gtk_widget_get_width (GTK_WIDGET (editor)) / 2.0;
-  editor->pointer_y = (double) gtk_widget_get_height (GTK_WIDGET (editor)) / 2.0;
+              add = instance.x >= 0 &&
+                    instance.y >= 0 &&
+                    instance.x + item_tile_width <= map_tile_width &&
+                    instance.y + item_tile_height <= map_tile_height;
 
-  if (editor->hadjustment != NULL && editor->vadjustment != NULL)
-    {
-      editor->canvas_x = gtk_adjustment_get_value (editor->hadjustment) + editor->pointer_x;
-      editor->canvas_y = gtk_adjustment_get_value (editor->vadjustment) + editor->pointer_y;
-    }
-  else
-    {
-      editor->canvas_x = editor->pointer_x;
-      editor->canvas_y = editor->pointer_y;
+              footprint = item_tile_width >= 64
+                              ? G_MAXUINT64
+                              : (G_GUINT64_CONSTANT (1) << item_tile_width) - 1;
+
+              for (int y = 0; y < item_tile_height && add; y++)
+                add = (blocked_bits (occupied, buildings, stride, map_tile_width,
+                                     item_kind, instance.x, instance.y + y) &
+                       footprint) == 0;
+
+              if (add)
+                gcv_item_stroke_add_instance (editor->current_stroke, instance);
+            }
+
+          if (editor->mirror_batch->len > 0)
+            place_mirror_batch (
+                editor, item_kind, item_tile_width, item_tile_height,
+                occupied, buildings, stride,
+                map_tile_width, map_tile_height);
+        }
     }
 
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
-}
+  gcv_stats_add_count ("editor.draw-samples", editor->draw_samples->len);
+  g_array_set_size (editor->draw_samples, 0);
+  gtk_widget_queue_draw (editor->cursor_layer);
 
-static void
-selected_item_changed (GcvItemArea  *item_area,
-                       GParamSpec   *pspec,
-                       GcvMapEditor *editor)
-{
-  if (editor->hover_x >= 0 && editor->hover_y >= 0)
-    gtk_widget_queue_draw (GTK_WIDGET (editor));
+  gcv_stats_record_time ("editor.draw-flush", begin_time);
 }
 
+/* Generates the shape analytically on a grid of item sized
+ * cells anchored at `from`, then validates every cell against
+ * the occupancy planes in one pass before a single bulk add.
+ */
 static void
-selected_brush_changed (GcvBrushArea *brush_area,
-                        GParamSpec   *pspec,
-                        GcvMapEditor *editor)
+place_shape (GcvMapEditor         *self,
+             GcvItemStrokeInstance from,
+             GcvItemStrokeInstance to,
+             GcvItemKind           item_kind,
+             int                   item_tile_width,
+             int                   item_tile_height,
+             const guint64        *occupied,
+             const guint64        *buildings,
+             guint                 stride,
+             int                   map_tile_width,
+             int                   map_tile_height)
 {
-  read_brush (editor, TRUE);
-}
+  int     step_x           = 0;
+  int     step_y           = 0;
+  int     cols             = 0;
+  int     rows             = 0;
+  guint64 footprint        = 0;
+  g_autoptr (GArray) shape = NULL;
 
-static void
-selected_brush_adjustment_value_changed (GtkAdjustment *adjustment,
-                                         GcvMapEditor  *editor)
-{
-  read_brush (editor, FALSE);
+  step_x = to.x >= from.x ? item_tile_width : -item_tile_width;
+  step_y = to.y >= from.y ? item_tile_height : -item_tile_height;
+  cols   = ABS (to.x - from.x) / item_tile_width + 1;
+  rows   = ABS (to.y - from.y) / item_tile_height + 1;
+
+  footprint = item_tile_width >= 64
+                  ? G_MAXUINT64
+                  : (G_GUINT64_CONSTANT (1) << item_tile_width) - 1;
+
+  shape = g_array_new (FALSE, FALSE, sizeof (GcvItemStrokeInstance));
+
+  for (int j = 0; j < rows; j++)
+    {
+      int y     = 0;
+      int begin = 0;
+      int end   = 0;
+
+      y = from.y + j * step_y;
+      if (y < 0 || y + item_tile_height > map_tile_height)
+        continue;
+
+      begin = 0;
+      end   = cols;
+      if (self->tool == GCV_MAP_EDITOR_TOOL_ELLIPSE)
+        {
+          double rx   = 0.0;
+          double ry   = 0.0;
+          double dy   = 0.0;
+          double half = 0.0;
+
+          /* Inscribed in the cell rectangle, sampled at cell centers */
+          rx   = cols / 2.0;
+          ry   = rows / 2.0;
+          dy   = (j + 0.5 - ry) / ry;
+          half = rx * sqrt (MAX (0.0, 1.0 - dy * dy));
+
+          begin = MAX (0, (int) ceil (rx - half - 0.5));
+          end   = MIN (cols, (int) floor (rx + half - 0.5) + 1);
+        }
+
+      for (int i = begin; i < end; i++)
+        {
+          int      x   = 0;
+          gboolean add = TRUE;
+
+          if (self->tool == GCV_MAP_EDITOR_TOOL_RECTANGLE_OUTLINE &&
+              j > 0 && j < rows - 1 &&
+              i > 0 && i < cols - 1)
+            {
+              /* Skip straight to the right edge */
+              i = cols - 2;
+              continue;
+            }
+
+          x = from.x + i * step_x;
+          if (x < 0 || x + item_tile_width > map_tile_width)
+            continue;
+
+          for (int ty = 0; ty < item_tile_height && add; ty++)
+            add = (blocked_bits (occupied, buildings, stride, map_tile_width,
+                                 item_kind, x, y + ty) &
+                   footprint) == 0;
+
+          if (add)
+            g_array_append_val (shape, ((GcvItemStrokeInstance) { x, y }));
+        }
+    }
+
+  /* Cells never overlap, so there is nothing left to check */
+  gcv_item_stroke_add_instances (
+      self->current_stroke,
+      (const GcvItemStrokeInstance *) (gpointer) shape->data,
+      shape->len);
+  gcv_stats_add_count ("editor.shape-instances", shape->len);
 }
 
+/* Alt clicking moves the axis to the center of the clicked
+ * tile, doing it again on the same tile goes back to the keep
+ */
 static void
-grid_changed (GcvMapHandle *handle,
-              GParamSpec   *pspec,
-              GcvMapEditor *editor)
+set_symmetry_axis (GcvMapEditor *self,
+                   double        x,
+                   double        y)
 {
-  g_autoptr (GcvMap) map = NULL;
+  double map_offset      = 0.0;
+  int    map_tile_width  = 0;
+  int    map_tile_height = 0;
+  int    tile_x          = 0;
+  int    tile_y          = 0;
+
+  if (self->map == NULL || self->hadjustment == NULL || self->vadjustment == NULL)
+    return;
 
   g_object_get (
-      handle,
-      "map", &map,
+      self->map,
+      "width", &map_tile_width,
+      "height", &map_tile_height,
       NULL);
-  if (map != editor->map)
+
+  map_offset = (double) self->border_gap * BASE_TILE_SIZE * self->zoom;
+  tile_x     = floor ((x + gtk_adjustment_get_value (self->hadjustment) - map_offset) / (BASE_TILE_SIZE * self->zoom));
+  tile_y     = floor ((y + gtk_adjustment_get_value (self->vadjustment) - map_offset) / (BASE_TILE_SIZE * self->zoom));
+
+  /* Clicking off the map also goes back to the keep */
+  if (tile_x < 0 || tile_y < 0 ||
+      tile_x >= map_tile_width || tile_y >= map_tile_height ||
+      (self->symmetry_x2 == tile_x * 2 + 1 &&
+       self->symmetry_y2 == tile_y * 2 + 1))
     {
-      g_clear_object (&editor->map);
-      editor->map = g_steal_pointer (&map);
+      self->symmetry_x2 = -1;
+      self->symmetry_y2 = -1;
+    }
+  else
+    {
+      self->symmetry_x2 = tile_x * 2 + 1;
+      self->symmetry_y2 = tile_y * 2 + 1;
     }
 
-  g_clear_pointer (&editor->render_cache, gsk_render_node_unref);
-  g_clear_pointer (&editor->accessibility_mask, g_free);
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
-}
-
-static void
-cursor_changed (GcvMapHandle *handle,
-                GParamSpec   *pspec,
-                GcvMapEditor *editor)
-{
-  g_clear_pointer (&editor->render_cache, gsk_render_node_unref);
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
+  gtk_widget_queue_draw (self->cursor_layer);
 }
 
 static void
-update_scrollable (GcvMapEditor *self,
-                   gboolean      center)
+set_stamp (GcvMapEditor *self,
+           GListModel   *stamp)
 {
-  if (self->hadjustment == NULL || self->vadjustment == NULL)
+  guint n_strokes                  = 0;
+  int   min_x                      = G_MAXINT;
+  int   min_y                      = G_MAXINT;
+  int   max_x                      = G_MININT;
+  int   max_y                      = G_MININT;
+  g_autoptr (GtkSnapshot) snapshot = NULL;
+
+  if (stamp == self->stamp)
     return;
 
-  if (self->map != NULL)
+  g_clear_object (&self->stamp);
+  g_clear_pointer (&self->stamp_node, gsk_render_node_unref);
+  self->stamp_x      = 0;
+  self->stamp_y      = 0;
+  self->stamp_width  = 0;
+  self->stamp_height = 0;
+
+  if (stamp != NULL)
     {
-      double   old_h_lower     = 0.0;
-      double   old_v_lower     = 0.0;
-      double   old_h_upper     = 0.0;
-      double   old_v_upper     = 0.0;
-      int      widget_width    = 0;
-      int      widget_height   = 0;
-      int      map_tile_width  = 0;
-      int      map_tile_height = 0;
-      double   h_lower         = 0.0;
-      double   v_lower         = 0.0;
-      double   h_upper         = 0.0;
-      double   v_upper         = 0.0;
-      gboolean force_center_h  = FALSE;
-      gboolean force_center_v  = FALSE;
+      self->stamp = g_object_ref (stamp);
+      n_strokes   = g_list_model_get_n_items (stamp);
+    }
+
+  /* The preview is built once in tile units and scaled
+   * by the cursor layer
+   */
+  snapshot = gtk_snapshot_new ();
+  for (guint i = 0; i < n_strokes; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GcvItem) item         = NULL;
+      g_autoptr (GArray) instances     = NULL;
+      int item_tile_width              = 0;
+      int item_tile_height             = 0;
 
+      stroke = g_list_model_get_item (stamp, i);
       g_object_get (
-          self->hadjustment,
-          "lower", &old_h_lower,
-          "upper", &old_h_upper,
+          stroke,
+          "item", &item,
+          "instances", &instances,
           NULL);
       g_object_get (
-          self->vadjustment,
-          "lower", &old_v_lower,
-          "upper", &old_v_upper,
+          item,
+          "tile-width", &item_tile_width,
+          "tile-height", &item_tile_height,
           NULL);
 
-      widget_width  = gtk_widget_get_width (GTK_WIDGET (self));
-      widget_height = gtk_widget_get_height (GTK_WIDGET (self));
+      for (guint j = 0; j < instances->len; j++)
+        {
+          GcvItemStrokeInstance instance = { 0 };
+
+          instance = g_array_index (instances, GcvItemStrokeInstance, j);
+          min_x    = MIN (min_x, instance.x);
+          min_y    = MIN (min_y, instance.y);
+          max_x    = MAX (max_x, instance.x + item_tile_width);
+          max_y    = MAX (max_y, instance.y + item_tile_height);
+
+          gtk_snapshot_append_color (
+              snapshot,
+              &(GdkRGBA) { 0.2, 0.37, 0.9, 0.5 },
+              &GRAPHENE_RECT_INIT (
+                  instance.x,
+                  instance.y,
+                  item_tile_width,
+                  item_tile_height));
+        }
+    }
 
-      g_object_get (
-          self->map,
-          "width", &map_tile_width,
-          "height", &map_tile_height,
-          NULL);
+  if (max_x > min_x && max_y > min_y)
+    {
+      self->stamp_x      = min_x;
+      self->stamp_y      = min_y;
+      self->stamp_width  = max_x - min_x;
+      self->stamp_height = max_y - min_y;
+      self->stamp_node   = gtk_snapshot_free_to_node (g_steal_pointer (&snapshot));
+    }
 
-      h_upper = (double) (map_tile_width + self->border_gap * 2) * BASE_TILE_SIZE * self->zoom;
+  if (self->cursor_layer != NULL)
+    gtk_widget_queue_draw (self->cursor_layer);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_STAMP]);
+}
+
+static inline void
+mark_tiles (guint64 *plane,
+            guint    stride,
+            int      x,
+            int      y,
+            int      width)
+{
+  for (int tx = x; tx < x + width; tx++)
+    plane[(gsize) y * stride + tx / 64] |= G_GUINT64_CONSTANT (1) << (tx % 64);
+}
+
+/* Everything lands in one splice, which the handle
+ * records as a single undo step and a single grid update
+ */
+static void
+place_stamp (GcvMapEditor *self,
+             double        x,
+             double        y)
+{
+  guint                    n_strokes       = 0;
+  int                      map_tile_width  = 0;
+  int                      map_tile_height = 0;
+  const guint64           *occupied_plane  = NULL;
+  const guint64           *buildings_plane = NULL;
+  guint                    stride          = 0;
+  g_autofree guint64      *occupied        = NULL;
+  g_autofree guint64      *buildings       = NULL;
+  double                   map_offset      = 0.0;
+  int                      origin_x        = 0;
+  int                      origin_y        = 0;
+  g_autoptr (GPtrArray) placed             = NULL;
+  g_autoptr (GArray) accepted              = NULL;
+  guint cursor                             = 0;
+  g_autoptr (GListStore) strokes           = NULL;
+  gint64 begin_time                        = 0;
+
+  if (self->handle == NULL || self->map == NULL || self->stamp == NULL)
+    return;
+
+  n_strokes = g_list_model_get_n_items (self->stamp);
+  if (n_strokes == 0)
+    return;
+
+  begin_time = g_get_monotonic_time ();
+
+  g_object_get (
+      self->map,
+      "width", &map_tile_width,
+      "height", &map_tile_height,
+      NULL);
+
+  map_offset = (double) self->border_gap * BASE_TILE_SIZE * self->zoom;
+  origin_x   = floor ((x + gtk_adjustment_get_value (self->hadjustment) - map_offset) / (BASE_TILE_SIZE * self->zoom));
+  origin_y   = floor ((y + gtk_adjustment_get_value (self->vadjustment) - map_offset) / (BASE_TILE_SIZE * self->zoom));
+  origin_x -= self->stamp_x + self->stamp_width / 2;
+  origin_y -= self->stamp_y + self->stamp_height / 2;
+
+  /* Private copies so the strokes of the stamp can
+   * block each other as they are placed
+   */
+  occupied_plane  = gcv_map_handle_get_occupied_plane (self->handle, &stride);
+  buildings_plane = gcv_map_handle_get_kind_plane (self->handle, GCV_ITEM_KIND_BUILDING, NULL);
+  occupied        = g_memdup2 (occupied_plane, (gsize) stride * map_tile_height * sizeof (guint64));
+  buildings       = g_memdup2 (buildings_plane, (gsize) stride * map_tile_height * sizeof (guint64));
+
+  placed   = g_ptr_array_new_with_free_func (g_object_unref);
+  accepted = g_array_new (FALSE, FALSE, sizeof (GcvItemStrokeInstance));
+
+  for (guint i = 0; i < n_strokes; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GcvItem) item         = NULL;
+      g_autoptr (GArray) instances     = NULL;
+      GcvItemKind item_kind            = 0;
+      int         item_tile_width      = 0;
+      int         item_tile_height     = 0;
+      guint64     footprint            = 0;
+      GcvItemStroke *copy              = NULL;
+
+      stroke = g_list_model_get_item (self->stamp, i);
+      g_object_get (
+          stroke,
+          "item", &item,
+          "instances", &instances,
+          NULL);
+      item_kind        = gcv_item_get_info (item)->kind;
+      item_tile_width  = gcv_item_get_info (item)->tile_width;
+      item_tile_height = gcv_item_get_info (item)->tile_height;
+
+      footprint = item_tile_width >= 64
+                      ? G_MAXUINT64
+                      : (G_GUINT64_CONSTANT (1) << item_tile_width) - 1;
+
+      g_array_set_size (accepted, 0);
+      for (guint j = 0; j < instances->len; j++)
+        {
+          GcvItemStrokeInstance instance = { 0 };
+          gboolean              add      = TRUE;
+
+          instance = g_array_index (instances, GcvItemStrokeInstance, j);
+          instance.x += origin_x;
+          instance.y += origin_y;
+
+          if (instance.x < 0 ||
+              instance.y < 0 ||
+              instance.x + item_tile_width > map_tile_width ||
+              instance.y + item_tile_height > map_tile_height)
+            continue;
+
+          for (int ty = 0; ty < item_tile_height && add; ty++)
+            add = (blocked_bits (occupied, buildings, stride, map_tile_width,
+                                 item_kind, instance.x, instance.y + ty) &
+                   footprint) == 0;
+          if (!add)
+            continue;
+
+          g_array_append_val (accepted, instance);
+
+          /* Units aren't part of the grid */
+          if (item_kind != GCV_ITEM_KIND_UNIT)
+            {
+              for (int ty = 0; ty < item_tile_height; ty++)
+                {
+                  mark_tiles (occupied, stride, instance.x, instance.y + ty, item_tile_width);
+                  if (item_kind == GCV_ITEM_KIND_BUILDING)
+                    mark_tiles (buildings, stride, instance.x, instance.y + ty, item_tile_width);
+                }
+            }
+        }
+
+      if (accepted->len == 0)
+        continue;
+
+      copy = g_object_new (
+          GCV_TYPE_ITEM_STROKE,
+          "item", item,
+          NULL);
+      gcv_item_stroke_add_instances (
+          copy,
+          (const GcvItemStrokeInstance *) (gpointer) accepted->data,
+          accepted->len);
+      g_ptr_array_add (placed, copy);
+    }
+
+  if (placed->len == 0)
+    return;
+
+  g_object_get (
+      self->handle,
+      "cursor", &cursor,
+      "model", &strokes,
+      NULL);
+
+  g_list_store_splice (strokes, cursor, 0, placed->pdata, placed->len);
+  g_object_set (
+      self->handle,
+      "cursor", cursor + placed->len,
+      NULL);
+
+  gcv_stats_add_count ("editor.stamp.strokes", placed->len);
+  gcv_stats_record_time ("editor.stamp", begin_time);
+}
+
+static void
+draw_gesture_end (GtkGestureDrag *gesture,
+                  double          offset_x,
+                  double          offset_y,
+                  GcvMapEditor   *editor)
+{
+  double start_x = 0.0;
+  double start_y = 0.0;
+
+  if (editor->current_stroke == NULL)
+    return;
+
+  /* Don't lose anything still waiting for the next frame */
+  gtk_gesture_drag_get_start_point (gesture, &start_x, &start_y);
+  queue_draw_sample (editor, start_x + offset_x, start_y + offset_y);
+  flush_draw_samples (editor);
+
+  commit_stroke (editor, editor->current_stroke);
+
+  g_clear_object (&editor->current_stroke);
+  g_array_set_size (editor->stroke_tracker, 0);
+  g_array_set_size (editor->stroke_tracker_counts, 0);
+
+  g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_DRAWING]);
+}
+
+static void
+commit_stroke (GcvMapEditor  *self,
+               GcvItemStroke *stroke)
+{
+  g_autoptr (GcvItem) item       = NULL;
+  g_autoptr (GArray) instances   = NULL;
+  guint cursor                   = 0;
+  g_autoptr (GListStore) strokes = NULL;
+  gint64 begin_time              = 0;
+
+  g_object_get (
+      stroke,
+      "item", &item,
+      "instances", &instances,
+      NULL);
+  if (instances->len == 0)
+    return;
+
+  g_object_get (
+      self->handle,
+      "cursor", &cursor,
+      "model", &strokes,
+      NULL);
+
+  begin_time = g_get_monotonic_time ();
+  g_list_store_insert (strokes, cursor, stroke);
+  g_object_set (
+      self->handle,
+      "cursor", cursor + 1,
+      NULL);
+  gcv_stats_record_time ("editor.stroke-insert", begin_time);
+
+  /* Any job started from now on includes the stroke */
+  g_set_object (&self->pending_stroke, stroke);
+  self->pending_generation = self->render_generation;
+
+  if (self->settings != NULL)
+    {
+      g_autofree char *name                 = NULL;
+      g_autoptr (GVariant) frequencies      = NULL;
+      g_autoptr (GVariantDict) variant_dict = NULL;
+      guint count                           = 0;
+      g_autoptr (GVariant) reinitialized    = NULL;
+
+      g_object_get (
+          item,
+          "name", &name,
+          NULL);
+
+      /* Update the recency list */
+      frequencies  = g_settings_get_value (self->settings, "item-frequencies");
+      variant_dict = g_variant_dict_new (frequencies);
+
+      if (g_variant_dict_contains (variant_dict, name))
+        g_variant_dict_lookup (variant_dict, name, "u", &count);
+      g_variant_dict_insert (variant_dict, name, "u", count + 1);
+
+      reinitialized = g_variant_ref_sink (g_variant_dict_end (variant_dict));
+      g_settings_set_value (self->settings, "item-frequencies", reinitialized);
+    }
+}
+
+static void
+set_tool (GcvMapEditor    *self,
+          GcvMapEditorTool tool)
+{
+  if (self->tool == tool)
+    return;
+
+  self->tool = tool;
+  if (self->cursor_layer != NULL)
+    gtk_widget_queue_draw (self->cursor_layer);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_TOOL]);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_LINE_MODE]);
+}
+
+/* Scanline flood fill over the tiles the item could be
+ * placed on, 4-connected to the tile under the pointer.
+ */
+static void
+fill_at (GcvMapEditor *self,
+         GcvItem      *item,
+         double        x,
+         double        y)
+{
+  int                 item_tile_width  = 0;
+  int                 item_tile_height = 0;
+  GcvItemKind         item_kind        = 0;
+  int                 map_tile_width   = 0;
+  int                 map_tile_height  = 0;
+  const guint64      *occupied         = NULL;
+  const guint64      *buildings        = NULL;
+  guint               stride           = 0;
+  double              map_offset       = 0.0;
+  int                 start_x          = 0;
+  int                 start_y          = 0;
+  g_autofree guint64 *open             = NULL;
+  g_autoptr (GArray) seeds             = NULL;
+  g_autoptr (GArray) filled            = NULL;
+  g_autoptr (GcvItemStroke) fill       = NULL;
+  gint64 begin_time                    = 0;
+
+  if (self->handle == NULL || self->map == NULL)
+    return;
+
+#define TILE_OPEN(tx, ty)  ((open[(gsize) (ty) * stride + (tx) / 64] >> ((tx) % 64)) & 1)
+#define CLOSE_TILE(tx, ty) (open[(gsize) (ty) * stride + (tx) / 64] &= ~(G_GUINT64_CONSTANT (1) << ((tx) % 64)))
+
+  g_object_get (
+      item,
+      "kind", &item_kind,
+      "tile-width", &item_tile_width,
+      "tile-height", &item_tile_height,
+      NULL);
+  /* Filling only makes sense for items that tile */
+  if (item_tile_width != 1 || item_tile_height != 1)
+    return;
+
+  g_object_get (
+      self->map,
+      "width", &map_tile_width,
+      "height", &map_tile_height,
+      NULL);
+
+  map_offset = (double) self->border_gap * BASE_TILE_SIZE * self->zoom;
+  start_x    = floor ((x + gtk_adjustment_get_value (self->hadjustment) - map_offset) / (BASE_TILE_SIZE * self->zoom));
+  start_y    = floor ((y + gtk_adjustment_get_value (self->vadjustment) - map_offset) / (BASE_TILE_SIZE * self->zoom));
+  if (start_x < 0 || start_y < 0 ||
+      start_x >= map_tile_width || start_y >= map_tile_height)
+    return;
+
+  begin_time = g_get_monotonic_time ();
+
+  occupied  = gcv_map_handle_get_occupied_plane (self->handle, &stride);
+  buildings = gcv_map_handle_get_kind_plane (self->handle, GCV_ITEM_KIND_BUILDING, NULL);
+
+  /* Open tiles are the ones the item may go on and that
+   * haven't been filled yet
+   */
+  open = g_new0 (guint64, (gsize) stride * map_tile_height);
+  for (int row = 0; row < map_tile_height; row++)
+    {
+      for (guint word = 0; word < stride; word++)
+        open[(gsize) row * stride + word] = ~blocked_bits (
+            occupied, buildings, stride, map_tile_width,
+            item_kind, word * 64, row);
+    }
+  if (!TILE_OPEN (start_x, start_y))
+    return;
+
+  seeds  = g_array_new (FALSE, FALSE, sizeof (GcvItemStrokeInstance));
+  filled = g_array_new (FALSE, FALSE, sizeof (GcvItemStrokeInstance));
+  g_array_append_val (seeds, ((GcvItemStrokeInstance) { start_x, start_y }));
+
+  while (seeds->len > 0)
+    {
+      GcvItemStrokeInstance seed  = { 0 };
+      int                   left  = 0;
+      int                   right = 0;
+
+      seed = g_array_index (seeds, GcvItemStrokeInstance, seeds->len - 1);
+      g_array_set_size (seeds, seeds->len - 1);
+      if (!TILE_OPEN (seed.x, seed.y))
+        continue;
+
+      left  = seed.x;
+      right = seed.x;
+      while (left > 0 && TILE_OPEN (left - 1, seed.y))
+        left--;
+      while (right < map_tile_width - 1 && TILE_OPEN (right + 1, seed.y))
+        right++;
+
+      for (int tx = left; tx <= right; tx++)
+        {
+          CLOSE_TILE (tx, seed.y);
+          g_array_append_val (filled, ((GcvItemStrokeInstance) { tx, seed.y }));
+        }
+
+      /* One seed per open run in the rows above and below */
+      for (int dy = -1; dy <= 1; dy += 2)
+        {
+          int      ny     = seed.y + dy;
+          gboolean in_run = FALSE;
+
+          if (ny < 0 || ny >= map_tile_height)
+            continue;
+
+          for (int tx = left; tx <= right; tx++)
+            {
+              if (TILE_OPEN (tx, ny))
+                {
+                  if (!in_run)
+                    g_array_append_val (seeds, ((GcvItemStrokeInstance) { tx, ny }));
+                  in_run = TRUE;
+                }
+              else
+                in_run = FALSE;
+            }
+        }
+    }
+
+#undef TILE_OPEN
+#undef CLOSE_TILE
+
+  fill = g_object_new (
+      GCV_TYPE_ITEM_STROKE,
+      "item", item,
+      NULL);
+  gcv_item_stroke_add_instances (
+      fill,
+      (const GcvItemStrokeInstance *) (gpointer) filled->data,
+      filled->len);
+  commit_stroke (self, fill);
+
+  gcv_stats_add_count ("editor.fill.tiles", filled->len);
+  gcv_stats_record_time ("editor.fill", begin_time);
+}
+
+static void
+draw_gesture_end_gesture (GtkGesture       *self,
+                          GdkEventSequence *sequence,
+                          GcvMapEditor     *editor)
+{
+  g_object_set (
+      editor->handle,
+      "lock-hinted", FALSE,
+      NULL);
+
+  if (editor->current_stroke == NULL)
+    g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_DRAWING]);
+
+  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "crosshair");
+}
+
+static void
+cancel_gesture_begin_gesture (GtkGesture       *self,
+                              GdkEventSequence *sequence,
+                              GcvMapEditor     *editor)
+{
+  g_clear_object (&editor->current_stroke);
+
+  gtk_gesture_set_state (GTK_GESTURE (self), GTK_EVENT_SEQUENCE_CLAIMED);
+  gtk_gesture_set_state (editor->draw_gesture, GTK_EVENT_SEQUENCE_DENIED);
+
+  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "not-allowed");
+  gtk_widget_queue_draw (editor->cursor_layer);
+}
+
+static void
+cancel_gesture_end_gesture (GtkGesture       *self,
+                            GdkEventSequence *sequence,
+                            GcvMapEditor     *editor)
+{
+  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "crosshair");
+  gtk_widget_queue_draw (editor->cursor_layer);
+}
+
+static void
+zoom_gesture_begin (GtkGesture       *self,
+                    GdkEventSequence *sequence,
+                    GcvMapEditor     *editor)
+{
+  gtk_gesture_set_state (editor->draw_gesture, GTK_EVENT_SEQUENCE_DENIED);
+
+  editor->zoom_gesture_start_val = editor->zoom;
+
+  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), NULL);
+  queue_draw_layers (editor);
+}
+
+static void
+zoom_gesture_scale_changed (GtkGestureZoom *self,
+                            double          scale,
+                            GcvMapEditor   *editor)
+{
+  double scale_delta = 0.0;
+
+  scale_delta  = gtk_gesture_zoom_get_scale_delta (self);
+  editor->zoom = CLAMP (editor->zoom_gesture_start_val + scale_delta * editor->zoom, MIN_ZOOM, MAX_ZOOM);
+
+  begin_interim_zoom (editor);
+  update_motion (editor, editor->pointer_x, editor->pointer_y);
+  g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_ZOOM]);
+}
+
+static void
+zoom_gesture_end (GtkGesture       *self,
+                  GdkEventSequence *sequence,
+                  GcvMapEditor     *editor)
+{
+  end_interim_zoom (editor);
+  gtk_widget_set_cursor_from_name (GTK_WIDGET (editor), "crosshair");
+}
+
+static gboolean
+scroll_event (GtkEventControllerScroll *self,
+              double                    dx,
+              double                    dy,
+              GcvMapEditor             *editor)
+{
+  if (gtk_gesture_is_recognized (editor->drag_gesture) ||
+      gtk_gesture_is_recognized (editor->draw_gesture) ||
+      gtk_gesture_is_recognized (editor->zoom_gesture))
+    return GDK_EVENT_STOP;
+
+  gtk_widget_grab_focus (GTK_WIDGET (editor));
+
+  editor->zoom += dy * -0.06 * editor->zoom;
+  editor->zoom = CLAMP (editor->zoom, MIN_ZOOM, MAX_ZOOM);
+
+  begin_interim_zoom (editor);
+
+  update_scrollable (editor, FALSE);
+  /* Sometimes two scroll events happend before motion
+   * is invoked for some reason, update now to be safe.
+   */
+  update_motion (editor, editor->pointer_x, editor->pointer_y);
+  g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_ZOOM]);
+
+  return GDK_EVENT_STOP;
+}
+
+static void
+motion_enter (GtkEventControllerMotion *self,
+              gdouble                   x,
+              gdouble                   y,
+              GcvMapEditor             *editor)
+{
+  gtk_widget_grab_focus (GTK_WIDGET (editor));
+  update_motion (editor, x, y);
+}
+
+static void
+motion_event (GtkEventControllerMotion *self,
+              double                    x,
+              double                    y,
+              GcvMapEditor             *editor)
+{
+  update_motion (editor, x, y);
+}
+
+static void
+motion_leave (GtkEventControllerMotion *self,
+              GcvMapEditor             *editor)
+{
+  editor->real_hover_x = G_MAXINT;
+  editor->real_hover_y = G_MAXINT;
+
+  if (editor->hover_x >= 0)
+    {
+      editor->hover_x = -1;
+      g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_HOVER_X]);
+    }
+  if (editor->hover_y >= 0)
+    {
+      editor->hover_y = -1;
+      g_object_notify_by_pspec (G_OBJECT (editor), props[PROP_HOVER_Y]);
+    }
+
+  editor->pointer_x = (double) gtk_widget_get_width (GTK_WIDGET (editor)) / 2.0;
+  editor->pointer_y = (double) gtk_widget_get_height (GTK_WIDGET (editor)) / 2.0;
+
+  if (editor->hadjustment != NULL && editor->vadjustment != NULL)
+    {
+      editor->canvas_x = gtk_adjustment_get_value (editor->hadjustment) + editor->pointer_x;
+      editor->canvas_y = gtk_adjustment_get_value (editor->vadjustment) + editor->pointer_y;
+    }
+  else
+    {
+      editor->canvas_x = editor->pointer_x;
+      editor->canvas_y = editor->pointer_y;
+    }
+
+  gtk_widget_queue_draw (editor->cursor_layer);
+}
+
+static void
+selected_item_changed (GcvItemArea  *item_area,
+                       GParamSpec   *pspec,
+                       GcvMapEditor *editor)
+{
+  if (editor->hover_x >= 0 && editor->hover_y >= 0)
+    gtk_widget_queue_draw (editor->cursor_layer);
+}
+
+static void
+selected_brush_changed (GcvBrushArea *brush_area,
+                        GParamSpec   *pspec,
+                        GcvMapEditor *editor)
+{
+  read_brush (editor, TRUE);
+}
+
+static void
+selected_brush_adjustment_value_changed (GtkAdjustment *adjustment,
+                                         GcvMapEditor  *editor)
+{
+  read_brush (editor, FALSE);
+}
+
+static void
+grid_changed (GcvMapHandle *handle,
+              GParamSpec   *pspec,
+              GcvMapEditor *editor)
+{
+  g_autoptr (GcvMap) map = NULL;
+
+  g_object_get (
+      handle,
+      "map", &map,
+      NULL);
+  if (map != editor->map)
+    {
+      g_clear_object (&editor->map);
+      editor->map = g_steal_pointer (&map);
+    }
+
+  invalidate_render_cache (editor, "grid");
+  g_clear_pointer (&editor->accessibility_mask, g_free);
+  /* A stretched old frame would hide the change */
+  end_interim_zoom (editor);
+  queue_draw_layers (editor);
+}
+
+static void
+cursor_changed (GcvMapHandle *handle,
+                GParamSpec   *pspec,
+                GcvMapEditor *editor)
+{
+  /* An undo or a jump no longer shows the pending stroke */
+  g_clear_object (&editor->pending_stroke);
+
+  invalidate_render_cache (editor, "cursor");
+  end_interim_zoom (editor);
+  queue_draw_layers (editor);
+}
+
+static void
+diagnostics_changed (GListModel   *model,
+                     guint         position,
+                     guint         removed,
+                     guint         added,
+                     GcvMapEditor *editor)
+{
+  g_clear_pointer (&editor->diagnostics_node, gsk_render_node_unref);
+  if (editor->cursor_layer != NULL)
+    gtk_widget_queue_draw (editor->cursor_layer);
+}
+
+static GskRenderNode *
+build_diagnostics_node (GcvMapEditor *self,
+                        double        tile_size)
+{
+  g_autoptr (GtkSnapshot) snapshot = NULL;
+  guint n_diagnostics              = 0;
+
+  snapshot = gtk_snapshot_new ();
+
+  n_diagnostics = g_list_model_get_n_items (self->diagnostics);
+  for (guint i = 0; i < n_diagnostics; i++)
+    {
+      g_autoptr (GObject) diagnostic = NULL;
+      int x                          = 0;
+      int y                          = 0;
+
+      diagnostic = g_list_model_get_item (self->diagnostics, i);
+      g_object_get (
+          diagnostic,
+          "x", &x,
+          "y", &y,
+          NULL);
+      if (x < 0 || y < 0)
+        continue;
+
+      gtk_snapshot_append_border (
+          snapshot,
+          &GSK_ROUNDED_RECT_INIT (x * tile_size, y * tile_size, tile_size, tile_size),
+          BORDER_WIDTH (MAX (1.0, tile_size / 8.0)),
+          BORDER_COLOR_LITERAL ({ 0.9, 0.2, 0.2, 0.9 }));
+    }
+
+  return gtk_snapshot_free_to_node (g_steal_pointer (&snapshot));
+}
+
+static void
+lod_strokes_changed (GListModel   *model,
+                     guint         position,
+                     guint         removed,
+                     guint         added,
+                     GcvMapEditor *editor)
+{
+  /* Insertions past what has been painted are picked up
+   * on the next update without starting over
+   */
+  if (removed > 0 || position < editor->lod_n_strokes)
+    editor->lod_stale = TRUE;
+}
+
+static void
+update_scrollable (GcvMapEditor *self,
+                   gboolean      center)
+{
+  if (self->hadjustment == NULL || self->vadjustment == NULL)
+    return;
+
+  if (self->map != NULL)
+    {
+      double   old_h_lower     = 0.0;
+      double   old_v_lower     = 0.0;
+      double   old_h_upper     = 0.0;
+      double   old_v_upper     = 0.0;
+      int      widget_width    = 0;
+      int      widget_height   = 0;
+      int      map_tile_width  = 0;
+      int      map_tile_height = 0;
+      double   h_lower         = 0.0;
+      double   v_lower         = 0.0;
+      double   h_upper         = 0.0;
+      double   v_upper         = 0.0;
+      gboolean force_center_h  = FALSE;
+      gboolean force_center_v  = FALSE;
+
+      g_object_get (
+          self->hadjustment,
+          "lower", &old_h_lower,
+          "upper", &old_h_upper,
+          NULL);
+      g_object_get (
+          self->vadjustment,
+          "lower", &old_v_lower,
+          "upper", &old_v_upper,
+          NULL);
+
+      widget_width  = gtk_widget_get_width (GTK_WIDGET (self));
+      widget_height = gtk_widget_get_height (GTK_WIDGET (self));
+
+      g_object_get (
+          self->map,
+          "width", &map_tile_width,
+          "height", &map_tile_height,
+          NULL);
+
+      h_upper = (double) (map_tile_width + self->border_gap * 2) * BASE_TILE_SIZE * self->zoom;
       v_upper = (double) (map_tile_height + self->border_gap * 2) * BASE_TILE_SIZE * self->zoom;
 
-      if (h_upper < (double) widget_width)
+      if (h_upper < (double) widget_width)
+        {
+          h_lower        = -((double) widget_width - h_upper) / 2.0;
+          h_upper        = h_lower + (double) widget_width;
+          force_center_h = TRUE;
+        }
+
+      if (v_upper < (double) widget_height)
+        {
+          v_lower        = -((double) widget_height - v_upper) / 2.0;
+          v_upper        = v_lower + (double) widget_height;
+          force_center_v = TRUE;
+        }
+
+      g_object_set (
+          self->hadjustment,
+          "page-size", (double) widget_width,
+          "lower", h_lower,
+          "upper", h_upper,
+          NULL);
+      g_object_set (
+          self->vadjustment,
+          "page-size", (double) widget_height,
+          "lower", v_lower,
+          "upper", v_upper,
+          NULL);
+
+      if (center || self->queue_center || force_center_h)
+        gtk_adjustment_set_value (
+            self->hadjustment,
+            force_center_h
+                ? h_lower
+                : (h_lower + h_upper - (double) widget_width) / 2.0);
+      else
+        {
+          double ratio_x    = 0.0;
+          double adjusted_x = 0.0;
+
+          ratio_x    = (h_upper - h_lower) / (old_h_upper - old_h_lower);
+          adjusted_x = self->canvas_x * ratio_x - self->pointer_x;
+          gtk_adjustment_set_value (self->hadjustment, adjusted_x);
+        }
+
+      if (center || self->queue_center || force_center_v)
+        gtk_adjustment_set_value (
+            self->vadjustment,
+            force_center_v
+                ? v_lower
+                : (v_lower + v_upper - (double) widget_height) / 2.0);
+      else
+        {
+          double ratio_y    = 0.0;
+          double adjusted_y = 0.0;
+
+          ratio_y    = (v_upper - v_lower) / (old_v_upper - old_v_lower);
+          adjusted_y = self->canvas_y * ratio_y - self->pointer_y;
+          gtk_adjustment_set_value (self->vadjustment, adjusted_y);
+        }
+
+      self->queue_center = FALSE;
+    }
+  else
+    {
+      g_object_set (
+          self->hadjustment,
+          "lower", 0.0,
+          "upper", 0.0,
+          NULL);
+      g_object_set (
+          self->vadjustment,
+          "lower", 0.0,
+          "upper", 0.0,
+          NULL);
+    }
+}
+
+static void
+update_motion (GcvMapEditor *self,
+               double        x,
+               double        y)
+{
+  double hscroll         = 0.0;
+  double vscroll         = 0.0;
+  double map_offset      = 0.0;
+  int    new_hover_x     = 0;
+  int    new_hover_y     = 0;
+  int    map_tile_width  = 0;
+  int    map_tile_height = 0;
+  // gboolean was_invalid     = FALSE;
+  gboolean is_invalid = FALSE;
+  gboolean x_changed  = FALSE;
+  gboolean y_changed  = FALSE;
+  gboolean redraw     = FALSE;
+
+  self->pointer_x = x;
+  self->pointer_y = y;
+
+  if (gtk_gesture_is_recognized (self->drag_gesture))
+    return;
+
+  hscroll        = gtk_adjustment_get_value (self->hadjustment);
+  vscroll        = gtk_adjustment_get_value (self->vadjustment);
+  self->canvas_x = x + hscroll;
+  self->canvas_y = y + vscroll;
+  map_offset     = (double) self->border_gap * BASE_TILE_SIZE * self->zoom;
+  new_hover_x    = floor ((self->canvas_x - map_offset) / (BASE_TILE_SIZE * self->zoom));
+  new_hover_y    = floor ((self->canvas_y - map_offset) / (BASE_TILE_SIZE * self->zoom));
+
+  g_object_get (
+      self->map,
+      "width", &map_tile_width,
+      "height", &map_tile_height,
+      NULL);
+
+  // was_invalid = self->hover_x < 0 || self->hover_y < 0;
+  is_invalid = new_hover_x < 0 || new_hover_y < 0 ||
+               new_hover_x >= map_tile_width || new_hover_y >= map_tile_height;
+
+  x_changed = new_hover_x != self->real_hover_x;
+  y_changed = new_hover_y != self->real_hover_y;
+  redraw    = x_changed || y_changed;
+
+  self->real_hover_x = new_hover_x;
+  self->real_hover_y = new_hover_y;
+
+  if (is_invalid)
+    new_hover_x = new_hover_y = -1;
+  self->hover_x = new_hover_x;
+  self->hover_y = new_hover_y;
+
+  if (x_changed)
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_HOVER_X]);
+  if (y_changed)
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_HOVER_Y]);
+  if (redraw)
+    gtk_widget_queue_draw (self->cursor_layer);
+}
+
+static void
+read_brush (GcvMapEditor *self,
+            gboolean      different)
+{
+  g_autoptr (GcvBrushable) brush     = NULL;
+  int                mask_width      = 0;
+  int                mask_height     = 0;
+  g_autofree guint8 *mask            = NULL;
+  g_autoptr (GtkSnapshot) snapshot   = NULL;
+  g_autoptr (GskPathBuilder) builder = NULL;
+  g_autoptr (GskPath) path           = NULL;
+  g_autoptr (GskStroke) stroke       = NULL;
+
+  g_clear_pointer (&self->brush_mask, g_free);
+  g_clear_pointer (&self->brush_node, gsk_render_node_unref);
+
+  if (different)
+    {
+      if (self->brush_adjustment != NULL)
+        g_signal_handlers_disconnect_by_func (
+            self->brush_adjustment, selected_brush_adjustment_value_changed, self);
+      g_clear_object (&self->brush_adjustment);
+    }
+
+  if (self->hover_x >= 0 && self->hover_y >= 0)
+    gtk_widget_queue_draw (self->cursor_layer);
+
+  if (self->brush_area == NULL)
+    return;
+
+  g_object_get (
+      self->brush_area,
+      "selected-brush", &brush,
+      NULL);
+  if (brush == NULL)
+    return;
+
+  mask = gcv_brushable_get_mask (brush, &mask_width, &mask_height);
+  g_assert (mask != NULL);
+
+  snapshot = gtk_snapshot_new ();
+  builder  = gsk_path_builder_new ();
+  for (int y = 0; y < mask_height; y++)
+    {
+      for (int x = 0; x < mask_width; x++)
+        {
+          if (mask[y * mask_width + x] != 0)
+            {
+              if (x == 0 || mask[y * mask_width + (x - 1)] == 0)
+                {
+                  gsk_path_builder_move_to (builder, (float) x, (float) y);
+                  gsk_path_builder_rel_line_to (builder, 0.0, 1.0);
+                }
+              if (y == 0 || mask[(y - 1) * mask_width + x] == 0)
+                {
+                  gsk_path_builder_move_to (builder, (float) x, (float) y);
+                  gsk_path_builder_rel_line_to (builder, 1.0, 0.0);
+                }
+              if (x == mask_width - 1)
+                {
+                  gsk_path_builder_move_to (builder, (float) x + 1.0, (float) y + 1.0);
+                  gsk_path_builder_rel_line_to (builder, 0.0, -1.0);
+                }
+              if (y == mask_height - 1)
+                {
+                  gsk_path_builder_move_to (builder, (float) x + 1.0, (float) y + 1.0);
+                  gsk_path_builder_rel_line_to (builder, -1.0, 0.0);
+                }
+            }
+          else
+            {
+              if (x > 0 && mask[y * mask_width + (x - 1)] != 0)
+                {
+                  gsk_path_builder_move_to (builder, (float) x, (float) y);
+                  gsk_path_builder_rel_line_to (builder, 0.0, 1.0);
+                }
+              if (y > 0 && mask[(y - 1) * mask_width + x] != 0)
+                {
+                  gsk_path_builder_move_to (builder, (float) x, (float) y);
+                  gsk_path_builder_rel_line_to (builder, 1.0, 0.0);
+                }
+            }
+        }
+    }
+  path = gsk_path_builder_free_to_path (g_steal_pointer (&builder));
+
+  stroke = gsk_stroke_new (0.15);
+  gsk_stroke_set_line_cap (stroke, GSK_LINE_CAP_SQUARE);
+
+  gtk_snapshot_append_stroke (
+      snapshot, path, stroke,
+      self->dark_theme
+          ? &(const GdkRGBA) { 1.0, 1.0, 1.0, 1.0 }
+          : &(const GdkRGBA) { 0.0, 0.0, 0.0, 1.0 });
+
+  /* Packed like the handle's planes so placement can
+   * test a whole row of the brush at once
+   */
+  self->brush_stride = (mask_width + 63) / 64;
+  self->brush_mask   = g_new0 (guint64, (gsize) self->brush_stride * mask_height);
+  for (int y = 0; y < mask_height; y++)
+    {
+      for (int x = 0; x < mask_width; x++)
+        {
+          if (mask[y * mask_width + x] != 0)
+            self->brush_mask[y * self->brush_stride + x / 64] |= G_GUINT64_CONSTANT (1) << (x % 64);
+        }
+    }
+  self->brush_width  = mask_width;
+  self->brush_height = mask_height;
+  self->brush_node   = gtk_snapshot_free_to_node (g_steal_pointer (&snapshot));
+
+  if (different)
+    {
+      self->brush_adjustment = gcv_brushable_get_adjustment (brush);
+      if (self->brush_adjustment != NULL)
+        g_signal_connect (self->brush_adjustment, "value-changed",
+                          G_CALLBACK (selected_brush_adjustment_value_changed), self);
+    }
+}
+
+static void
+read_background_image (GcvMapEditor *self)
+{
+  g_autofree char *path = NULL;
+
+  g_clear_object (&self->bg_image_tex);
+  queue_draw_layers (self);
+
+  path = g_settings_get_string (self->settings, "background-image");
+
+  if (path[0] != '\0')
+    {
+      g_autoptr (GTask) task = NULL;
+
+      task = g_task_new (self, NULL, background_texture_load_finish_cb, NULL);
+      g_task_set_task_data (task, g_steal_pointer (&path), g_free);
+      g_task_set_priority (task, G_PRIORITY_HIGH);
+      g_task_set_check_cancellable (task, TRUE);
+      g_task_run_in_thread (task, background_texture_load_async_thread);
+    }
+}
+
+static void
+background_texture_load_async_thread (GTask        *task,
+                                      gpointer      object,
+                                      gpointer      task_data,
+                                      GCancellable *cancellable)
+{
+  const char *path               = task_data;
+  g_autoptr (GError) local_error = NULL;
+  g_autoptr (GdkTexture) texture = NULL;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  texture = gdk_texture_new_from_filename (path, &local_error);
+  if (texture == NULL)
+    {
+      g_task_return_error (task, g_steal_pointer (&local_error));
+      return;
+    }
+
+  g_task_return_pointer (task, g_steal_pointer (&texture), g_object_unref);
+}
+
+static void
+background_texture_load_finish_cb (GObject      *source_object,
+                                   GAsyncResult *res,
+                                   gpointer      data)
+{
+  GcvMapEditor *editor           = GCV_MAP_EDITOR (source_object);
+  g_autoptr (GError) local_error = NULL;
+  GdkTexture *texture            = NULL;
+
+  texture = g_task_propagate_pointer (G_TASK (res), &local_error);
+
+  if (texture == NULL)
+    {
+      gcv_dialog_for_widget (
+          "Error",
+          "Could not load background image",
+          local_error->message,
+          FALSE, GTK_WIDGET (editor), NULL);
+
+      if (editor->settings != NULL)
+        g_settings_set_string (editor->settings, "background-image", "");
+    }
+
+  g_clear_object (&editor->bg_image_tex);
+  editor->bg_image_tex = texture;
+  queue_draw_layers (editor);
+}
+
+static void
+update_accessibility_texture (GcvMapEditor *self,
+                              int           map_tile_width,
+                              int           map_tile_height)
+{
+  const guint8 reachable[4]   = { 0, 255, 51, 128 };
+  const guint8 unreachable[4] = { 255, 51, 0, 128 };
+
+  gsize       n_tiles = 0;
+  gboolean    full    = FALSE;
+  int         min_x   = G_MAXINT;
+  int         min_y   = G_MAXINT;
+  int         max_x   = -1;
+  int         max_y   = -1;
+  GdkTexture *texture = NULL;
+
+  g_assert (self->accessibility_mask != NULL);
+
+  n_tiles = (gsize) map_tile_width * (gsize) map_tile_height;
+  full    = self->accessibility_tex == NULL ||
+         gdk_texture_get_width (self->accessibility_tex) != map_tile_width ||
+         gdk_texture_get_height (self->accessibility_tex) != map_tile_height;
+
+  if (full)
+    {
+      g_clear_object (&self->accessibility_tex);
+      g_clear_pointer (&self->accessibility_pixels, g_free);
+      self->accessibility_pixels = g_malloc (n_tiles * 4);
+    }
+
+  for (int y = 0; y < map_tile_height; y++)
+    {
+      for (int x = 0; x < map_tile_width; x++)
+        {
+          gsize         idx   = 0;
+          const guint8 *color = NULL;
+          guint8       *pixel = NULL;
+
+          idx   = (gsize) y * map_tile_width + x;
+          color = self->accessibility_mask[idx] == 1 ? reachable : unreachable;
+          pixel = self->accessibility_pixels + idx * 4;
+
+          if (!full && memcmp (pixel, color, 4) == 0)
+            continue;
+          memcpy (pixel, color, 4);
+
+          min_x = MIN (min_x, x);
+          min_y = MIN (min_y, y);
+          max_x = MAX (max_x, x);
+          max_y = MAX (max_y, y);
+        }
+    }
+
+  if (!full && max_x < 0)
+    /* Nothing changed */
+    return;
+
+  texture = upload_tile_pixels (
+      self->accessibility_pixels,
+      map_tile_width, map_tile_height,
+      full ? NULL : self->accessibility_tex,
+      min_x, min_y, max_x, max_y);
+  g_clear_object (&self->accessibility_tex);
+  self->accessibility_tex = texture;
+}
+
+static void
+ensure_accessibility_texture (GcvMapEditor *self,
+                              int           map_tile_width,
+                              int           map_tile_height)
+{
+  gint64 begin_time = 0;
+
+  if (self->accessibility_mask != NULL)
+    return;
+
+  begin_time               = g_get_monotonic_time ();
+  self->accessibility_mask = gcv_map_handle_get_accessibilty_mask (self->handle);
+  update_accessibility_texture (self, map_tile_width, map_tile_height);
+  gcv_stats_record_time ("editor.accessibility", begin_time);
+}
+
+static void
+update_lod_texture (GcvMapEditor *self,
+                    int           map_tile_width,
+                    int           map_tile_height)
+{
+  /* Straight alpha, indexed by GcvItemKind */
+  static const guint8 kind_colors[][3] = {
+    [GCV_ITEM_KIND_BUILDING]     = { 214, 160, 74 },
+    [GCV_ITEM_KIND_UNIT]         = { 191, 64, 255 },
+    [GCV_ITEM_KIND_WALL]         = { 150, 150, 150 },
+    [GCV_ITEM_KIND_GATEHOUSE_NS] = { 105, 105, 120 },
+    [GCV_ITEM_KIND_GATEHOUSE_EW] = { 105, 105, 120 },
+    [GCV_ITEM_KIND_MOAT]         = { 40, 110, 200 },
+  };
+
+  g_autoptr (GListStore) model = NULL;
+  guint       cursor           = 0;
+  guint       cursor_len       = 0;
+  guint       n_strokes        = 0;
+  guint       limit            = 0;
+  gsize       n_tiles          = 0;
+  gboolean    full             = FALSE;
+  gboolean    recolor          = FALSE;
+  int         dirty_min_x      = G_MAXINT;
+  int         dirty_min_y      = G_MAXINT;
+  int         dirty_max_x      = -1;
+  int         dirty_max_y      = -1;
+  int         min_x            = G_MAXINT;
+  int         min_y            = G_MAXINT;
+  int         max_x            = -1;
+  int         max_y            = -1;
+  gint64      begin_time       = 0;
+  GdkTexture *texture          = NULL;
+
+  begin_time = g_get_monotonic_time ();
+
+  g_object_get (
+      self->handle,
+      "model", &model,
+      "cursor", &cursor,
+      "cursor-len", &cursor_len,
+      NULL);
+
+  if (G_LIST_MODEL (model) != self->lod_model)
+    {
+      if (self->lod_model != NULL)
+        g_signal_handlers_disconnect_by_func (self->lod_model, lod_strokes_changed, self);
+      g_clear_object (&self->lod_model);
+
+      self->lod_model = g_object_ref (G_LIST_MODEL (model));
+      g_signal_connect (self->lod_model, "items-changed",
+                        G_CALLBACK (lod_strokes_changed), self);
+      self->lod_stale = TRUE;
+    }
+
+  n_tiles = (gsize) map_tile_width * (gsize) map_tile_height;
+  full    = self->lod_tex == NULL ||
+         gdk_texture_get_width (self->lod_tex) != map_tile_width ||
+         gdk_texture_get_height (self->lod_tex) != map_tile_height;
+
+  if (full)
+    {
+      g_clear_object (&self->lod_tex);
+      g_clear_pointer (&self->lod_pixels, g_free);
+      g_clear_pointer (&self->lod_owners, g_free);
+      self->lod_pixels = g_malloc (n_tiles * 4);
+      self->lod_owners = g_new0 (guint, n_tiles);
+      self->lod_stale  = TRUE;
+    }
+
+  n_strokes = g_list_model_get_n_items (G_LIST_MODEL (model));
+  limit     = self->draw_after_cursor
+                  ? n_strokes
+                  : MIN (n_strokes, cursor + cursor_len);
+
+  /* Appended strokes are painted on top of what is already
+   * there, anything else has to start over from the bottom
+   */
+  if (self->lod_stale || limit < self->lod_n_strokes)
+    {
+      memset (self->lod_owners, 0, n_tiles * sizeof (*self->lod_owners));
+      g_byte_array_set_size (self->lod_kinds, 0);
+      self->lod_n_strokes = 0;
+      self->lod_stale     = FALSE;
+      recolor             = TRUE;
+      gcv_stats_add_count ("editor.lod.full", 1);
+    }
+  else if (limit > self->lod_n_strokes)
+    gcv_stats_add_count ("editor.lod.append", 1);
+  else if (cursor == self->lod_cursor && cursor_len == self->lod_cursor_len)
+    {
+      gcv_stats_add_count ("editor.lod.hit", 1);
+      return;
+    }
+
+  /* Moving the cursor can change the state of any stroke,
+   * unless every stroke already drawn stays before it, as
+   * when the cursor just advanced over appended strokes
+   */
+  recolor = recolor || full ||
+            ((cursor != self->lod_cursor ||
+              cursor_len != self->lod_cursor_len) &&
+             (self->lod_cursor < self->lod_n_strokes ||
+              cursor < self->lod_n_strokes));
+  self->lod_cursor     = cursor;
+  self->lod_cursor_len = cursor_len;
+
+  for (guint i = self->lod_n_strokes; i < limit; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GcvItem) item         = NULL;
+      g_autoptr (GArray) instances     = NULL;
+      GcvItemKind item_kind            = GCV_ITEM_KIND_BUILDING;
+      int         item_tile_width      = 0;
+      int         item_tile_height     = 0;
+      guint8      kind_byte            = 0;
+
+      stroke = g_list_model_get_item (G_LIST_MODEL (model), i);
+      g_object_get (
+          stroke,
+          "item", &item,
+          "instances", &instances,
+          NULL);
+      item_kind        = gcv_item_get_info (item)->kind;
+      item_tile_width  = gcv_item_get_info (item)->tile_width;
+      item_tile_height = gcv_item_get_info (item)->tile_height;
+
+      kind_byte = (guint8) item_kind;
+      g_byte_array_append (self->lod_kinds, &kind_byte, 1);
+
+      for (guint j = 0; j < instances->len; j++)
+        {
+          GcvItemStrokeInstance instance = { 0 };
+          int                   x0       = 0;
+          int                   y0       = 0;
+          int                   x1       = 0;
+          int                   y1       = 0;
+
+          instance = g_array_index (instances, GcvItemStrokeInstance, j);
+          x0       = MAX (instance.x, 0);
+          y0       = MAX (instance.y, 0);
+          x1       = MIN (instance.x + item_tile_width, map_tile_width);
+          y1       = MIN (instance.y + item_tile_height, map_tile_height);
+          if (x0 >= x1 || y0 >= y1)
+            continue;
+
+          for (int y = y0; y < y1; y++)
+            {
+              for (int x = x0; x < x1; x++)
+                self->lod_owners[(gsize) y * map_tile_width + x] = i + 1;
+            }
+
+          dirty_min_x = MIN (dirty_min_x, x0);
+          dirty_min_y = MIN (dirty_min_y, y0);
+          dirty_max_x = MAX (dirty_max_x, x1 - 1);
+          dirty_max_y = MAX (dirty_max_y, y1 - 1);
+        }
+    }
+  self->lod_n_strokes = limit;
+
+  if (recolor)
+    {
+      dirty_min_x = 0;
+      dirty_min_y = 0;
+      dirty_max_x = map_tile_width - 1;
+      dirty_max_y = map_tile_height - 1;
+    }
+
+  /* Otherwise only the tiles under appended strokes need a look */
+  for (int y = dirty_min_y; y <= dirty_max_y; y++)
+    {
+      for (int x = dirty_min_x; x <= dirty_max_x; x++)
+        {
+          gsize   idx      = 0;
+          guint   owner    = 0;
+          guint8  color[4] = { 0 };
+          guint8 *pixel    = NULL;
+
+          idx   = (gsize) y * map_tile_width + x;
+          owner = self->lod_owners[idx];
+          pixel = self->lod_pixels + idx * 4;
+
+          if (owner > 0)
+            {
+              guint8 kind = 0;
+
+              kind = self->lod_kinds->data[owner - 1];
+              if (kind < G_N_ELEMENTS (kind_colors))
+                memcpy (color, kind_colors[kind], 3);
+
+              if (owner - 1 < cursor)
+                color[3] = 255;
+              else if (owner - 1 < cursor + cursor_len)
+                {
+                  /* Lighten the selection instead of outlining it */
+                  for (guint k = 0; k < 3; k++)
+                    color[k] = (color[k] + 255) / 2;
+                  color[3] = 255;
+                }
+              else
+                color[3] = 77;
+            }
+
+          if (!full && memcmp (pixel, color, 4) == 0)
+            continue;
+          memcpy (pixel, color, 4);
+
+          min_x = MIN (min_x, x);
+          min_y = MIN (min_y, y);
+          max_x = MAX (max_x, x);
+          max_y = MAX (max_y, y);
+        }
+    }
+
+  if (full || max_x >= 0)
+    {
+      texture = upload_tile_pixels (
+          self->lod_pixels,
+          map_tile_width, map_tile_height,
+          full ? NULL : self->lod_tex,
+          min_x, min_y, max_x, max_y);
+      g_clear_object (&self->lod_tex);
+      self->lod_tex = texture;
+    }
+
+  gcv_stats_record_time ("editor.lod", begin_time);
+}
+
+static GdkTexture *
+upload_tile_pixels (const guint8 *pixels,
+                    int           width,
+                    int           height,
+                    GdkTexture   *update_texture,
+                    int           min_x,
+                    int           min_y,
+                    int           max_x,
+                    int           max_y)
+{
+  g_autoptr (GBytes) bytes                    = NULL;
+  g_autoptr (GdkMemoryTextureBuilder) builder = NULL;
+
+  bytes   = g_bytes_new (pixels, (gsize) width * (gsize) height * 4);
+  builder = gdk_memory_texture_builder_new ();
+  gdk_memory_texture_builder_set_bytes (builder, bytes);
+  gdk_memory_texture_builder_set_stride (builder, (gsize) width * 4);
+  gdk_memory_texture_builder_set_width (builder, width);
+  gdk_memory_texture_builder_set_height (builder, height);
+  gdk_memory_texture_builder_set_format (builder, GDK_MEMORY_R8G8B8A8);
+
+  if (update_texture != NULL)
+    {
+      cairo_region_t *region = NULL;
+
+      /* Let the renderer only upload the part that changed */
+      region = cairo_region_create_rectangle (
+          &(cairo_rectangle_int_t) {
+              .x      = min_x,
+              .y      = min_y,
+              .width  = max_x - min_x + 1,
+              .height = max_y - min_y + 1,
+          });
+      gdk_memory_texture_builder_set_update_texture (builder, update_texture);
+      gdk_memory_texture_builder_set_update_region (builder, region);
+      cairo_region_destroy (region);
+    }
+
+  return gdk_memory_texture_builder_build (builder);
+}
+
+static void
+invalidate_render_cache (GcvMapEditor *self,
+                         const char   *reason)
+{
+  /* Only remember why a valid cache was first dropped. The
+   * old one stays on screen until the new one is ready.
+   */
+  if (!self->render_cache_dirty &&
+      (self->render_cache != NULL || self->render_job != NULL))
+    self->render_cache_reason = reason;
+  self->render_cache_dirty = TRUE;
+}
+
+static gboolean
+capture_zoom_texture (GcvMapEditor *self)
+{
+  GtkNative      *native           = NULL;
+  GskRenderer    *renderer         = NULL;
+  int             map_tile_width   = 0;
+  int             map_tile_height  = 0;
+  graphene_rect_t bounds           = { 0 };
+  double          scale            = 0.0;
+  double          pixels           = 0.0;
+  gint64          begin_time       = 0;
+  g_autoptr (GtkSnapshot) snapshot = NULL;
+  g_autoptr (GskRenderNode) node   = NULL;
+
+  if (self->render_cache == NULL || self->map == NULL)
+    return FALSE;
+
+  native = gtk_widget_get_native (GTK_WIDGET (self));
+  if (native == NULL)
+    return FALSE;
+  renderer = gtk_native_get_renderer (native);
+  if (renderer == NULL)
+    return FALSE;
+
+  begin_time = g_get_monotonic_time ();
+
+  g_object_get (
+      self->map,
+      "width", &map_tile_width,
+      "height", &map_tile_height,
+      NULL);
+  if (!graphene_rect_intersection (
+          &self->viewport,
+          &GRAPHENE_RECT_INIT (
+              0, 0,
+              map_tile_width * BASE_TILE_SIZE,
+              map_tile_height * BASE_TILE_SIZE),
+          &bounds))
+    return FALSE;
+
+  /* The cache covers more than the screen, so
+   * drop resolution rather than stall the gesture
+   */
+  scale  = self->render_cache_zoom;
+  pixels = bounds.size.width * scale * bounds.size.height * scale;
+  if (pixels > MAX_ZOOM_TEXTURE_PIXELS)
+    scale *= sqrt (MAX_ZOOM_TEXTURE_PIXELS / pixels);
+
+  snapshot = gtk_snapshot_new ();
+  gtk_snapshot_scale (
+      snapshot,
+      scale / self->render_cache_zoom,
+      scale / self->render_cache_zoom);
+  gtk_snapshot_append_node (snapshot, self->render_cache);
+  node = gtk_snapshot_free_to_node (g_steal_pointer (&snapshot));
+  if (node == NULL)
+    return FALSE;
+
+  self->zoom_tex = gsk_renderer_render_texture (
+      renderer, node,
+      &GRAPHENE_RECT_INIT (
+          bounds.origin.x * scale,
+          bounds.origin.y * scale,
+          bounds.size.width * scale,
+          bounds.size.height * scale));
+  self->zoom_tex_bounds = bounds;
+
+  gcv_stats_record_time ("editor.zoom.capture", begin_time);
+  return TRUE;
+}
+
+static void
+begin_interim_zoom (GcvMapEditor *self)
+{
+  if (self->zoom_tex == NULL &&
+      (self->zoom < LOD_ZOOM || !capture_zoom_texture (self)))
+    {
+      invalidate_render_cache (self, "zoom");
+      gtk_widget_queue_draw (self->map_layer);
+      return;
+    }
+
+  /* Whatever was being built is for an old zoom level */
+  cancel_render_job (self);
+
+  g_clear_handle_id (&self->zoom_settle_source, g_source_remove);
+  self->zoom_settle_source = g_timeout_add (
+      ZOOM_SETTLE_MS, (GSourceFunc) zoom_settle_timeout, self);
+
+  gtk_widget_queue_draw (self->map_layer);
+}
+
+static void
+end_interim_zoom (GcvMapEditor *self)
+{
+  g_clear_handle_id (&self->zoom_settle_source, g_source_remove);
+
+  if (self->zoom_tex == NULL)
+    return;
+
+  g_clear_object (&self->zoom_tex);
+  invalidate_render_cache (self, "zoom");
+  gtk_widget_queue_draw (self->map_layer);
+}
+
+static gboolean
+zoom_settle_timeout (GcvMapEditor *self)
+{
+  self->zoom_settle_source = 0;
+  end_interim_zoom (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static LabelCacheEntry *
+ensure_label (GcvMapEditor *self,
+              const char   *text,
+              double        width,
+              guint         font_hash)
+{
+  int              bucket   = 0;
+  char             key[320] = { 0 };
+  LabelCacheEntry *entry    = NULL;
+
+  if (text == NULL)
+    text = "";
+
+  /* Round up so the text still fits, but small zoom
+   * changes don't force everything to be reshaped
+   */
+  bucket = MAX (1, (int) ceil (width / LABEL_CACHE_WIDTH_BUCKET));
+  g_snprintf (key, sizeof (key), "%u:%d:%s", font_hash, bucket, text);
+
+  entry = g_hash_table_lookup (self->label_cache, key);
+  if (entry != NULL)
+    {
+      gcv_stats_add_count ("editor.label-cache.hit", 1);
+      g_queue_unlink (&self->label_lru, &entry->link);
+      g_queue_push_head_link (&self->label_lru, &entry->link);
+      return entry;
+    }
+
+  while (self->label_lru.length >= LABEL_CACHE_SIZE)
+    {
+      GList *tail = NULL;
+
+      tail = g_queue_pop_tail_link (&self->label_lru);
+      g_hash_table_remove (self->label_cache, ((LabelCacheEntry *) tail->data)->key);
+    }
+
+  gcv_stats_add_count ("editor.label-cache.miss", 1);
+
+  entry            = g_new0 (LabelCacheEntry, 1);
+  entry->link.data = entry;
+  entry->key       = g_strdup (key);
+  entry->width     = (double) bucket * LABEL_CACHE_WIDTH_BUCKET;
+  entry->layout    = gtk_widget_create_pango_layout (GTK_WIDGET (self), text);
+
+  pango_layout_set_single_paragraph_mode (entry->layout, TRUE);
+  pango_layout_set_alignment (entry->layout, PANGO_ALIGN_CENTER);
+  pango_layout_set_width (entry->layout, pango_units_from_double (entry->width));
+  pango_layout_get_extents (entry->layout, NULL, &entry->extents);
+
+  g_hash_table_replace (self->label_cache, entry->key, entry);
+  g_queue_push_head_link (&self->label_lru, &entry->link);
+
+  return entry;
+}
+
+static void
+destroy_label_cache_entry (gpointer data)
+{
+  LabelCacheEntry *entry = data;
+
+  g_clear_object (&entry->layout);
+  g_clear_pointer (&entry->node, gsk_render_node_unref);
+  g_free (entry->key);
+  g_free (entry);
+}
+
+static GskRenderNode *
+ensure_label_node (GcvMapEditor    *self,
+                   LabelCacheEntry *label,
+                   const GdkRGBA   *rgba)
+{
+  g_autoptr (GtkSnapshot) snapshot = NULL;
+
+  if (label->node != NULL && gdk_rgba_equal (&label->node_rgba, rgba))
+    return label->node;
+
+  /* Render nodes are immutable, so unlike the
+   * layout this is safe to hand to the workers
+   */
+  snapshot = gtk_snapshot_new ();
+  gtk_snapshot_append_layout (snapshot, label->layout, rgba);
+
+  g_clear_pointer (&label->node, gsk_render_node_unref);
+  label->node      = gtk_snapshot_to_node (snapshot);
+  label->node_rgba = *rgba;
+
+  return label->node;
+}
+
+static inline graphene_rect_t
+instance_rect (const RenderStroke          *stroke,
+               const GcvItemStrokeInstance *instance,
+               double                       tile_size)
+{
+  return GRAPHENE_RECT_INIT (
+      instance->x * tile_size - 1.0,
+      instance->y * tile_size - 1.0,
+      stroke->tile_width * tile_size + 2.0,
+      stroke->tile_height * tile_size + 2.0);
+}
+
+static void
+start_render_job (GcvMapEditor          *self,
+                  const graphene_rect_t *viewport,
+                  int                    map_tile_width,
+                  int                    map_tile_height,
+                  gboolean               synchronous)
+{
+  g_autoptr (GListStore) model = NULL;
+  guint        cursor              = 0;
+  guint        cursor_len          = 0;
+  guint        total_strokes       = 0;
+  guint        total_drawn_strokes = 0;
+  guint        font_hash           = 0;
+  GdkRGBA      widget_rgba         = { 0 };
+  RenderJob   *job                 = NULL;
+  RenderInput *input               = NULL;
+  double       band_height         = 0.0;
+  char         reason_name[128]    = { 0 };
+
+  cancel_render_job (self);
+  self->render_cache_dirty = FALSE;
+
+  gcv_stats_add_count ("editor.render-cache.miss", 1);
+  g_snprintf (reason_name, sizeof (reason_name), "editor.render-cache.reason.%s",
+              self->render_cache_reason != NULL ? self->render_cache_reason : "initial");
+  gcv_stats_add_count (reason_name, 1);
+  self->render_cache_reason = NULL;
+
+  g_object_get (
+      self->handle,
+      "model", &model,
+      "cursor", &cursor,
+      "cursor-len", &cursor_len,
+      NULL);
+
+  job             = g_atomic_rc_box_new0 (RenderJob);
+  job->generation = ++self->render_generation;
+  job->viewport   = *viewport;
+  job->zoom       = self->zoom;
+  job->begin_time = g_get_monotonic_time ();
+
+  input                  = &job->input;
+  input->cursor          = cursor;
+  input->cursor_len      = cursor_len;
+  input->tile_size       = BASE_TILE_SIZE * self->zoom;
+  input->map_tile_width  = map_tile_width;
+  input->map_tile_height = map_tile_height;
+  input->map_width       = (double) map_tile_width * input->tile_size;
+  input->map_height      = (double) map_tile_height * input->tile_size;
+  input->dark_theme      = self->dark_theme;
+  input->extents         = GRAPHENE_RECT_INIT (
+      viewport->origin.x * self->zoom,
+      viewport->origin.y * self->zoom,
+      viewport->size.width * self->zoom,
+      viewport->size.height * self->zoom);
+
+  gtk_widget_get_color (GTK_WIDGET (self), &widget_rgba);
+  input->bg_rgba = (GdkRGBA) {
+    .red   = 1.0 - widget_rgba.red,
+    .green = 1.0 - widget_rgba.green,
+    .blue  = 1.0 - widget_rgba.blue,
+    .alpha = 0.75,
+  };
+
+  font_hash = pango_font_description_hash (
+      pango_context_get_font_description (
+          gtk_widget_get_pango_context (GTK_WIDGET (self))));
+
+  total_strokes       = g_list_model_get_n_items (G_LIST_MODEL (model));
+  total_drawn_strokes = self->draw_after_cursor
+                            ? total_strokes
+                            : MIN (total_strokes, cursor + cursor_len);
+
+  input->strokes = g_array_sized_new (FALSE, TRUE, sizeof (RenderStroke), total_drawn_strokes);
+  g_array_set_clear_func (input->strokes, clear_render_stroke);
+  g_array_set_size (input->strokes, total_drawn_strokes);
+
+  job->n_regions = synchronous ? 1 : CLAMP (g_get_num_processors (), 1, MAX_RENDER_REGIONS);
+  job->n_pending = job->n_regions;
+  job->regions   = g_new0 (RenderRegion, job->n_regions);
+  for (guint i = 0; i < job->n_regions; i++)
+    job->regions[i].instances = g_array_new (FALSE, FALSE, sizeof (RenderInstance));
+  band_height = input->extents.size.height / (double) job->n_regions;
+
+  for (guint i = 0; i < total_drawn_strokes; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GcvItem) item         = NULL;
+      g_autoptr (GArray) instances     = NULL;
+      RenderStroke *render_stroke      = NULL;
+      gboolean      visible            = FALSE;
+      gboolean      wants_layout       = FALSE;
+
+      render_stroke        = &g_array_index (input->strokes, RenderStroke, i);
+      render_stroke->index = i;
+
+      stroke = g_list_model_get_item (G_LIST_MODEL (model), i);
+      g_object_get (
+          stroke,
+          "item", &item,
+          "instances", &instances,
+          NULL);
+      render_stroke->kind        = gcv_item_get_info (item)->kind;
+      render_stroke->tile_width  = gcv_item_get_info (item)->tile_width;
+      render_stroke->tile_height = gcv_item_get_info (item)->tile_height;
+
+      /* Hand each visible instance to the band containing
+       * its top edge, so every band only walks its own
+       */
+      for (guint j = 0; j < instances->len; j++)
         {
-          h_lower        = -((double) widget_width - h_upper) / 2.0;
-          h_upper        = h_lower + (double) widget_width;
-          force_center_h = TRUE;
+          RenderInstance render_instance = { 0 };
+          double         band            = 0.0;
+
+          render_instance.stroke = i;
+          render_instance.rect   = instance_rect (
+              render_stroke, &g_array_index (instances, GcvItemStrokeInstance, j), input->tile_size);
+
+          if (!graphene_rect_intersection (&input->extents, &render_instance.rect, NULL))
+            {
+              job->n_culled++;
+              continue;
+            }
+          visible = TRUE;
+
+          band = floor ((render_instance.rect.origin.y - input->extents.origin.y) / band_height);
+          band = CLAMP (band, 0.0, (double) (job->n_regions - 1));
+          g_array_append_val (job->regions[(guint) band].instances, render_instance);
         }
 
-      if (v_upper < (double) widget_height)
+      if (render_stroke->kind != GCV_ITEM_KIND_UNIT)
         {
-          v_lower        = -((double) widget_height - v_upper) / 2.0;
-          v_upper        = v_lower + (double) widget_height;
-          force_center_v = TRUE;
+          gpointer    tile_hash    = NULL;
+          GdkTexture *tile_texture = NULL;
+
+          tile_hash = gcv_item_get_tile_resource_hash (item);
+          if (tile_hash != NULL)
+            {
+              tile_texture = g_hash_table_lookup (self->tile_textures, tile_hash);
+              if (tile_texture == NULL)
+                {
+                  g_autofree char *tile_resource = NULL;
+
+                  g_object_get (
+                      item,
+                      "tile-resource", &tile_resource,
+                      NULL);
+
+                  tile_texture = gdk_texture_new_from_resource (tile_resource);
+                  g_hash_table_replace (self->tile_textures, tile_hash, tile_texture);
+                }
+              render_stroke->texture = g_object_ref (tile_texture);
+            }
         }
 
-      g_object_set (
-          self->hadjustment,
-          "page-size", (double) widget_width,
-          "lower", h_lower,
-          "upper", h_upper,
-          NULL);
-      g_object_set (
-          self->vadjustment,
-          "page-size", (double) widget_height,
-          "lower", v_lower,
-          "upper", v_upper,
-          NULL);
+      wants_layout = i < cursor + cursor_len &&
+                     self->zoom >= 0.5 &&
+                     (self->zoom >= 3.5 ||
+                      render_stroke->tile_width > 1 ||
+                      render_stroke->tile_height > 1 ||
+                      render_stroke->kind == GCV_ITEM_KIND_UNIT);
+
+      /* Text shaping has to happen here on the main thread,
+       * so only do it for strokes that will actually be seen
+       */
+      if (wants_layout)
+        {
+          if (visible)
+            {
+              const char      *item_name = NULL;
+              char             buf[256]  = { 0 };
+              const char      *ptr       = NULL;
+              LabelCacheEntry *label     = NULL;
+              GskRenderNode   *node      = NULL;
 
-      if (center || self->queue_center || force_center_h)
-        gtk_adjustment_set_value (
-            self->hadjustment,
-            force_center_h
-                ? h_lower
-                : (h_lower + h_upper - (double) widget_width) / 2.0);
+              item_name = gcv_item_get_name (item);
+
+              if (self->zoom >= 4.5)
+                {
+                  g_snprintf (buf, sizeof (buf), "%s (stroke %d)", item_name, i);
+                  ptr = buf;
+                }
+              else if (item_name != NULL &&
+                       self->zoom <= 0.5 &&
+                       (render_stroke->tile_width <= 5 || render_stroke->tile_height <= 5))
+                {
+                  g_snprintf (buf, sizeof (buf), "%c", item_name[0]);
+                  ptr = buf;
+                }
+              else
+                ptr = item_name;
+
+              label = ensure_label (
+                  self, ptr,
+                  (double) render_stroke->tile_width * input->tile_size,
+                  font_hash);
+              if (label != NULL)
+                node = ensure_label_node (self, label, &widget_rgba);
+
+              if (node != NULL)
+                {
+                  render_stroke->label_node    = gsk_render_node_ref (node);
+                  render_stroke->label_extents = label->extents;
+                  render_stroke->label_width   = label->width;
+                }
+            }
+        }
+    }
+
+  self->render_job = job;
+
+  if (synchronous)
+    {
+      build_render_region (job, 0);
+      finish_render_job (self);
+      return;
+    }
+
+  self->render_cancellable = g_cancellable_new ();
+  for (guint i = 0; i < job->n_regions; i++)
+    {
+      g_autoptr (GTask) task = NULL;
+      RenderTaskData *data   = NULL;
+
+      data         = g_new0 (typeof (*data), 1);
+      data->job    = g_atomic_rc_box_acquire (job);
+      data->region = i;
+
+      task = g_task_new (self, self->render_cancellable,
+                         render_region_finish_cb, g_atomic_rc_box_acquire (job));
+      g_task_set_source_tag (task, start_render_job);
+      g_task_set_task_data (task, data, destroy_render_task_data);
+      g_task_set_priority (task, G_PRIORITY_HIGH);
+      g_task_set_check_cancellable (task, TRUE);
+      g_task_run_in_thread (task, render_region_async_thread);
+    }
+}
+
+static void
+finish_render_job (GcvMapEditor *self)
+{
+  RenderJob   *job        = self->render_job;
+  RenderInput *input      = &self->render_job->input;
+  double       tile_size  = 0.0;
+  double       map_width  = 0.0;
+  double       map_height = 0.0;
+  gint64       n_nodes    = 0;
+
+  g_autoptr (GtkSnapshot) regen                = NULL;
+  g_autoptr (GskPathBuilder) keep_path_builder = NULL;
+  g_autoptr (GskPath) keep_path                = NULL;
+  g_autoptr (GskStroke) keep_stroke            = NULL;
+  const GcvMapKeepCorner *keep_outline         = NULL;
+  guint                   n_keep_corners       = 0;
+
+  tile_size  = input->tile_size;
+  map_width  = input->map_width;
+  map_height = input->map_height;
+
+  regen = gtk_snapshot_new ();
+
+  /* Composite layer by layer so stacking matches
+   * a single pass over the whole viewport
+   */
+  for (guint layer = 0; layer < N_RENDER_LAYERS; layer++)
+    {
+      if (layer == RENDER_LAYER_UNITS)
+        {
+          keep_outline      = gcv_map_get_keep_outline (&n_keep_corners);
+          keep_path_builder = gsk_path_builder_new ();
+          gsk_path_builder_move_to (
+              keep_path_builder,
+              map_width / 2.0 + keep_outline[0].x * tile_size,
+              map_height / 2.0 + keep_outline[0].y * tile_size);
+          for (guint i = 1; i < n_keep_corners; i++)
+            gsk_path_builder_line_to (
+                keep_path_builder,
+                map_width / 2.0 + keep_outline[i].x * tile_size,
+                map_height / 2.0 + keep_outline[i].y * tile_size);
+          gsk_path_builder_close (keep_path_builder);
+          gsk_path_builder_add_circle (
+              keep_path_builder,
+              &GRAPHENE_POINT_INIT (map_width / 2.0 - 3.5 * tile_size, map_height / 2.0 + 4.5 * tile_size),
+              1.5 * tile_size);
+          keep_path = gsk_path_builder_free_to_path (g_steal_pointer (&keep_path_builder));
+
+          keep_stroke = gsk_stroke_new (tile_size * 0.25);
+          gsk_stroke_set_dash (keep_stroke, (const float[]) { tile_size * 0.25, tile_size * 0.5 }, 2);
+          gsk_stroke_set_line_cap (keep_stroke, GSK_LINE_CAP_SQUARE);
+
+          gtk_snapshot_append_stroke (
+              regen, keep_path, keep_stroke,
+              input->dark_theme
+                  ? &(const GdkRGBA) { 1.0, 1.0, 1.0, 1.0 }
+                  : &(const GdkRGBA) { 0.0, 0.0, 0.0, 1.0 });
+          n_nodes++;
+        }
+
+      for (guint i = 0; i < job->n_regions; i++)
+        {
+          if (job->regions[i].layers[layer] != NULL)
+            gtk_snapshot_append_node (regen, job->regions[i].layers[layer]);
+        }
+    }
+
+  for (guint i = 0; i < job->n_regions; i++)
+    n_nodes += job->regions[i].n_nodes;
+
+  if (self->show_accessibility)
+    {
+      ensure_accessibility_texture (self, input->map_tile_width, input->map_tile_height);
+
+      /* One pixel per tile */
+      if (self->accessibility_tex != NULL)
+        {
+          gtk_snapshot_append_scaled_texture (
+              regen,
+              self->accessibility_tex,
+              GSK_SCALING_FILTER_NEAREST,
+              &GRAPHENE_RECT_INIT (0, 0, map_width, map_height));
+          n_nodes++;
+        }
+    }
+
+  g_clear_pointer (&self->render_cache, gsk_render_node_unref);
+  self->render_cache      = gtk_snapshot_to_node (regen);
+  self->render_cache_zoom = job->zoom;
+  self->viewport          = job->viewport;
+
+  gcv_stats_record_time ("editor.render-cache.rebuild", job->begin_time);
+  gcv_stats_add_count ("editor.render-cache.nodes", n_nodes);
+  gcv_stats_add_count ("editor.render-cache.culled-instances", job->n_culled);
+
+  if (self->pending_stroke != NULL &&
+      job->generation > self->pending_generation)
+    {
+      g_clear_object (&self->pending_stroke);
+      if (self->cursor_layer != NULL)
+        gtk_widget_queue_draw (self->cursor_layer);
+    }
+
+  g_clear_object (&self->render_cancellable);
+  g_clear_pointer (&self->render_job, release_render_job);
+}
+
+static void
+cancel_render_job (GcvMapEditor *self)
+{
+  if (self->render_cancellable != NULL)
+    g_cancellable_cancel (self->render_cancellable);
+  g_clear_object (&self->render_cancellable);
+  g_clear_pointer (&self->render_job, release_render_job);
+}
+
+/* Runs on a worker thread. Only reads the job input
+ * and only writes to its own region slot.
+ *
+ * Building render nodes here is safe because GtkSnapshot
+ * and GskRenderNode are plain data that never touch GDK,
+ * the display or any widget. Each worker has its own
+ * snapshots, and what it shares with other threads (tile
+ * textures, label nodes) is immutable and refcounted
+ * atomically. Label nodes that need Pango are made on the
+ * main thread in start_render_job ().
+ */
+static void
+build_render_region (RenderJob *job,
+                     guint      region)
+{
+  RenderInput  *input                    = &job->input;
+  RenderRegion *result                   = &job->regions[region];
+  double        tile_size                = job->input.tile_size;
+  g_autoptr (GtkSnapshot) base           = NULL;
+  g_autoptr (GtkSnapshot) tiles          = NULL;
+  g_autoptr (GtkSnapshot) units          = NULL;
+  g_autoptr (GtkSnapshot) labels         = NULL;
+  g_autoptr (GHashTable) texture_to_mask = NULL;
+  gboolean has_units                     = FALSE;
+  gint64   begin_time                    = 0;
+
+  GHashTableIter  iter        = { 0 };
+  graphene_rect_t band_bounds = { 0 };
+  gboolean        have_bounds = FALSE;
+
+  begin_time = g_get_monotonic_time ();
+
+  base            = gtk_snapshot_new ();
+  tiles           = gtk_snapshot_new ();
+  units           = gtk_snapshot_new ();
+  labels          = gtk_snapshot_new ();
+  texture_to_mask = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  gtk_snapshot_push_mask (units, GSK_MASK_MODE_ALPHA);
+
+  for (guint i = 0; i < result->instances->len; i++)
+    {
+      RenderInstance *instance = NULL;
+      RenderStroke   *stroke   = NULL;
+      guint           index    = 0;
+      graphene_rect_t rect     = { 0 };
+
+      instance = &g_array_index (result->instances, RenderInstance, i);
+      stroke   = &g_array_index (input->strokes, RenderStroke, instance->stroke);
+      index    = stroke->index;
+      rect     = instance->rect;
+
+      result->n_nodes++;
+
+      /* Instances hang below the band, so the repeats
+       * below cover what this band drew, not the band itself
+       */
+      if (have_bounds)
+        graphene_rect_union (&band_bounds, &rect, &band_bounds);
       else
+        band_bounds = rect;
+      have_bounds = TRUE;
+
+      if (stroke->kind == GCV_ITEM_KIND_UNIT)
         {
-          double ratio_x    = 0.0;
-          double adjusted_x = 0.0;
+          gtk_snapshot_append_color (
+              units,
+              &(GdkRGBA) { 1.0, 1.0, 1.0, 1.0 },
+              &rect);
+          has_units = TRUE;
+        }
+      else
+        {
+          graphene_rect_t draw_rect = rect;
 
-          ratio_x    = (h_upper - h_lower) / (old_h_upper - old_h_lower);
-          adjusted_x = self->canvas_x * ratio_x - self->pointer_x;
-          gtk_adjustment_set_value (self->hadjustment, adjusted_x);
+          if (index >= input->cursor && index < input->cursor + input->cursor_len)
+            {
+              gtk_snapshot_append_color (
+                  base,
+                  &(GdkRGBA) { 0.0, 0.0, 0.0, 1.0 },
+                  &draw_rect);
+
+              draw_rect.origin.x += tile_size * 0.2;
+              draw_rect.origin.y += tile_size * 0.2;
+              draw_rect.size.width -= tile_size * 0.4;
+              draw_rect.size.height -= tile_size * 0.4;
+            }
+
+          if (stroke->texture != NULL)
+            {
+              GtkSnapshot *mask = NULL;
+
+              mask = g_hash_table_lookup (texture_to_mask, stroke->texture);
+              if (mask == NULL)
+                {
+                  mask = gtk_snapshot_new ();
+                  g_hash_table_replace (texture_to_mask, stroke->texture, mask);
+
+                  gtk_snapshot_push_mask (mask, GSK_MASK_MODE_ALPHA);
+                }
+
+              gtk_snapshot_append_color (
+                  mask,
+                  index < input->cursor
+                      ? &(GdkRGBA) { 1.0, 1.0, 1.0, 1.0 }
+                      : (index < input->cursor + input->cursor_len
+                             ? &(GdkRGBA) { 1.0, 1.0, 1.0, 0.9 }
+                             : &(GdkRGBA) { 1.0, 1.0, 1.0, 0.3 }),
+                  &draw_rect);
+            }
+          else
+            gtk_snapshot_append_color (
+                base,
+                index < input->cursor
+                    ? &(GdkRGBA) { 0.1, 0.5, 1.0, 1.0 }
+                    : (index < input->cursor + input->cursor_len
+                           ? &(GdkRGBA) { 0.1, 0.1, 1.0, 0.9 }
+                           : &(GdkRGBA) { 0.1, 0.1, 1.0, 0.3 }),
+                &draw_rect);
+        }
+
+      if (stroke->label_node != NULL)
+        {
+          gtk_snapshot_save (labels);
+          gtk_snapshot_translate (
+              labels,
+              &GRAPHENE_POINT_INIT (
+                  rect.origin.x,
+                  rect.origin.y + rect.size.height / 2.0 -
+                      (float) PANGO_PIXELS ((float) stroke->label_extents.height / 2.0)));
+
+          gtk_snapshot_append_color (
+              labels, &input->bg_rgba,
+              &GRAPHENE_RECT_INIT (
+                  (rect.size.width - (float) PANGO_PIXELS (stroke->label_extents.width)) / 2.0,
+                  0.0,
+                  (float) PANGO_PIXELS (stroke->label_extents.width),
+                  (float) PANGO_PIXELS (stroke->label_extents.height)));
+
+          /* The cached layout may be a bit wider than the
+           * stroke, so center it manually
+           */
+          gtk_snapshot_translate (
+              labels,
+              &GRAPHENE_POINT_INIT ((rect.size.width - stroke->label_width) / 2.0, 0.0));
+          gtk_snapshot_append_node (labels, stroke->label_node);
+          result->n_nodes += 2;
+
+          gtk_snapshot_restore (labels);
+        }
+    }
+
+  if (have_bounds)
+    graphene_rect_intersection (&band_bounds, &input->extents, &band_bounds);
+
+  g_hash_table_iter_init (&iter, texture_to_mask);
+  for (;;)
+    {
+      GdkTexture  *texture                = NULL;
+      GtkSnapshot *mask                   = NULL;
+      g_autoptr (GskRenderNode) mask_node = NULL;
+
+      if (!g_hash_table_iter_next (
+              &iter, (gpointer *) &texture, (gpointer *) &mask))
+        break;
+
+      gtk_snapshot_pop (mask);
+
+      gtk_snapshot_push_repeat (
+          mask, &band_bounds,
+          &GRAPHENE_RECT_INIT (0, 0, tile_size, tile_size / 2));
+      gtk_snapshot_append_scaled_texture (
+          mask, texture, GSK_SCALING_FILTER_NEAREST,
+          &GRAPHENE_RECT_INIT (0, 0, tile_size, tile_size / 2));
+      gtk_snapshot_pop (mask);
+
+      gtk_snapshot_pop (mask);
+
+      mask_node = gtk_snapshot_free_to_node (mask);
+      if (mask_node != NULL)
+        {
+          gtk_snapshot_append_node (tiles, mask_node);
+          result->n_nodes++;
         }
+    }
+
+  if (has_units)
+    {
+      g_autoptr (GskPathBuilder) units_path_builder = NULL;
+      g_autoptr (GskPath) units_path                = NULL;
+      g_autoptr (GskStroke) units_stroke            = NULL;
+
+      units_path_builder = gsk_path_builder_new ();
+      gsk_path_builder_add_circle (
+          units_path_builder,
+          &GRAPHENE_POINT_INIT (tile_size / 2.0, tile_size / 2.0),
+          tile_size / 3.0);
+      units_path = gsk_path_builder_free_to_path (g_steal_pointer (&units_path_builder));
+
+      units_stroke = gsk_stroke_new (tile_size * 0.15);
+      gsk_stroke_set_dash (units_stroke, (const float[]) { tile_size * 0.25, tile_size * 0.1 }, 2);
+      gsk_stroke_set_line_cap (units_stroke, GSK_LINE_CAP_BUTT);
+
+      gtk_snapshot_pop (units);
+      gtk_snapshot_push_repeat (
+          units, &band_bounds,
+          &GRAPHENE_RECT_INIT (0, 0, tile_size, tile_size));
+      gtk_snapshot_append_stroke (
+          units, units_path, units_stroke,
+          input->dark_theme
+              ? &(const GdkRGBA) { 1.0, 0.25, 0.75, 1.0 }
+              : &(const GdkRGBA) { 0.75, 0.25, 1.0, 1.0 });
+      gtk_snapshot_pop (units);
+      gtk_snapshot_pop (units);
+
+      result->layers[RENDER_LAYER_UNITS] = gtk_snapshot_to_node (units);
+      result->n_nodes++;
+    }
+
+  result->layers[RENDER_LAYER_BASE]   = gtk_snapshot_to_node (base);
+  result->layers[RENDER_LAYER_TILES]  = gtk_snapshot_to_node (tiles);
+  result->layers[RENDER_LAYER_LABELS] = gtk_snapshot_to_node (labels);
+
+  gcv_stats_record_time ("editor.render-cache.region", begin_time);
+}
+
+static void
+render_region_async_thread (GTask        *task,
+                            gpointer      object,
+                            gpointer      task_data,
+                            GCancellable *cancellable)
+{
+  RenderTaskData *data = task_data;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  build_render_region (data->job, data->region);
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+render_region_finish_cb (GObject      *source_object,
+                         GAsyncResult *res,
+                         gpointer      data)
+{
+  GcvMapEditor *editor = GCV_MAP_EDITOR (source_object);
+  RenderJob    *job    = data;
 
-      if (center || self->queue_center || force_center_v)
-        gtk_adjustment_set_value (
-            self->vadjustment,
-            force_center_v
-                ? v_lower
-                : (v_lower + v_upper - (double) widget_height) / 2.0);
-      else
+  /* Regions of a cancelled or superseded job are just dropped */
+  if (g_task_propagate_boolean (G_TASK (res), NULL) &&
+      job == editor->render_job)
+    {
+      job->n_pending--;
+      if (job->n_pending == 0)
         {
-          double ratio_y    = 0.0;
-          double adjusted_y = 0.0;
-
-          ratio_y    = (v_upper - v_lower) / (old_v_upper - old_v_lower);
-          adjusted_y = self->canvas_y * ratio_y - self->pointer_y;
-          gtk_adjustment_set_value (self->vadjustment, adjusted_y);
+          finish_render_job (editor);
+          gtk_widget_queue_draw (editor->map_layer);
         }
-
-      self->queue_center = FALSE;
     }
-  else
+
+  release_render_job (job);
+}
+
+static void
+clear_render_stroke (gpointer data)
+{
+  RenderStroke *self = data;
+
+  g_clear_object (&self->texture);
+  g_clear_pointer (&self->label_node, gsk_render_node_unref);
+}
+
+static void
+clear_render_job (gpointer data)
+{
+  RenderJob *self = data;
+
+  for (guint i = 0; i < self->n_regions; i++)
     {
-      g_object_set (
-          self->hadjustment,
-          "lower", 0.0,
-          "upper", 0.0,
-          NULL);
-      g_object_set (
-          self->vadjustment,
-          "lower", 0.0,
-          "upper", 0.0,
-          NULL);
+      g_clear_pointer (&self->regions[i].instances, g_array_unref);
+      for (guint j = 0; j < N_RENDER_LAYERS; j++)
+        g_clear_pointer (&self->regions[i].layers[j], gsk_render_node_unref);
     }
+  g_clear_pointer (&self->regions, g_free);
+  g_clear_pointer (&self->input.strokes, g_array_unref);
 }
 
 static void
-update_motion (GcvMapEditor *self,
-               double        x,
-               double        y)
+release_render_job (gpointer data)
 {
-  double hscroll         = 0.0;
-  double vscroll         = 0.0;
-  double map_offset      = 0.0;
-  int    new_hover_x     = 0;
-  int    new_hover_y     = 0;
-  int    map_tile_width  = 0;
-  int    map_tile_height = 0;
-  // gboolean was_invalid     = FALSE;
-  gboolean is_invalid = FALSE;
-  gboolean x_changed  = FALSE;
-  gboolean y_changed  = FALSE;
-  gboolean redraw     = FALSE;
+  g_atomic_rc_box_release_full (data, clear_render_job);
+}
 
-  self->pointer_x = x;
-  self->pointer_y = y;
+static void
+destroy_render_task_data (gpointer data)
+{
+  RenderTaskData *self = data;
 
-  if (gtk_gesture_is_recognized (self->drag_gesture))
-    return;
+  release_render_job (self->job);
+  g_free (self);
+}
 
-  hscroll        = gtk_adjustment_get_value (self->hadjustment);
-  vscroll        = gtk_adjustment_get_value (self->vadjustment);
-  self->canvas_x = x + hscroll;
-  self->canvas_y = y + vscroll;
-  map_offset     = (double) self->border_gap * BASE_TILE_SIZE * self->zoom;
-  new_hover_x    = floor ((self->canvas_x - map_offset) / (BASE_TILE_SIZE * self->zoom));
-  new_hover_y    = floor ((self->canvas_y - map_offset) / (BASE_TILE_SIZE * self->zoom));
+GdkTexture *
+gcv_map_editor_get_overview (GcvMapEditor *self)
+{
+  int map_tile_width  = 0;
+  int map_tile_height = 0;
+
+  g_return_val_if_fail (GCV_IS_MAP_EDITOR (self), NULL);
+
+  if (self->handle == NULL || self->map == NULL)
+    return NULL;
 
   g_object_get (
       self->map,
       "width", &map_tile_width,
       "height", &map_tile_height,
       NULL);
+  update_lod_texture (self, map_tile_width, map_tile_height);
 
-  // was_invalid = self->hover_x < 0 || self->hover_y < 0;
-  is_invalid = new_hover_x < 0 || new_hover_y < 0 ||
-               new_hover_x >= map_tile_width || new_hover_y >= map_tile_height;
-
-  x_changed = new_hover_x != self->real_hover_x;
-  y_changed = new_hover_y != self->real_hover_y;
-  redraw    = x_changed || y_changed;
-
-  self->real_hover_x = new_hover_x;
-  self->real_hover_y = new_hover_y;
-
-  if (is_invalid)
-    new_hover_x = new_hover_y = -1;
-  self->hover_x = new_hover_x;
-  self->hover_y = new_hover_y;
-
-  if (x_changed)
-    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_HOVER_X]);
-  if (y_changed)
-    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_HOVER_Y]);
-  if (redraw)
-    gtk_widget_queue_draw (GTK_WIDGET (self));
+  return self->lod_tex;
 }
 
-static void
-read_brush (GcvMapEditor *self,
-            gboolean      different)
+void
+gcv_map_editor_copy_cursor (GcvMapEditor *self)
 {
-  g_autoptr (GcvBrushable) brush     = NULL;
-  int                mask_width      = 0;
-  int                mask_height     = 0;
-  g_autofree guint8 *mask            = NULL;
-  g_autoptr (GtkSnapshot) snapshot   = NULL;
-  g_autoptr (GskPathBuilder) builder = NULL;
-  g_autoptr (GskPath) path           = NULL;
-  g_autoptr (GskStroke) stroke       = NULL;
-
-  g_clear_pointer (&self->brush_mask, g_free);
-  g_clear_pointer (&self->brush_node, gsk_render_node_unref);
-
-  if (different)
-    {
-      if (self->brush_adjustment != NULL)
-        g_signal_handlers_disconnect_by_func (
-            self->brush_adjustment, selected_brush_adjustment_value_changed, self);
-      g_clear_object (&self->brush_adjustment);
-    }
+  guint cursor                   = 0;
+  guint cursor_len               = 0;
+  g_autoptr (GListStore) strokes = NULL;
+  guint n_strokes                = 0;
+  int   min_x                    = G_MAXINT;
+  int   min_y                    = G_MAXINT;
+  g_autoptr (GListStore) stamp   = NULL;
 
-  if (self->hover_x >= 0 && self->hover_y >= 0)
-    gtk_widget_queue_draw (GTK_WIDGET (self));
+  g_return_if_fail (GCV_IS_MAP_EDITOR (self));
 
-  if (self->brush_area == NULL)
+  if (self->handle == NULL)
     return;
 
   g_object_get (
-      self->brush_area,
-      "selected-brush", &brush,
+      self->handle,
+      "cursor", &cursor,
+      "cursor-len", &cursor_len,
+      "model", &strokes,
       NULL);
-  if (brush == NULL)
-    return;
 
-  mask = gcv_brushable_get_mask (brush, &mask_width, &mask_height);
-  g_assert (mask != NULL);
+  n_strokes = g_list_model_get_n_items (G_LIST_MODEL (strokes));
+  if (cursor >= n_strokes)
+    return;
+  cursor_len = MIN (MAX (cursor_len, 1), n_strokes - cursor);
 
-  snapshot = gtk_snapshot_new ();
-  builder  = gsk_path_builder_new ();
-  for (int y = 0; y < mask_height; y++)
+  for (guint i = cursor; i < cursor + cursor_len; i++)
     {
-      for (int x = 0; x < mask_width; x++)
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GArray) instances     = NULL;
+
+      stroke = g_list_model_get_item (G_LIST_MODEL (strokes), i);
+      g_object_get (
+          stroke,
+          "instances", &instances,
+          NULL);
+
+      for (guint j = 0; j < instances->len; j++)
         {
-          if (mask[y * mask_width + x] != 0)
-            {
-              if (x == 0 || mask[y * mask_width + (x - 1)] == 0)
-                {
-                  gsk_path_builder_move_to (builder, (float) x, (float) y);
-                  gsk_path_builder_rel_line_to (builder, 0.0, 1.0);
-                }
-              if (y == 0 || mask[(y - 1) * mask_width + x] == 0)
-                {
-                  gsk_path_builder_move_to (builder, (float) x, (float) y);
-                  gsk_path_builder_rel_line_to (builder, 1.0, 0.0);
-                }
-              if (x == mask_width - 1)
-                {
-                  gsk_path_builder_move_to (builder, (float) x + 1.0, (float) y + 1.0);
-                  gsk_path_builder_rel_line_to (builder, 0.0, -1.0);
-                }
-              if (y == mask_height - 1)
-                {
-                  gsk_path_builder_move_to (builder, (float) x + 1.0, (float) y + 1.0);
-                  gsk_path_builder_rel_line_to (builder, -1.0, 0.0);
-                }
-            }
-          else
-            {
-              if (x > 0 && mask[y * mask_width + (x - 1)] != 0)
-                {
-                  gsk_path_builder_move_to (builder, (float) x, (float) y);
-                  gsk_path_builder_rel_line_to (builder, 0.0, 1.0);
-                }
-              if (y > 0 && mask[(y - 1) * mask_width + x] != 0)
-                {
-                  gsk_path_builder_move_to (builder, (float) x, (float) y);
-                  gsk_path_builder_rel_line_to (builder, 1.0, 0.0);
-                }
-            }
+          min_x = MIN (min_x, g_array_index (instances, GcvItemStrokeInstance, j).x);
+          min_y = MIN (min_y, g_array_index (instances, GcvItemStrokeInstance, j).y);
         }
     }
-  path = gsk_path_builder_free_to_path (g_steal_pointer (&builder));
-
-  stroke = gsk_stroke_new (0.15);
-  gsk_stroke_set_line_cap (stroke, GSK_LINE_CAP_SQUARE);
-
-  gtk_snapshot_append_stroke (
-      snapshot, path, stroke,
-      self->dark_theme
-          ? &(const GdkRGBA) { 1.0, 1.0, 1.0, 1.0 }
-          : &(const GdkRGBA) { 0.0, 0.0, 0.0, 1.0 });
-
-  self->brush_mask   = g_steal_pointer (&mask);
-  self->brush_width  = mask_width;
-  self->brush_height = mask_height;
-  self->brush_node   = gtk_snapshot_free_to_node (g_steal_pointer (&snapshot));
+  if (min_x == G_MAXINT)
+    return;
 
-  if (different)
+  /* Positions are kept relative to the top left of the selection */
+  stamp = g_list_store_new (GCV_TYPE_ITEM_STROKE);
+  for (guint i = cursor; i < cursor + cursor_len; i++)
     {
-      self->brush_adjustment = gcv_brushable_get_adjustment (brush);
-      if (self->brush_adjustment != NULL)
-        g_signal_connect (self->brush_adjustment, "value-changed",
-                          G_CALLBACK (selected_brush_adjustment_value_changed), self);
-    }
-}
-
-static void
-read_background_image (GcvMapEditor *self)
-{
-  g_autofree char *path = NULL;
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GcvItem) item         = NULL;
+      g_autoptr (GArray) instances     = NULL;
+      g_autoptr (GArray) relative      = NULL;
+      g_autoptr (GcvItemStroke) copy   = NULL;
 
-  g_clear_object (&self->bg_image_tex);
-  gtk_widget_queue_draw (GTK_WIDGET (self));
+      stroke = g_list_model_get_item (G_LIST_MODEL (strokes), i);
+      g_object_get (
+          stroke,
+          "item", &item,
+          "instances", &instances,
+          NULL);
 
-  path = g_settings_get_string (self->settings, "background-image");
+      relative = g_array_sized_new (FALSE, FALSE, sizeof (GcvItemStrokeInstance), instances->len);
+      for (guint j = 0; j < instances->len; j++)
+        {
+          GcvItemStrokeInstance instance = { 0 };
 
-  if (path[0] != '\0')
-    {
-      g_autoptr (GTask) task = NULL;
+          instance = g_array_index (instances, GcvItemStrokeInstance, j);
+          instance.x -= min_x;
+          instance.y -= min_y;
+          g_array_append_val (relative, instance);
+        }
 
-      task = g_task_new (self, NULL, background_texture_load_finish_cb, NULL);
-      g_task_set_task_data (task, g_steal_pointer (&path), g_free);
-      g_task_set_priority (task, G_PRIORITY_HIGH);
-      g_task_set_check_cancellable (task, TRUE);
-      g_task_run_in_thread (task, background_texture_load_async_thread);
+      copy = g_object_new (
+          GCV_TYPE_ITEM_STROKE,
+          "item", item,
+          NULL);
+      gcv_item_stroke_add_instances (
+          copy,
+          (const GcvItemStrokeInstance *) (gpointer) relative->data,
+          relative->len);
+      g_list_store_append (stamp, copy);
     }
+
+  set_stamp (self, G_LIST_MODEL (stamp));
+  set_tool (self, GCV_MAP_EDITOR_TOOL_STAMP);
 }
 
-static void
-background_texture_load_async_thread (GTask        *task,
-                                      gpointer      object,
-                                      gpointer      task_data,
-                                      GCancellable *cancellable)
+gboolean
+gcv_map_editor_get_visible_area (GcvMapEditor    *self,
+                                 graphene_rect_t *area)
 {
-  const char *path               = task_data;
-  g_autoptr (GError) local_error = NULL;
-  g_autoptr (GdkTexture) texture = NULL;
+  double tile_size = 0.0;
 
-  if (g_task_return_error_if_cancelled (task))
-    return;
+  g_return_val_if_fail (GCV_IS_MAP_EDITOR (self), FALSE);
+  g_return_val_if_fail (area != NULL, FALSE);
 
-  texture = gdk_texture_new_from_filename (path, &local_error);
-  if (texture == NULL)
-    {
-      g_task_return_error (task, g_steal_pointer (&local_error));
-      return;
-    }
+  if (self->hadjustment == NULL || self->vadjustment == NULL)
+    return FALSE;
 
-  g_task_return_pointer (task, g_steal_pointer (&texture), g_object_unref);
+  tile_size = BASE_TILE_SIZE * self->zoom;
+  *area     = GRAPHENE_RECT_INIT (
+      gtk_adjustment_get_value (self->hadjustment) / tile_size - (double) self->border_gap,
+      gtk_adjustment_get_value (self->vadjustment) / tile_size - (double) self->border_gap,
+      gtk_adjustment_get_page_size (self->hadjustment) / tile_size,
+      gtk_adjustment_get_page_size (self->vadjustment) / tile_size);
+
+  return TRUE;
 }
 
-static void
-background_texture_load_finish_cb (GObject      *source_object,
-                                   GAsyncResult *res,
-                                   gpointer      data)
+void
+gcv_map_editor_scroll_to (GcvMapEditor *self,
+                          double        tile_x,
+                          double        tile_y)
 {
-  GcvMapEditor *editor           = GCV_MAP_EDITOR (source_object);
-  g_autoptr (GError) local_error = NULL;
-  GdkTexture *texture            = NULL;
+  double tile_size = 0.0;
 
-  texture = g_task_propagate_pointer (G_TASK (res), &local_error);
-
-  if (texture == NULL)
-    {
-      gcv_dialog_for_widget (
-          "Error",
-          "Could not load background image",
-          local_error->message,
-          FALSE, GTK_WIDGET (editor), NULL);
+  g_return_if_fail (GCV_IS_MAP_EDITOR (self));
 
-      if (editor->settings != NULL)
-        g_settings_set_string (editor->settings, "background-image", "");
-    }
+  if (self->hadjustment == NULL || self->vadjustment == NULL)
+    return;
 
-  g_clear_object (&editor->bg_image_tex);
-  editor->bg_image_tex = texture;
-  gtk_widget_queue_draw (GTK_WIDGET (editor));
+  tile_size = BASE_TILE_SIZE * self->zoom;
+  gtk_adjustment_set_value (
+      self->hadjustment,
+      (tile_x + (double) self->border_gap) * tile_size -
+          gtk_adjustment_get_page_size (self->hadjustment) / 2.0);
+  gtk_adjustment_set_value (
+      self->vadjustment,
+      (tile_y + (double) self->border_gap) * tile_size -
+          gtk_adjustment_get_page_size (self->vadjustment) / 2.0);
 }
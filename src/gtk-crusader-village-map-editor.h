@@ -28,4 +28,45 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (GcvMapEditor, gcv_map_editor, GCV, MAP_EDITOR, GtkWidget)
 
+typedef enum
+{
+  GCV_MAP_EDITOR_TOOL_PENCIL,
+  GCV_MAP_EDITOR_TOOL_LINE,
+  GCV_MAP_EDITOR_TOOL_FILL,
+  GCV_MAP_EDITOR_TOOL_RECTANGLE,
+  GCV_MAP_EDITOR_TOOL_RECTANGLE_OUTLINE,
+  GCV_MAP_EDITOR_TOOL_ELLIPSE,
+  GCV_MAP_EDITOR_TOOL_STAMP,
+} GcvMapEditorTool;
+
+GType gcv_map_editor_tool_get_type (void);
+#define GCV_TYPE_MAP_EDITOR_TOOL (gcv_map_editor_tool_get_type ())
+
+typedef enum
+{
+  GCV_MAP_EDITOR_SYMMETRY_NONE,
+  GCV_MAP_EDITOR_SYMMETRY_HORIZONTAL,
+  GCV_MAP_EDITOR_SYMMETRY_VERTICAL,
+  GCV_MAP_EDITOR_SYMMETRY_FOUR_WAY,
+  GCV_MAP_EDITOR_SYMMETRY_ROTATIONAL,
+} GcvMapEditorSymmetry;
+
+GType gcv_map_editor_symmetry_get_type (void);
+#define GCV_TYPE_MAP_EDITOR_SYMMETRY (gcv_map_editor_symmetry_get_type ())
+
+GdkTexture *
+gcv_map_editor_get_overview (GcvMapEditor *self);
+
+void
+gcv_map_editor_copy_cursor (GcvMapEditor *self);
+
+gboolean
+gcv_map_editor_get_visible_area (GcvMapEditor    *self,
+                                 graphene_rect_t *area);
+
+void
+gcv_map_editor_scroll_to (GcvMapEditor *self,
+                          double        tile_x,
+                          double        tile_y);
+
 G_END_DECLS
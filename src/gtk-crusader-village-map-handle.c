@@ -26,18 +26,20 @@
 #include "gtk-crusader-village-item.h"
 #include "gtk-crusader-village-map-handle.h"
 #include "gtk-crusader-village-map.h"
+#include "gtk-crusader-village-stats.h"
 
-enum
-{
-  ACTION_REMOVED,
-  ACTION_ADDED,
-};
+/* One plane per item kind, then one for any kind */
+#define OCCUPIED_PLANE (GCV_ITEM_KIND_MOAT + 1)
+#define N_PLANES       (OCCUPIED_PLANE + 1)
 
+/* One splice of the stroke list, undone by swapping
+ * `added` back out for `removed`
+ */
 typedef struct
 {
-  int        type;
   guint      position;
-  GPtrArray *pa;
+  GPtrArray *removed;
+  GPtrArray *added;
 } Action;
 
 typedef struct
@@ -69,6 +71,10 @@ struct _GcvMapHandle
 
   GHashTable *cache;
   guint       last_append_position;
+
+  guint64 *planes;
+  guint    plane_stride;
+  int      plane_height;
 };
 
 G_DEFINE_FINAL_TYPE (GcvMapHandle, gcv_map_handle, G_TYPE_OBJECT)
@@ -105,6 +111,9 @@ dimensions_changed (GcvMap       *map,
 static void
 ensure_cache (GcvMapHandle *self);
 
+static void
+clear_cache (GcvMapHandle *self);
+
 static void
 add_stroke_to_cache (GcvMapHandle  *self,
                      GcvItemStroke *stroke,
@@ -113,10 +122,21 @@ add_stroke_to_cache (GcvMapHandle  *self,
                      int            map_height,
                      gboolean       use_path_find_item);
 
+static inline void
+set_plane_bit (GcvMapHandle *self,
+               GcvItemKind   kind,
+               int           x,
+               int           y);
+
 static inline Action *
-new_action (int        type,
-            guint      position,
-            GPtrArray *pa);
+new_action (guint      position,
+            GPtrArray *removed,
+            GPtrArray *added);
+
+static void
+apply_action (GcvMapHandle *self,
+              Action       *action,
+              gboolean      undo);
 
 static void
 destroy_action (gpointer ptr);
@@ -150,7 +170,7 @@ gcv_map_handle_dispose (GObject *object)
 
   g_clear_pointer (&self->memory, g_ptr_array_unref);
   g_clear_object (&self->mirror);
-  g_clear_pointer (&self->cache, g_hash_table_unref);
+  clear_cache (self);
 
   G_OBJECT_CLASS (gcv_map_handle_parent_class)->dispose (object);
 }
@@ -209,7 +229,7 @@ gcv_map_handle_set_property (GObject      *object,
           g_signal_handlers_disconnect_by_func (self->map, dimensions_changed, self);
         g_clear_object (&self->strokes);
         g_ptr_array_set_size (self->memory, 0);
-        g_clear_pointer (&self->cache, g_hash_table_unref);
+        clear_cache (self);
 
         self->map = g_value_dup_object (value);
 
@@ -382,53 +402,37 @@ strokes_changed (GListModel   *self,
                  guint         added,
                  GcvMapHandle *handle)
 {
-  g_autofree GcvItemStroke **additions = NULL;
-  guint                      n_items   = 0;
+  g_autoptr (GPtrArray) removals  = NULL;
+  g_autoptr (GPtrArray) additions = NULL;
+  guint n_items                   = 0;
 
   g_ptr_array_set_size (handle->memory, handle->n_undos);
 
-  if (removed > 0)
-    {
-      g_autofree GcvItemStroke **removals = NULL;
-
-      removals = g_malloc0_n (removed, sizeof (*removals));
-      for (guint i = 0; i < removed; i++)
-        removals[i] = g_list_model_get_item (G_LIST_MODEL (handle->mirror), position + i);
-
-      g_ptr_array_add (
-          handle->memory,
-          new_action (
-              ACTION_REMOVED, position,
-              g_ptr_array_new_take (
-                  (gpointer *) g_steal_pointer (&removals),
-                  removed, g_object_unref)));
-    }
+  removals = g_ptr_array_new_full (removed, g_object_unref);
+  for (guint i = 0; i < removed; i++)
+    g_ptr_array_add (removals, g_list_model_get_item (G_LIST_MODEL (handle->mirror), position + i));
 
-  if (added > 0)
-    {
-      additions = g_malloc0_n (added, sizeof (*additions));
-      for (guint i = 0; i < added; i++)
-        additions[i] = g_list_model_get_item (G_LIST_MODEL (handle->strokes), position + i);
-    }
+  additions = g_ptr_array_new_full (added, g_object_unref);
+  for (guint i = 0; i < added; i++)
+    g_ptr_array_add (additions, g_list_model_get_item (G_LIST_MODEL (handle->strokes), position + i));
 
   g_list_store_splice (handle->mirror, position, removed,
-                       (gpointer *) additions, added);
+                       additions->pdata, added);
 
-  if (added > 0)
-    g_ptr_array_add (
-        handle->memory,
-        new_action (
-            ACTION_ADDED, position,
-            g_ptr_array_new_take (
-                (gpointer *) g_steal_pointer (&additions),
-                added, g_object_unref)));
+  /* A replacement is a single undo step */
+  g_ptr_array_add (
+      handle->memory,
+      new_action (
+          position,
+          g_steal_pointer (&removals),
+          g_steal_pointer (&additions)));
 
   handle->n_undos++;
 
   n_items = g_list_model_get_n_items (G_LIST_MODEL (handle->strokes));
   if (removed > 0 || position < n_items - added)
     /* We need to completely regenerate cache */
-    g_clear_pointer (&handle->cache, g_hash_table_unref);
+    clear_cache (handle);
   else
     /* It was just an append, no need to regenerate */
     handle->last_append_position = MIN (position, handle->last_append_position);
@@ -441,7 +445,7 @@ dimensions_changed (GcvMap       *map,
                     GParamSpec   *pspec,
                     GcvMapHandle *handle)
 {
-  g_clear_pointer (&handle->cache, g_hash_table_unref);
+  clear_cache (handle);
   g_object_notify_by_pspec (G_OBJECT (handle), props[PROP_GRID]);
 }
 
@@ -454,39 +458,9 @@ gcv_map_handle_undo (GcvMapHandle *self)
   g_return_if_fail (self->map != NULL);
   g_return_if_fail (self->n_undos > 0);
 
-  action = g_ptr_array_index (self->memory, self->n_undos - 1);
-
-  g_signal_handlers_block_by_func (self->strokes, strokes_changed, self);
-
-  switch (action->type)
-    {
-    case ACTION_REMOVED:
-      g_list_store_splice (self->strokes, action->position, 0,
-                           action->pa->pdata, action->pa->len);
-      g_list_store_splice (self->mirror, action->position, 0,
-                           action->pa->pdata, action->pa->len);
-      self->cursor_len = action->pa->len;
-      break;
-    case ACTION_ADDED:
-      g_list_store_splice (self->strokes, action->position,
-                           action->pa->len, NULL, 0);
-      g_list_store_splice (self->mirror, action->position,
-                           action->pa->len, NULL, 0);
-      self->cursor_len = 1;
-      break;
-    default:
-      g_assert_not_reached ();
-    }
-
-  g_signal_handlers_unblock_by_func (self->strokes, strokes_changed, self);
-
   self->n_undos--;
-  self->cursor = action->position;
-  g_clear_pointer (&self->cache, g_hash_table_unref);
-
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_GRID]);
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURSOR]);
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURSOR_LEN]);
+  action = g_ptr_array_index (self->memory, self->n_undos);
+  apply_action (self, action, TRUE);
 }
 
 void
@@ -499,38 +473,8 @@ gcv_map_handle_redo (GcvMapHandle *self)
   g_return_if_fail (self->n_undos < self->memory->len);
 
   action = g_ptr_array_index (self->memory, self->n_undos);
-
-  g_signal_handlers_block_by_func (self->strokes, strokes_changed, self);
-
-  switch (action->type)
-    {
-    case ACTION_REMOVED:
-      g_list_store_splice (self->strokes, action->position,
-                           action->pa->len, NULL, 0);
-      g_list_store_splice (self->mirror, action->position,
-                           action->pa->len, NULL, 0);
-      self->cursor_len = 1;
-      break;
-    case ACTION_ADDED:
-      g_list_store_splice (self->strokes, action->position, 0,
-                           action->pa->pdata, action->pa->len);
-      g_list_store_splice (self->mirror, action->position, 0,
-                           action->pa->pdata, action->pa->len);
-      self->cursor_len = action->pa->len;
-      break;
-    default:
-      g_assert_not_reached ();
-    }
-
-  g_signal_handlers_unblock_by_func (self->strokes, strokes_changed, self);
-
   self->n_undos++;
-  self->cursor = action->position;
-  g_clear_pointer (&self->cache, g_hash_table_unref);
-
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_GRID]);
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURSOR]);
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURSOR_LEN]);
+  apply_action (self, action, FALSE);
 }
 
 gboolean
@@ -575,10 +519,13 @@ gcv_map_handle_get_accessibilty_mask (GcvMapHandle *self)
   g_autoptr (GHashTable) snap = NULL;
   g_autoptr (GArray) stack    = NULL;
   g_autofree guint8 *mask     = NULL;
+  gint64 begin_time           = 0;
 
   g_return_val_if_fail (GCV_IS_MAP_HANDLE (self), NULL);
   g_return_val_if_fail (self->map != NULL, NULL);
 
+  begin_time = g_get_monotonic_time ();
+
   total = g_list_model_get_n_items (G_LIST_MODEL (self->strokes));
   g_object_get (
       self->map,
@@ -671,9 +618,41 @@ gcv_map_handle_get_accessibilty_mask (GcvMapHandle *self)
         }
     }
 
+  gcv_stats_record_time ("handle.accessibility-fill", begin_time);
+
   return g_steal_pointer (&mask);
 }
 
+const guint64 *
+gcv_map_handle_get_kind_plane (GcvMapHandle *self,
+                               GcvItemKind   kind,
+                               guint        *stride)
+{
+  g_return_val_if_fail (GCV_IS_MAP_HANDLE (self), NULL);
+  g_return_val_if_fail (self->map != NULL, NULL);
+  g_return_val_if_fail ((guint) kind < OCCUPIED_PLANE, NULL);
+
+  ensure_cache (self);
+
+  if (stride != NULL)
+    *stride = self->plane_stride;
+  return self->planes + (gsize) kind * self->plane_height * self->plane_stride;
+}
+
+const guint64 *
+gcv_map_handle_get_occupied_plane (GcvMapHandle *self,
+                                   guint        *stride)
+{
+  g_return_val_if_fail (GCV_IS_MAP_HANDLE (self), NULL);
+  g_return_val_if_fail (self->map != NULL, NULL);
+
+  ensure_cache (self);
+
+  if (stride != NULL)
+    *stride = self->plane_stride;
+  return self->planes + (gsize) OCCUPIED_PLANE * self->plane_height * self->plane_stride;
+}
+
 void
 gcv_map_handle_reorder (GcvMapHandle *self,
                         guint         position,
@@ -708,16 +687,98 @@ gcv_map_handle_reorder (GcvMapHandle *self,
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURSOR_LEN]);
 }
 
+/* The cursor range is compacted on its own so the same
+ * strokes stay drawn and highlighted. Everything lands
+ * in one splice and therefore one undo step.
+ */
+guint
+gcv_map_handle_compact (GcvMapHandle *self)
+{
+  GListModel *model               = NULL;
+  guint       n_strokes           = 0;
+  guint       cursor              = 0;
+  guint       cursor_end          = 0;
+  g_autoptr (GPtrArray) compacted = NULL;
+  g_autoptr (GPtrArray) range     = NULL;
+  g_autoptr (GPtrArray) after     = NULL;
+  guint  new_cursor               = 0;
+  guint  new_cursor_len           = 0;
+  guint  head                     = 0;
+  guint  tail                     = 0;
+  gint64 begin_time               = 0;
+
+  g_return_val_if_fail (GCV_IS_MAP_HANDLE (self), 0);
+  g_return_val_if_fail (self->map != NULL, 0);
+
+  begin_time = g_get_monotonic_time ();
+
+  model      = G_LIST_MODEL (self->strokes);
+  n_strokes  = g_list_model_get_n_items (model);
+  cursor     = MIN (self->cursor, n_strokes);
+  cursor_end = MIN (self->cursor + self->cursor_len, n_strokes);
+
+  compacted = gcv_item_stroke_compact (model, 0, cursor);
+  range     = gcv_item_stroke_compact (model, cursor, cursor_end - cursor);
+  after     = gcv_item_stroke_compact (model, cursor_end, n_strokes - cursor_end);
+
+  new_cursor     = compacted->len;
+  new_cursor_len = MAX (range->len, 1);
+
+  g_ptr_array_extend_and_steal (compacted, g_steal_pointer (&range));
+  g_ptr_array_extend_and_steal (compacted, g_steal_pointer (&after));
+
+  if (compacted->len == n_strokes)
+    return 0;
+
+  /* Leave the untouched ends of the timeline alone */
+  for (; head < compacted->len; head++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+
+      stroke = g_list_model_get_item (model, head);
+      if (stroke != g_ptr_array_index (compacted, head))
+        break;
+    }
+  for (; tail < compacted->len - head; tail++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+
+      stroke = g_list_model_get_item (model, n_strokes - tail - 1);
+      if (stroke != g_ptr_array_index (compacted, compacted->len - tail - 1))
+        break;
+    }
+
+  g_list_store_splice (
+      self->strokes, head, n_strokes - head - tail,
+      compacted->pdata + head, compacted->len - head - tail);
+
+  self->cursor     = new_cursor;
+  self->cursor_len = new_cursor_len;
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURSOR]);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURSOR_LEN]);
+
+  gcv_stats_add_count ("handle.compact.removed", n_strokes - compacted->len);
+  gcv_stats_record_time ("handle.compact", begin_time);
+
+  return n_strokes - compacted->len;
+}
+
 static void
 ensure_cache (GcvMapHandle *self)
 {
-  guint start_stroke_idx = 0;
-  guint total            = 0;
-  int   map_width        = 0;
-  int   map_height       = 0;
+  guint  start_stroke_idx = 0;
+  guint  total            = 0;
+  int    map_width        = 0;
+  int    map_height       = 0;
+  gint64 begin_time       = 0;
 
   if (self->cache != NULL && self->last_append_position == G_MAXUINT)
-    return;
+    {
+      gcv_stats_add_count ("handle.grid-cache.hit", 1);
+      return;
+    }
+
+  begin_time = g_get_monotonic_time ();
 
   if (self->cache == NULL)
     {
@@ -725,9 +786,13 @@ ensure_cache (GcvMapHandle *self)
           /* |------ key: tile index -------|  | val:  Item | */
           g_direct_hash, g_direct_equal, NULL, g_object_unref);
       start_stroke_idx = 0;
+      gcv_stats_add_count ("handle.grid-cache.miss", 1);
     }
   else
-    start_stroke_idx = self->last_append_position;
+    {
+      start_stroke_idx = self->last_append_position;
+      gcv_stats_add_count ("handle.grid-cache.append", 1);
+    }
 
   total = g_list_model_get_n_items (G_LIST_MODEL (self->strokes));
   g_object_get (
@@ -736,6 +801,13 @@ ensure_cache (GcvMapHandle *self)
       "height", &map_height,
       NULL);
 
+  if (self->planes == NULL)
+    {
+      self->plane_stride = (MAX (map_width, 0) + 63) / 64;
+      self->plane_height = MAX (map_height, 0);
+      self->planes       = g_new0 (guint64, (gsize) N_PLANES * self->plane_stride * self->plane_height);
+    }
+
   for (guint i = start_stroke_idx; i < total; i++)
     add_stroke_to_cache (
         self,
@@ -743,6 +815,15 @@ ensure_cache (GcvMapHandle *self)
         self->cache, map_width, map_height, FALSE);
 
   self->last_append_position = G_MAXUINT;
+
+  gcv_stats_record_time ("handle.grid-cache.rebuild", begin_time);
+}
+
+static void
+clear_cache (GcvMapHandle *self)
+{
+  g_clear_pointer (&self->cache, g_hash_table_unref);
+  g_clear_pointer (&self->planes, g_free);
 }
 
 static void
@@ -753,40 +834,36 @@ add_stroke_to_cache (GcvMapHandle  *self,
                      int            map_height,
                      gboolean       use_path_find_item)
 {
-  g_autoptr (GcvItem) item     = NULL;
-  GcvItemKind item_kind        = GCV_ITEM_KIND_BUILDING;
-  int         item_tile_width  = 0;
-  int         item_tile_height = 0;
-  int         impassable_x     = 0;
-  int         impassable_y     = 0;
-  int         impassable_w     = 0;
-  int         impassable_h     = 0;
-  g_autoptr (GArray) instances = NULL;
+  g_autoptr (GcvItem) item            = NULL;
+  const GcvItemInfo *info             = NULL;
+  GcvItemKind        item_kind        = GCV_ITEM_KIND_BUILDING;
+  int                item_tile_width  = 0;
+  int                item_tile_height = 0;
+  int                impassable_x     = 0;
+  int                impassable_y     = 0;
+  int                impassable_w     = 0;
+  int                impassable_h     = 0;
+  g_autoptr (GArray) instances        = NULL;
 
   g_object_get (
       stroke,
       "item", &item,
       NULL);
 
-  g_object_get (
-      item,
-      "kind", &item_kind,
-      NULL);
+  info      = gcv_item_get_info (item);
+  item_kind = info->kind;
 
   /* TODO make a unit layer */
   if (item_kind == GCV_ITEM_KIND_UNIT)
     /* Ignore units for now */
     return;
 
-  g_object_get (
-      item,
-      "tile-width", &item_tile_width,
-      "tile-height", &item_tile_height,
-      "tile-impassable-rect-x", &impassable_x,
-      "tile-impassable-rect-y", &impassable_y,
-      "tile-impassable-rect-w", &impassable_w,
-      "tile-impassable-rect-h", &impassable_h,
-      NULL);
+  item_tile_width  = info->tile_width;
+  item_tile_height = info->tile_height;
+  impassable_x     = info->tile_impassable_rect_x;
+  impassable_y     = info->tile_impassable_rect_y;
+  impassable_w     = info->tile_impassable_rect_w;
+  impassable_h     = info->tile_impassable_rect_h;
   g_assert (item_tile_width > 0 && item_tile_height > 0);
 
   if (use_path_find_item &&
@@ -804,10 +881,13 @@ add_stroke_to_cache (GcvMapHandle  *self,
       PathFindItem         *path_find_item = NULL;
 
       instance = g_array_index (instances, GcvItemStrokeInstance, i);
-      g_assert (instance.x >= 0 &&
-                instance.y >= 0 &&
-                instance.x + item_tile_width <= map_width &&
-                instance.y + item_tile_height <= map_height);
+
+      /* Reported by the validator */
+      if (instance.x < 0 ||
+          instance.y < 0 ||
+          instance.x + item_tile_width > map_width ||
+          instance.y + item_tile_height > map_height)
+        continue;
 
       if (use_path_find_item)
         path_find_item = new_path_find_item (
@@ -829,6 +909,9 @@ add_stroke_to_cache (GcvMapHandle  *self,
                                     use_path_find_item
                                         ? (gpointer) ref_path_find_item (path_find_item)
                                         : (gpointer) g_object_ref (item));
+
+              if (cache == self->cache && self->planes != NULL)
+                set_plane_bit (self, item_kind, instance.x + x, instance.y + y);
             }
         }
 
@@ -837,27 +920,74 @@ add_stroke_to_cache (GcvMapHandle  *self,
     }
 }
 
+static inline void
+set_plane_bit (GcvMapHandle *self,
+               GcvItemKind   kind,
+               int           x,
+               int           y)
+{
+  gsize   plane_size = 0;
+  gsize   word       = 0;
+  guint64 bit        = 0;
+
+  plane_size = (gsize) self->plane_height * self->plane_stride;
+  word       = (gsize) y * self->plane_stride + x / 64;
+  bit        = G_GUINT64_CONSTANT (1) << (x % 64);
+
+  /* The newest stroke owns the tile, like in the grid */
+  for (int plane = 0; plane < OCCUPIED_PLANE; plane++)
+    self->planes[plane * plane_size + word] &= ~bit;
+  self->planes[kind * plane_size + word] |= bit;
+  self->planes[OCCUPIED_PLANE * plane_size + word] |= bit;
+}
+
 static inline Action *
-new_action (int        type,
-            guint      position,
-            GPtrArray *pa)
+new_action (guint      position,
+            GPtrArray *removed,
+            GPtrArray *added)
 {
   Action *action = NULL;
 
   action           = g_new0 (typeof (*action), 1);
-  action->type     = type;
   action->position = position;
-  action->pa       = pa;
+  action->removed  = removed;
+  action->added    = added;
 
   return action;
 }
 
+static void
+apply_action (GcvMapHandle *self,
+              Action       *action,
+              gboolean      undo)
+{
+  GPtrArray *from = NULL;
+  GPtrArray *to   = NULL;
+
+  from = undo ? action->added : action->removed;
+  to   = undo ? action->removed : action->added;
+
+  g_signal_handlers_block_by_func (self->strokes, strokes_changed, self);
+  g_list_store_splice (self->strokes, action->position, from->len, to->pdata, to->len);
+  g_list_store_splice (self->mirror, action->position, from->len, to->pdata, to->len);
+  g_signal_handlers_unblock_by_func (self->strokes, strokes_changed, self);
+
+  self->cursor     = action->position;
+  self->cursor_len = MAX (to->len, 1);
+  clear_cache (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_GRID]);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURSOR]);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURSOR_LEN]);
+}
+
 static void
 destroy_action (gpointer ptr)
 {
   Action *self = ptr;
 
-  g_ptr_array_unref (self->pa);
+  g_ptr_array_unref (self->removed);
+  g_ptr_array_unref (self->added);
   g_free (self);
 }
 
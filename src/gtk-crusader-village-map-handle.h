@@ -22,6 +22,8 @@
 
 #include <glib-object.h>
 
+#include "gtk-crusader-village-item.h"
+
 G_BEGIN_DECLS
 
 #define GCV_TYPE_MAP_HANDLE (gcv_map_handle_get_type ())
@@ -46,10 +48,26 @@ gcv_map_handle_clear_all (GcvMapHandle *self);
 guint8 *
 gcv_map_handle_get_accessibilty_mask (GcvMapHandle *self);
 
+/* Row-major bitmaps with `stride` words per row, tile x
+ * of a row at bit x % 64 of word x / 64. Units are not
+ * tracked. Only valid until the grid changes.
+ */
+const guint64 *
+gcv_map_handle_get_kind_plane (GcvMapHandle *self,
+                               GcvItemKind   kind,
+                               guint        *stride);
+
+const guint64 *
+gcv_map_handle_get_occupied_plane (GcvMapHandle *self,
+                                   guint        *stride);
+
 void
 gcv_map_handle_reorder (GcvMapHandle *self,
                         guint         position,
                         guint         length,
                         guint         new_position);
 
+guint
+gcv_map_handle_compact (GcvMapHandle *self);
+
 G_END_DECLS
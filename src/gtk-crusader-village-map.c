@@ -24,6 +24,7 @@
 
 #include "gtk-crusader-village-item-stroke.h"
 #include "gtk-crusader-village-map.h"
+#include "gtk-crusader-village-stats.h"
 
 /* clang-format off */
 G_DEFINE_QUARK (gtk-crusader-village-map-error-quark, gcv_map_error);
@@ -226,7 +227,7 @@ gcv_map_new_from_aiv_file_async (GFile              *file,
   g_return_if_fail (python_exe != NULL);
 
   data             = g_new0 (typeof (*data), 1);
-  data->store      = gcv_item_store_dup (store);
+  data->store      = g_object_ref (store);
   data->python_exe = g_strdup (python_exe);
   if (module_dir != NULL)
     data->module_dir = g_strdup (module_dir);
@@ -296,6 +297,62 @@ gcv_map_save_to_aiv_file_finish (GAsyncResult *result,
   return g_task_propagate_boolean (G_TASK (result), error);
 }
 
+const GcvMapKeepCorner *
+gcv_map_get_keep_outline (guint *n_corners)
+{
+  /* Stone Keep */
+  static const GcvMapKeepCorner outline[] = {
+    { -7, -7 },
+    {  0, -7 },
+    {  0, -5 },
+    {  5, -5 },
+    {  5,  0 },
+    { -2,  0 },
+    { -2,  1 },
+    {  0,  1 },
+    {  0,  8 },
+    { -7,  8 },
+    { -7,  1 },
+    { -5,  1 },
+    { -5,  0 },
+    { -7,  0 },
+  };
+
+  if (n_corners != NULL)
+    *n_corners = G_N_ELEMENTS (outline);
+  return outline;
+}
+
+gboolean
+gcv_map_is_keep_tile (int x,
+                      int y)
+{
+  const GcvMapKeepCorner *outline   = NULL;
+  guint                   n_corners = 0;
+  double                  center_x  = 0.0;
+  double                  center_y  = 0.0;
+  gboolean                inside    = FALSE;
+
+  outline  = gcv_map_get_keep_outline (&n_corners);
+  center_x = (double) x + 0.5;
+  center_y = (double) y + 0.5;
+
+  /* Even-odd test from the tile center, which
+   * never lies on an edge of the outline
+   */
+  for (guint i = 0, j = n_corners - 1; i < n_corners; j = i++)
+    {
+      if ((outline[i].y > center_y) != (outline[j].y > center_y) &&
+          center_x < outline[j].x +
+                         (double) (outline[i].x - outline[j].x) *
+                             (center_y - outline[j].y) /
+                             (double) (outline[i].y - outline[j].y))
+        inside = !inside;
+    }
+
+  return inside;
+}
+
 static void
 destroy_load_data (gpointer data)
 {
@@ -343,10 +400,14 @@ new_from_aiv_file_async_thread (GTask        *task,
   g_autoptr (GVariantIter) frames_iter        = NULL;
   g_autoptr (GVariantIter) misc_iter          = NULL;
   gint64 pause_delay_amount                   = 0;
+  gint64 begin_time                           = 0;
+  gint64 stage_begin_time                     = 0;
 
   if (g_task_return_error_if_cancelled (task))
     return;
 
+  begin_time = g_get_monotonic_time ();
+
   map       = g_object_new (GCV_TYPE_MAP, NULL);
   map->name = g_file_get_basename (file);
 
@@ -364,34 +425,45 @@ new_from_aiv_file_async_thread (GTask        *task,
       launcher, G_SUBPROCESS_FLAGS_STDOUT_PIPE | G_SUBPROCESS_FLAGS_STDERR_MERGE);
   if (data->module_dir != NULL)
     g_subprocess_launcher_setenv (launcher, "PYTHONPATH", data->module_dir, TRUE);
-  sourcehold = g_subprocess_launcher_spawn (
+  stage_begin_time = g_get_monotonic_time ();
+  sourcehold       = g_subprocess_launcher_spawn (
       launcher,
       &local_error,
       data->python_exe, "-m", "sourcehold", "convert", "aiv", "--input", aiv_file_path, "--output", tmp_file_path,
       NULL);
   if (sourcehold == NULL)
     goto err;
+  gcv_stats_record_time ("map.aiv-load.spawn", stage_begin_time);
+
+  stage_begin_time = g_get_monotonic_time ();
   if (!g_subprocess_communicate_utf8 (sourcehold, NULL, cancellable, &sourcehold_output, NULL, &local_error))
     goto err;
   if (!g_subprocess_wait (sourcehold, cancellable, &local_error))
     goto err;
   if (!g_subprocess_get_successful (sourcehold))
     goto err_sourcehold;
+  gcv_stats_record_time ("map.aiv-load.convert", stage_begin_time);
 
   stream = g_file_read (tmp_file, cancellable, &local_error);
   if (stream == NULL)
     goto err;
 
-  parser       = json_parser_new_immutable ();
-  parse_result = json_parser_load_from_stream (parser, G_INPUT_STREAM (stream), cancellable, &local_error);
+  stage_begin_time = g_get_monotonic_time ();
+  parser           = json_parser_new_immutable ();
+  parse_result     = json_parser_load_from_stream (parser, G_INPUT_STREAM (stream), cancellable, &local_error);
   if (!parse_result)
     goto err;
+  gcv_stats_record_time ("map.aiv-load.json-parse", stage_begin_time);
 
-  root    = json_parser_get_root (parser);
-  variant = json_gvariant_deserialize (root, NULL, &local_error);
+  stage_begin_time = g_get_monotonic_time ();
+  root             = json_parser_get_root (parser);
+  variant          = json_gvariant_deserialize (root, NULL, &local_error);
   if (variant == NULL)
     goto err;
   variant = g_variant_ref_sink (variant);
+  gcv_stats_record_time ("map.aiv-load.gvariant", stage_begin_time);
+
+  stage_begin_time = g_get_monotonic_time ();
 
   if (!g_variant_lookup (variant, "pauseDelayAmount", "x", &pause_delay_amount))
     goto err_inval;
@@ -422,13 +494,10 @@ new_from_aiv_file_async_thread (GTask        *task,
       item = gcv_item_store_query_id (data->store, id);
       if (item == NULL)
         continue;
-      g_object_get (
-          item,
-          "tile-width", &item_tile_width,
-          "tile-height", &item_tile_height,
-          "tile-offset-x", &item_tile_offset_x,
-          "tile-offset-y", &item_tile_offset_y,
-          NULL);
+      item_tile_width    = gcv_item_get_info (item)->tile_width;
+      item_tile_height   = gcv_item_get_info (item)->tile_height;
+      item_tile_offset_x = gcv_item_get_info (item)->tile_offset_x;
+      item_tile_offset_y = gcv_item_get_info (item)->tile_offset_y;
 
       if (!g_variant_lookup (frame, "tilePositionOfsets", "av", &instances_iter))
         goto err_inval;
@@ -495,6 +564,9 @@ new_from_aiv_file_async_thread (GTask        *task,
       g_list_store_append (G_LIST_STORE (map->strokes), stroke);
     }
 
+  gcv_stats_record_time ("map.aiv-load.strokes", stage_begin_time);
+  gcv_stats_record_time ("map.aiv-load", begin_time);
+
   g_task_return_pointer (task, g_steal_pointer (&map), g_object_unref);
   goto done;
 
@@ -536,10 +608,14 @@ save_to_aiv_file_async_thread (GTask        *task,
   g_autoptr (GSubprocessLauncher) launcher    = NULL;
   g_autoptr (GSubprocess) sourcehold          = NULL;
   g_autofree char *sourcehold_output          = NULL;
+  gint64 begin_time                           = 0;
+  gint64 stage_begin_time                     = 0;
 
   if (g_task_return_error_if_cancelled (task))
     return;
 
+  begin_time = g_get_monotonic_time ();
+
   tmp_file = g_file_new_tmp ("XXXXXX.json", &tmp_file_iostream, &local_error);
   if (tmp_file == NULL)
     goto err;
@@ -575,11 +651,8 @@ save_to_aiv_file_async_thread (GTask        *task,
               "item", &item,
               "instances", &instances,
               NULL);
-          g_object_get (
-              item,
-              "id", &id,
-              "kind", &kind,
-              NULL);
+          id   = gcv_item_get_info (item)->id;
+          kind = gcv_item_get_info (item)->kind;
 
           if (kind == GCV_ITEM_KIND_UNIT)
             continue;
@@ -622,11 +695,8 @@ save_to_aiv_file_async_thread (GTask        *task,
               "item", &item,
               "instances", &instances,
               NULL);
-          g_object_get (
-              item,
-              "id", &id,
-              "kind", &kind,
-              NULL);
+          id   = gcv_item_get_info (item)->id;
+          kind = gcv_item_get_info (item)->kind;
 
           if (kind != GCV_ITEM_KIND_UNIT)
             continue;
@@ -654,6 +724,7 @@ save_to_aiv_file_async_thread (GTask        *task,
   if (!g_io_stream_close (G_IO_STREAM (tmp_file_iostream),
                           cancellable, &local_error))
     goto err;
+  gcv_stats_record_time ("map.aiv-save.json", begin_time);
 
   aiv_file_path = g_file_get_path (file);
   tmp_file_path = g_file_get_path (tmp_file);
@@ -670,19 +741,25 @@ save_to_aiv_file_async_thread (GTask        *task,
       launcher, G_SUBPROCESS_FLAGS_STDOUT_PIPE | G_SUBPROCESS_FLAGS_STDERR_MERGE);
   if (data->module_dir != NULL)
     g_subprocess_launcher_setenv (launcher, "PYTHONPATH", data->module_dir, TRUE);
-  sourcehold = g_subprocess_launcher_spawn (
+  stage_begin_time = g_get_monotonic_time ();
+  sourcehold       = g_subprocess_launcher_spawn (
       launcher,
       &local_error,
       data->python_exe, "-m", "sourcehold", "convert", "aiv", "--input", tmp_file_path, "--output", aiv_file_path,
       NULL);
   if (sourcehold == NULL)
     goto err;
+  gcv_stats_record_time ("map.aiv-save.spawn", stage_begin_time);
+
+  stage_begin_time = g_get_monotonic_time ();
   if (!g_subprocess_communicate_utf8 (sourcehold, NULL, cancellable, &sourcehold_output, NULL, &local_error))
     goto err;
   if (!g_subprocess_wait (sourcehold, cancellable, &local_error))
     goto err;
   if (!g_subprocess_get_successful (sourcehold))
     goto err_sourcehold;
+  gcv_stats_record_time ("map.aiv-save.convert", stage_begin_time);
+  gcv_stats_record_time ("map.aiv-save", begin_time);
 
   g_task_return_boolean (task, TRUE);
   goto done;
@@ -67,4 +67,23 @@ gboolean
 gcv_map_save_to_aiv_file_finish (GAsyncResult *result,
                                  GError      **error);
 
+typedef struct
+{
+  int x;
+  int y;
+} GcvMapKeepCorner;
+
+/* Corners of the keep's footprint in tiles, relative to
+ * the map center and in drawing order
+ */
+const GcvMapKeepCorner *
+gcv_map_get_keep_outline (guint *n_corners);
+
+/* Whether tile (x, y), relative to the map center,
+ * is under the keep
+ */
+gboolean
+gcv_map_is_keep_tile (int x,
+                      int y);
+
 G_END_DECLS
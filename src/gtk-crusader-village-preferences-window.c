@@ -31,6 +31,7 @@
 #define KEY_BACKGROUND_IMAGE    "background-image"
 #define KEY_SHOW_GRADIENT       "show-gradient"
 #define KEY_SHOW_CURSOR_GLOW    "show-cursor-glow"
+#define KEY_COMPACT_IMPORTED    "compact-imported-strokes"
 
 /* TODO: perhaps read from schema instead */
 static const char *theme_choices[] = {
@@ -57,6 +58,7 @@ struct _GcvPreferencesWindow
   GtkSwitch   *show_grid;
   GtkSwitch   *show_gradient;
   GtkSwitch   *show_cursor_glow;
+  GtkSwitch   *compact_imported;
 
   GtkLabel  *background_label;
   GtkButton *background_button;
@@ -184,6 +186,7 @@ gcv_preferences_window_set_property (GObject      *object,
           gtk_switch_set_active (self->show_grid, g_settings_get_boolean (self->settings, KEY_SHOW_GRID));
           gtk_switch_set_active (self->show_gradient, g_settings_get_boolean (self->settings, KEY_SHOW_GRADIENT));
           gtk_switch_set_active (self->show_cursor_glow, g_settings_get_boolean (self->settings, KEY_SHOW_CURSOR_GLOW));
+          gtk_switch_set_active (self->compact_imported, g_settings_get_boolean (self->settings, KEY_COMPACT_IMPORTED));
           read_python (self, GTK_EDITABLE (self->python_install), self->settings, KEY_PYTHON_INSTALL);
           read_python (self, GTK_EDITABLE (self->python_path), self->settings, KEY_PYTHON_PACKAGE_PATH);
           read_background_image (self, self->settings, KEY_BACKGROUND_IMAGE);
@@ -219,6 +222,7 @@ gcv_preferences_window_class_init (GcvPreferencesWindowClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GcvPreferencesWindow, show_grid);
   gtk_widget_class_bind_template_child (widget_class, GcvPreferencesWindow, show_gradient);
   gtk_widget_class_bind_template_child (widget_class, GcvPreferencesWindow, show_cursor_glow);
+  gtk_widget_class_bind_template_child (widget_class, GcvPreferencesWindow, compact_imported);
   gtk_widget_class_bind_template_child (widget_class, GcvPreferencesWindow, python_install);
   gtk_widget_class_bind_template_child (widget_class, GcvPreferencesWindow, python_reset);
   gtk_widget_class_bind_template_child (widget_class, GcvPreferencesWindow, python_path);
@@ -242,6 +246,8 @@ gcv_preferences_window_init (GcvPreferencesWindow *self)
                     G_CALLBACK (ui_changed), self);
   g_signal_connect (self->show_cursor_glow, "notify::active",
                     G_CALLBACK (ui_changed), self);
+  g_signal_connect (self->compact_imported, "notify::active",
+                    G_CALLBACK (ui_changed), self);
   g_signal_connect (self->python_install, "notify::text",
                     G_CALLBACK (ui_changed), self);
   g_signal_connect (self->python_path, "notify::text",
@@ -272,6 +278,8 @@ setting_changed (GSettings            *self,
     read_background_image (window, self, key);
   else if (g_strcmp0 (key, KEY_SHOW_CURSOR_GLOW) == 0)
     gtk_switch_set_active (window->show_cursor_glow, g_settings_get_boolean (self, KEY_SHOW_CURSOR_GLOW));
+  else if (g_strcmp0 (key, KEY_COMPACT_IMPORTED) == 0)
+    gtk_switch_set_active (window->compact_imported, g_settings_get_boolean (self, KEY_COMPACT_IMPORTED));
   else if (g_strcmp0 (key, KEY_PYTHON_INSTALL) == 0)
     read_python (window, GTK_EDITABLE (window->python_install), self, key);
   else if (g_strcmp0 (key, KEY_PYTHON_PACKAGE_PATH) == 0)
@@ -296,6 +304,8 @@ ui_changed (GtkWidget            *widget,
     g_settings_set_boolean (window->settings, KEY_SHOW_GRADIENT, gtk_switch_get_active (window->show_gradient));
   else if (widget == (GtkWidget *) window->show_cursor_glow)
     g_settings_set_boolean (window->settings, KEY_SHOW_CURSOR_GLOW, gtk_switch_get_active (window->show_cursor_glow));
+  else if (widget == (GtkWidget *) window->compact_imported)
+    g_settings_set_boolean (window->settings, KEY_COMPACT_IMPORTED, gtk_switch_get_active (window->compact_imported));
   else if (widget == (GtkWidget *) window->python_install)
     g_settings_set_string (window->settings, KEY_PYTHON_INSTALL, gtk_editable_get_text (GTK_EDITABLE (window->python_install)));
   else if (widget == (GtkWidget *) window->python_path)
@@ -0,0 +1,722 @@
+/* gtk-crusader-village-stamp.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+
+#include "gtk-crusader-village-item-stroke.h"
+#include "gtk-crusader-village-stamp.h"
+
+/* Each stamp is one serialized GVariant: a format version,
+ * then per stroke the item id and its instances as pairs
+ * of 16 bit coordinates relative to the stamp's corner.
+ */
+#define STAMP_FORMAT         "(ua(ia(nn)))"
+#define STAMP_FORMAT_VERSION 1
+#define STAMP_SUFFIX         ".gcvstamp"
+#define THUMBNAIL_SIZE       64
+
+/* The largest map, see GcvMap:width and GcvMap:height */
+#define STAMP_MAX_SIZE 16384
+
+/* clang-format off */
+G_DEFINE_QUARK (gtk-crusader-village-stamp-error-quark, gcv_stamp_error);
+/* clang-format on */
+
+struct _GcvStamp
+{
+  GObject parent_instance;
+
+  GFile        *file;
+  char         *name;
+  GcvItemStore *item_store;
+
+  GListModel *strokes;
+  GdkTexture *thumbnail;
+
+  /* Tasks waiting on the one load in flight */
+  GPtrArray *waiting;
+};
+
+G_DEFINE_FINAL_TYPE (GcvStamp, gcv_stamp, G_TYPE_OBJECT)
+
+enum
+{
+  PROP_0,
+
+  PROP_FILE,
+  PROP_NAME,
+  PROP_ITEM_STORE,
+  PROP_STROKES,
+  PROP_THUMBNAIL,
+
+  LAST_PROP
+};
+
+static GParamSpec *props[LAST_PROP] = { 0 };
+
+typedef struct
+{
+  GListModel *strokes;
+  GdkTexture *thumbnail;
+} LoadResult;
+
+static void
+destroy_load_result (gpointer data);
+
+static void
+load_async_thread (GTask        *task,
+                   gpointer      object,
+                   gpointer      task_data,
+                   GCancellable *cancellable);
+
+static void
+load_done (GObject      *object,
+           GAsyncResult *result,
+           gpointer      user_data);
+
+static GdkTexture *
+render_thumbnail (GListModel *strokes);
+
+static char *
+dup_library_path (void);
+
+static void
+gcv_stamp_dispose (GObject *object)
+{
+  GcvStamp *self = GCV_STAMP (object);
+
+  g_clear_object (&self->file);
+  g_clear_pointer (&self->name, g_free);
+  g_clear_object (&self->item_store);
+  g_clear_object (&self->strokes);
+  g_clear_object (&self->thumbnail);
+  g_clear_pointer (&self->waiting, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (gcv_stamp_parent_class)->dispose (object);
+}
+
+static void
+gcv_stamp_get_property (GObject    *object,
+                        guint       prop_id,
+                        GValue     *value,
+                        GParamSpec *pspec)
+{
+  GcvStamp *self = GCV_STAMP (object);
+
+  switch (prop_id)
+    {
+    case PROP_FILE:
+      g_value_set_object (value, self->file);
+      break;
+    case PROP_NAME:
+      g_value_set_string (value, self->name);
+      break;
+    case PROP_ITEM_STORE:
+      g_value_set_object (value, self->item_store);
+      break;
+    case PROP_STROKES:
+      g_value_set_object (value, self->strokes);
+      break;
+    case PROP_THUMBNAIL:
+      g_value_set_object (value, self->thumbnail);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gcv_stamp_set_property (GObject      *object,
+                        guint         prop_id,
+                        const GValue *value,
+                        GParamSpec   *pspec)
+{
+  GcvStamp *self = GCV_STAMP (object);
+
+  switch (prop_id)
+    {
+    case PROP_FILE:
+      g_clear_object (&self->file);
+      g_clear_pointer (&self->name, g_free);
+      self->file = g_value_dup_object (value);
+      if (self->file != NULL)
+        {
+          g_autofree char *basename = NULL;
+
+          basename = g_file_get_basename (self->file);
+          if (g_str_has_suffix (basename, STAMP_SUFFIX))
+            basename[strlen (basename) - strlen (STAMP_SUFFIX)] = '\0';
+          self->name = g_steal_pointer (&basename);
+        }
+      break;
+    case PROP_ITEM_STORE:
+      g_clear_object (&self->item_store);
+      self->item_store = g_value_dup_object (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gcv_stamp_class_init (GcvStampClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose      = gcv_stamp_dispose;
+  object_class->get_property = gcv_stamp_get_property;
+  object_class->set_property = gcv_stamp_set_property;
+
+  props[PROP_FILE] =
+      g_param_spec_object (
+          "file",
+          "File",
+          "The file this stamp is stored in",
+          G_TYPE_FILE,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  props[PROP_NAME] =
+      g_param_spec_string (
+          "name",
+          "Name",
+          "The name of this stamp",
+          NULL,
+          G_PARAM_READABLE);
+
+  props[PROP_ITEM_STORE] =
+      g_param_spec_object (
+          "item-store",
+          "Item Store",
+          "The item store used to resolve item ids when loading",
+          GCV_TYPE_ITEM_STORE,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  props[PROP_STROKES] =
+      g_param_spec_object (
+          "strokes",
+          "Strokes",
+          "The `GcvItemStroke`s of this stamp, or NULL if not loaded yet",
+          G_TYPE_LIST_MODEL,
+          G_PARAM_READABLE);
+
+  props[PROP_THUMBNAIL] =
+      g_param_spec_object (
+          "thumbnail",
+          "Thumbnail",
+          "A preview of this stamp, or NULL if not loaded yet",
+          GDK_TYPE_TEXTURE,
+          G_PARAM_READABLE);
+
+  g_object_class_install_properties (object_class, LAST_PROP, props);
+}
+
+static void
+gcv_stamp_init (GcvStamp *self)
+{
+  self->waiting = g_ptr_array_new_with_free_func (g_object_unref);
+}
+
+/* Only lists the files, nothing is read until a
+ * stamp is loaded
+ */
+GListStore *
+gcv_stamp_read_library (GcvItemStore *item_store)
+{
+  GListStore      *store    = NULL;
+  g_autofree char *path     = NULL;
+  g_autoptr (GDir) dir      = NULL;
+  const char      *basename = NULL;
+
+  g_return_val_if_fail (GCV_IS_ITEM_STORE (item_store), NULL);
+
+  store = g_list_store_new (GCV_TYPE_STAMP);
+
+  path = dup_library_path ();
+  dir  = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    return store;
+
+  while ((basename = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree char *filename  = NULL;
+      g_autoptr (GFile) file     = NULL;
+      g_autoptr (GcvStamp) stamp = NULL;
+
+      if (!g_str_has_suffix (basename, STAMP_SUFFIX))
+        continue;
+
+      filename = g_build_filename (path, basename, NULL);
+      file     = g_file_new_for_path (filename);
+      stamp    = g_object_new (
+          GCV_TYPE_STAMP,
+          "file", file,
+          "item-store", item_store,
+          NULL);
+      g_list_store_append (store, stamp);
+    }
+
+  return store;
+}
+
+GcvStamp *
+gcv_stamp_save_to_library (GListModel *strokes,
+                           const char *name,
+                           GError    **error)
+{
+  guint                       n_strokes = 0;
+  g_autoptr (GVariantBuilder) builder   = NULL;
+  g_autoptr (GVariant) variant          = NULL;
+  g_autofree char *path                 = NULL;
+  g_autofree char *basename             = NULL;
+  g_autofree char *filename             = NULL;
+  g_autoptr (GFile) file                = NULL;
+  GcvStamp *stamp                       = NULL;
+
+  g_return_val_if_fail (G_IS_LIST_MODEL (strokes), NULL);
+  g_return_val_if_fail (name != NULL && *name != '\0', NULL);
+
+  n_strokes = g_list_model_get_n_items (strokes);
+
+  builder = g_variant_builder_new (G_VARIANT_TYPE ("a(ia(nn))"));
+  for (guint i = 0; i < n_strokes; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke  = NULL;
+      g_autoptr (GcvItem) item          = NULL;
+      g_autoptr (GArray) instances      = NULL;
+      int             item_id           = 0;
+      GVariantBuilder instances_builder = { 0 };
+
+      stroke = g_list_model_get_item (strokes, i);
+      g_object_get (
+          stroke,
+          "item", &item,
+          "instances", &instances,
+          NULL);
+      g_object_get (
+          item,
+          "id", &item_id,
+          NULL);
+
+      g_variant_builder_init (&instances_builder, G_VARIANT_TYPE ("a(nn)"));
+      for (guint j = 0; j < instances->len; j++)
+        {
+          GcvItemStrokeInstance instance = { 0 };
+
+          instance = g_array_index (instances, GcvItemStrokeInstance, j);
+          if (instance.x < 0 || instance.x >= STAMP_MAX_SIZE ||
+              instance.y < 0 || instance.y >= STAMP_MAX_SIZE)
+            {
+              g_variant_builder_clear (&instances_builder);
+              g_set_error (
+                  error,
+                  GCV_STAMP_ERROR,
+                  GCV_STAMP_ERROR_TOO_LARGE,
+                  "The stamp is too large to be saved");
+              return NULL;
+            }
+
+          g_variant_builder_add (&instances_builder, "(nn)",
+                                 (gint16) instance.x, (gint16) instance.y);
+        }
+
+      g_variant_builder_add (builder, "(i@a(nn))", item_id,
+                             g_variant_builder_end (&instances_builder));
+    }
+
+  variant = g_variant_ref_sink (
+      g_variant_new ("(u@a(ia(nn)))", STAMP_FORMAT_VERSION,
+                     g_variant_builder_end (builder)));
+
+  path = dup_library_path ();
+  if (g_mkdir_with_parents (path, 0755) != 0)
+    {
+      int errsv = errno;
+
+      g_set_error (
+          error,
+          G_IO_ERROR,
+          g_io_error_from_errno (errsv),
+          "Could not create %s: %s",
+          path, g_strerror (errsv));
+      return NULL;
+    }
+
+  basename = g_strconcat (name, STAMP_SUFFIX, NULL);
+  g_strdelimit (basename, G_DIR_SEPARATOR_S "/", '_');
+  filename = g_build_filename (path, basename, NULL);
+  file     = g_file_new_for_path (filename);
+
+  /* Saving under an existing name replaces that stamp,
+   * callers holding its GcvStamp must swap in this one
+   */
+  if (!g_file_replace_contents (
+          file,
+          g_variant_get_data (variant),
+          g_variant_get_size (variant),
+          NULL, FALSE, G_FILE_CREATE_REPLACE_DESTINATION,
+          NULL, NULL, error))
+    return NULL;
+
+  /* No need to read back what we just wrote, so
+   * there is no item store to resolve ids with
+   */
+  stamp = g_object_new (
+      GCV_TYPE_STAMP,
+      "file", file,
+      NULL);
+  stamp->strokes   = g_object_ref (strokes);
+  stamp->thumbnail = render_thumbnail (strokes);
+
+  return stamp;
+}
+
+void
+gcv_stamp_load_async (GcvStamp           *self,
+                      int                 io_priority,
+                      GCancellable       *cancellable,
+                      GAsyncReadyCallback callback,
+                      gpointer            user_data)
+{
+  g_autoptr (GTask) task   = NULL;
+  g_autoptr (GTask) worker = NULL;
+
+  g_return_if_fail (GCV_IS_STAMP (self));
+  g_return_if_fail (self->file != NULL);
+  g_return_if_fail (self->strokes != NULL || self->item_store != NULL);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gcv_stamp_load_async);
+  g_task_set_priority (task, io_priority);
+
+  if (self->strokes != NULL)
+    {
+      g_task_return_pointer (task, g_object_ref (self->strokes), g_object_unref);
+      return;
+    }
+
+  /* Many list rows may ask for the same stamp, only read it once */
+  g_ptr_array_add (self->waiting, g_object_ref (task));
+  if (self->waiting->len > 1)
+    return;
+
+  worker = g_task_new (self, NULL, load_done, NULL);
+  g_task_set_source_tag (worker, load_async_thread);
+  g_task_set_priority (worker, io_priority);
+  g_task_set_task_data (
+      worker,
+      g_object_ref (self->item_store),
+      g_object_unref);
+  g_task_run_in_thread (worker, load_async_thread);
+}
+
+GListModel *
+gcv_stamp_load_finish (GcvStamp     *self,
+                       GAsyncResult *result,
+                       GError      **error)
+{
+  g_return_val_if_fail (GCV_IS_STAMP (self), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) ==
+                            gcv_stamp_load_async,
+                        NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+destroy_load_result (gpointer data)
+{
+  LoadResult *result = data;
+
+  g_clear_object (&result->strokes);
+  g_clear_object (&result->thumbnail);
+  g_free (result);
+}
+
+static void
+load_async_thread (GTask        *task,
+                   gpointer      object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  GcvStamp     *self                 = object;
+  GcvItemStore *item_store           = task_data;
+  g_autoptr (GError) local_error     = NULL;
+  g_autoptr (GBytes) bytes           = NULL;
+  g_autoptr (GVariant) variant       = NULL;
+  guint32 version                    = 0;
+  g_autoptr (GVariantIter) stroke_it = NULL;
+  int           item_id              = 0;
+  GVariantIter *instance_it          = NULL;
+  g_autoptr (GListStore) strokes     = NULL;
+  LoadResult *result                 = NULL;
+
+  /* The file is never modified in place */
+  bytes = g_file_load_bytes (self->file, cancellable, NULL, &local_error);
+  if (bytes == NULL)
+    {
+      g_task_return_error (task, g_steal_pointer (&local_error));
+      return;
+    }
+
+  /* GVariant copes with untrusted data on its own */
+  variant = g_variant_ref_sink (
+      g_variant_new_from_bytes (G_VARIANT_TYPE (STAMP_FORMAT), bytes, FALSE));
+
+  g_variant_get (variant, "(ua(ia(nn)))", &version, &stroke_it);
+  if (version != STAMP_FORMAT_VERSION)
+    goto invalid;
+
+  strokes = g_list_store_new (GCV_TYPE_ITEM_STROKE);
+  while (g_variant_iter_next (stroke_it, "(ia(nn))", &item_id, &instance_it))
+    {
+      g_autoptr (GcvItem) item         = NULL;
+      g_autoptr (GArray) instances     = NULL;
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      const GcvItemInfo *info          = NULL;
+      gint16             x             = 0;
+      gint16             y             = 0;
+
+      item = item_id > 0 ? gcv_item_store_query_id (item_store, item_id) : NULL;
+      if (item == NULL)
+        {
+          g_variant_iter_free (instance_it);
+          goto invalid;
+        }
+
+      info      = gcv_item_get_info (item);
+      instances = g_array_sized_new (
+          FALSE, FALSE, sizeof (GcvItemStrokeInstance),
+          g_variant_iter_n_children (instance_it));
+      while (g_variant_iter_next (instance_it, "(nn)", &x, &y))
+        {
+          /* Nothing we save is negative or larger than a map */
+          if (x < 0 || x + info->tile_width > STAMP_MAX_SIZE ||
+              y < 0 || y + info->tile_height > STAMP_MAX_SIZE)
+            {
+              g_variant_iter_free (instance_it);
+              goto invalid;
+            }
+          g_array_append_val (instances, ((GcvItemStrokeInstance) { x, y }));
+        }
+      g_variant_iter_free (instance_it);
+
+      stroke = g_object_new (
+          GCV_TYPE_ITEM_STROKE,
+          "item", item,
+          NULL);
+      gcv_item_stroke_add_instances (
+          stroke,
+          (const GcvItemStrokeInstance *) (gpointer) instances->data,
+          instances->len);
+      g_list_store_append (strokes, stroke);
+    }
+
+  result            = g_new0 (LoadResult, 1);
+  result->strokes   = G_LIST_MODEL (g_steal_pointer (&strokes));
+  result->thumbnail = render_thumbnail (result->strokes);
+
+  g_task_return_pointer (task, result, destroy_load_result);
+  return;
+
+invalid:
+  g_task_return_new_error (
+      task,
+      GCV_STAMP_ERROR,
+      GCV_STAMP_ERROR_INVALID_FORMAT,
+      "%s is not a valid stamp",
+      g_file_peek_path (self->file));
+}
+
+static void
+load_done (GObject      *object,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  GcvStamp   *self               = GCV_STAMP (object);
+  LoadResult *load_result        = NULL;
+  g_autoptr (GError) local_error = NULL;
+  g_autoptr (GPtrArray) waiting  = NULL;
+
+  load_result = g_task_propagate_pointer (G_TASK (result), &local_error);
+
+  if (load_result != NULL)
+    {
+      g_clear_object (&self->strokes);
+      g_clear_object (&self->thumbnail);
+      self->strokes   = g_steal_pointer (&load_result->strokes);
+      self->thumbnail = g_steal_pointer (&load_result->thumbnail);
+      destroy_load_result (load_result);
+
+      g_object_notify_by_pspec (G_OBJECT (self), props[PROP_STROKES]);
+      g_object_notify_by_pspec (G_OBJECT (self), props[PROP_THUMBNAIL]);
+    }
+
+  waiting       = g_steal_pointer (&self->waiting);
+  self->waiting = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (guint i = 0; i < waiting->len; i++)
+    {
+      GTask *task = g_ptr_array_index (waiting, i);
+
+      if (self->strokes != NULL)
+        g_task_return_pointer (task, g_object_ref (self->strokes), g_object_unref);
+      else
+        g_task_return_error (task, g_error_copy (local_error));
+    }
+}
+
+/* One pixel block per tile, colored by item kind */
+static GdkTexture *
+render_thumbnail (GListModel *strokes)
+{
+  /* Straight alpha, indexed by GcvItemKind */
+  static const guint8 kind_colors[][3] = {
+    [GCV_ITEM_KIND_BUILDING]     = { 214, 160, 74 },
+    [GCV_ITEM_KIND_UNIT]         = { 191, 64, 255 },
+    [GCV_ITEM_KIND_WALL]         = { 150, 150, 150 },
+    [GCV_ITEM_KIND_GATEHOUSE_NS] = { 105, 105, 120 },
+    [GCV_ITEM_KIND_GATEHOUSE_EW] = { 105, 105, 120 },
+    [GCV_ITEM_KIND_MOAT]         = { 40, 110, 200 },
+  };
+
+  guint              n_strokes = 0;
+  int                width     = 0;
+  int                height    = 0;
+  int                scale     = 0;
+  int                shrink    = 0;
+  int                tex_w     = 0;
+  int                tex_h     = 0;
+  gsize              stride    = 0;
+  g_autofree guint8 *pixels    = NULL;
+  g_autoptr (GBytes) bytes     = NULL;
+
+  n_strokes = g_list_model_get_n_items (strokes);
+
+  /* Saved stamps always start at 0,0 */
+  for (guint i = 0; i < n_strokes; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GcvItem) item         = NULL;
+      g_autoptr (GArray) instances     = NULL;
+      int item_tile_width              = 0;
+      int item_tile_height             = 0;
+
+      stroke = g_list_model_get_item (strokes, i);
+      g_object_get (
+          stroke,
+          "item", &item,
+          "instances", &instances,
+          NULL);
+      g_object_get (
+          item,
+          "tile-width", &item_tile_width,
+          "tile-height", &item_tile_height,
+          NULL);
+
+      for (guint j = 0; j < instances->len; j++)
+        {
+          GcvItemStrokeInstance instance = { 0 };
+
+          instance = g_array_index (instances, GcvItemStrokeInstance, j);
+          width    = MAX (width, instance.x + item_tile_width);
+          height   = MAX (height, instance.y + item_tile_height);
+        }
+    }
+  if (width <= 0 || height <= 0)
+    return NULL;
+  width  = MIN (width, STAMP_MAX_SIZE);
+  height = MIN (height, STAMP_MAX_SIZE);
+
+  /* Blow small stamps up, squeeze big ones into a
+   * thumbnail sized texture
+   */
+  scale  = MAX (1, THUMBNAIL_SIZE / MAX (width, height));
+  shrink = (MAX (width, height) + THUMBNAIL_SIZE - 1) / THUMBNAIL_SIZE;
+  tex_w  = MAX (1, width * scale / shrink);
+  tex_h  = MAX (1, height * scale / shrink);
+  stride = (gsize) tex_w * 4;
+  pixels = g_malloc0 (stride * tex_h);
+
+  for (guint i = 0; i < n_strokes; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GcvItem) item         = NULL;
+      g_autoptr (GArray) instances     = NULL;
+      GcvItemKind item_kind            = 0;
+      int         item_tile_width      = 0;
+      int         item_tile_height     = 0;
+      guint8      color[4]             = { 0, 0, 0, 255 };
+
+      stroke = g_list_model_get_item (strokes, i);
+      g_object_get (
+          stroke,
+          "item", &item,
+          "instances", &instances,
+          NULL);
+      g_object_get (
+          item,
+          "kind", &item_kind,
+          "tile-width", &item_tile_width,
+          "tile-height", &item_tile_height,
+          NULL);
+      if ((guint) item_kind < G_N_ELEMENTS (kind_colors))
+        memcpy (color, kind_colors[item_kind], 3);
+
+      for (guint j = 0; j < instances->len; j++)
+        {
+          GcvItemStrokeInstance instance = { 0 };
+
+          int x0 = 0;
+          int y0 = 0;
+          int x1 = 0;
+          int y1 = 0;
+
+          instance = g_array_index (instances, GcvItemStrokeInstance, j);
+          if (instance.x < 0 || instance.y < 0)
+            continue;
+
+          x0 = MIN (instance.x * scale / shrink, tex_w);
+          y0 = MIN (instance.y * scale / shrink, tex_h);
+          x1 = MIN (((instance.x + item_tile_width) * scale + shrink - 1) / shrink, tex_w);
+          y1 = MIN (((instance.y + item_tile_height) * scale + shrink - 1) / shrink, tex_h);
+
+          for (int py = y0; py < y1; py++)
+            {
+              for (int px = x0; px < x1; px++)
+                memcpy (pixels + py * stride + px * 4, color, 4);
+            }
+        }
+    }
+
+  bytes = g_bytes_new_take (g_steal_pointer (&pixels), stride * tex_h);
+  return gdk_memory_texture_new (
+      tex_w, tex_h,
+      GDK_MEMORY_R8G8B8A8, bytes, stride);
+}
+
+static char *
+dup_library_path (void)
+{
+  return g_build_filename (g_get_user_data_dir (), "gtk-crusader-village", "stamps", NULL);
+}
@@ -0,0 +1,62 @@
+/* gtk-crusader-village-stamp.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+#include "gtk-crusader-village-item-store.h"
+
+G_BEGIN_DECLS
+
+#define GCV_STAMP_ERROR (gcv_stamp_error_quark ())
+GQuark gcv_stamp_error_quark (void);
+
+typedef enum
+{
+  GCV_STAMP_ERROR_INVALID_FORMAT = 0,
+  GCV_STAMP_ERROR_TOO_LARGE,
+} GcvStampError;
+
+#define GCV_TYPE_STAMP (gcv_stamp_get_type ())
+
+G_DECLARE_FINAL_TYPE (GcvStamp, gcv_stamp, GCV, STAMP, GObject)
+
+GListStore *
+gcv_stamp_read_library (GcvItemStore *item_store);
+
+GcvStamp *
+gcv_stamp_save_to_library (GListModel *strokes,
+                           const char *name,
+                           GError    **error);
+
+void
+gcv_stamp_load_async (GcvStamp           *self,
+                      int                 io_priority,
+                      GCancellable       *cancellable,
+                      GAsyncReadyCallback callback,
+                      gpointer            user_data);
+
+GListModel *
+gcv_stamp_load_finish (GcvStamp     *self,
+                       GAsyncResult *result,
+                       GError      **error);
+
+G_END_DECLS
@@ -0,0 +1,313 @@
+/* gtk-crusader-village-stats.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include <json-glib/json-glib.h>
+#ifdef HAVE_SYSPROF
+#include <sysprof-capture.h>
+#endif
+
+#include "gtk-crusader-village-stats.h"
+
+typedef struct
+{
+  gboolean timer;
+  gint64   samples;
+  gint64   total;
+  gint64   last;
+  gint64   max;
+} Stat;
+
+/* Written from the loader threads as well */
+static GMutex      stats_mutex;
+static GHashTable *stats = NULL;
+
+/* Checked before taking the lock so recording is
+ * close to free while nobody is looking at the stats
+ */
+static gint stats_enabled = 0;
+
+static void
+record (const char *name,
+        gboolean    timer,
+        gint64      value);
+
+static GList *
+dup_sorted_names (void);
+
+#ifdef HAVE_SYSPROF
+static gboolean
+trace_marks_enabled (void);
+#endif
+
+void
+gcv_stats_enable (void)
+{
+  g_atomic_int_inc (&stats_enabled);
+}
+
+void
+gcv_stats_disable (void)
+{
+  g_return_if_fail (g_atomic_int_get (&stats_enabled) > 0);
+
+  g_atomic_int_dec_and_test (&stats_enabled);
+}
+
+void
+gcv_stats_record_time (const char *name,
+                       gint64      begin_time)
+{
+  gint64 elapsed = 0;
+
+  g_return_if_fail (name != NULL);
+
+  elapsed = g_get_monotonic_time () - begin_time;
+  record (name, TRUE, elapsed);
+
+#ifdef HAVE_SYSPROF
+  /* Both clocks are CLOCK_MONOTONIC, sysprof just wants nanoseconds */
+  if (trace_marks_enabled ())
+    sysprof_collector_mark (
+        begin_time * 1000, elapsed * 1000,
+        "gtk-crusader-village", name, NULL);
+#endif
+}
+
+void
+gcv_stats_add_count (const char *name,
+                     gint64      amount)
+{
+  g_return_if_fail (name != NULL);
+
+  record (name, FALSE, amount);
+}
+
+gboolean
+gcv_stats_lookup (const char *name,
+                  gint64     *samples,
+                  gint64     *total,
+                  gint64     *max)
+{
+  Stat *stat = NULL;
+
+  g_return_val_if_fail (name != NULL, FALSE);
+
+  g_mutex_lock (&stats_mutex);
+
+  if (stats != NULL)
+    stat = g_hash_table_lookup (stats, name);
+  if (stat != NULL)
+    {
+      if (samples != NULL)
+        *samples = stat->samples;
+      if (total != NULL)
+        *total = stat->total;
+      if (max != NULL)
+        *max = stat->max;
+    }
+
+  g_mutex_unlock (&stats_mutex);
+
+  return stat != NULL;
+}
+
+void
+gcv_stats_reset (void)
+{
+  g_mutex_lock (&stats_mutex);
+  if (stats != NULL)
+    g_hash_table_remove_all (stats);
+  g_mutex_unlock (&stats_mutex);
+}
+
+char *
+gcv_stats_dump_text (void)
+{
+  g_autoptr (GString) string = NULL;
+  g_autoptr (GList) names    = NULL;
+
+  string = g_string_new (NULL);
+
+  g_mutex_lock (&stats_mutex);
+
+  names = dup_sorted_names ();
+  for (GList *l = names; l != NULL; l = l->next)
+    {
+      Stat *stat = NULL;
+
+      stat = g_hash_table_lookup (stats, l->data);
+
+      if (string->len > 0)
+        g_string_append_c (string, '\n');
+
+      if (stat->timer)
+        g_string_append_printf (
+            string, "%-36s %8.2f ms  avg %8.2f  max %8.2f  n=%" G_GINT64_FORMAT,
+            (const char *) l->data,
+            (double) stat->last / 1000.0,
+            (double) stat->total / (double) stat->samples / 1000.0,
+            (double) stat->max / 1000.0,
+            stat->samples);
+      else
+        g_string_append_printf (
+            string, "%-36s %11" G_GINT64_FORMAT "  last %8" G_GINT64_FORMAT,
+            (const char *) l->data,
+            stat->total,
+            stat->last);
+    }
+
+  g_mutex_unlock (&stats_mutex);
+
+  return g_string_free (g_steal_pointer (&string), FALSE);
+}
+
+char *
+gcv_stats_dump_json (void)
+{
+  g_autoptr (JsonBuilder) builder = NULL;
+  g_autoptr (GList) names         = NULL;
+  g_autoptr (JsonNode) root       = NULL;
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+
+  g_mutex_lock (&stats_mutex);
+
+  names = dup_sorted_names ();
+
+  json_builder_set_member_name (builder, "timers");
+  json_builder_begin_object (builder);
+  for (GList *l = names; l != NULL; l = l->next)
+    {
+      Stat *stat = NULL;
+
+      stat = g_hash_table_lookup (stats, l->data);
+      if (!stat->timer)
+        continue;
+
+      json_builder_set_member_name (builder, l->data);
+      json_builder_begin_object (builder);
+      json_builder_set_member_name (builder, "samples");
+      json_builder_add_int_value (builder, stat->samples);
+      json_builder_set_member_name (builder, "total-us");
+      json_builder_add_int_value (builder, stat->total);
+      json_builder_set_member_name (builder, "last-us");
+      json_builder_add_int_value (builder, stat->last);
+      json_builder_set_member_name (builder, "mean-us");
+      json_builder_add_double_value (builder, (double) stat->total / (double) stat->samples);
+      json_builder_set_member_name (builder, "max-us");
+      json_builder_add_int_value (builder, stat->max);
+      json_builder_end_object (builder);
+    }
+  json_builder_end_object (builder);
+
+  json_builder_set_member_name (builder, "counters");
+  json_builder_begin_object (builder);
+  for (GList *l = names; l != NULL; l = l->next)
+    {
+      Stat *stat = NULL;
+
+      stat = g_hash_table_lookup (stats, l->data);
+      if (stat->timer)
+        continue;
+
+      json_builder_set_member_name (builder, l->data);
+      json_builder_begin_object (builder);
+      json_builder_set_member_name (builder, "samples");
+      json_builder_add_int_value (builder, stat->samples);
+      json_builder_set_member_name (builder, "total");
+      json_builder_add_int_value (builder, stat->total);
+      json_builder_set_member_name (builder, "last");
+      json_builder_add_int_value (builder, stat->last);
+      json_builder_set_member_name (builder, "max");
+      json_builder_add_int_value (builder, stat->max);
+      json_builder_end_object (builder);
+    }
+  json_builder_end_object (builder);
+
+  g_mutex_unlock (&stats_mutex);
+
+  json_builder_end_object (builder);
+  root = json_builder_get_root (builder);
+
+  return json_to_string (root, TRUE);
+}
+
+static void
+record (const char *name,
+        gboolean    timer,
+        gint64      value)
+{
+  Stat *stat = NULL;
+
+  if (g_atomic_int_get (&stats_enabled) == 0)
+    return;
+
+  g_mutex_lock (&stats_mutex);
+
+  if (stats == NULL)
+    stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  stat = g_hash_table_lookup (stats, name);
+  if (stat == NULL)
+    {
+      stat        = g_new0 (typeof (*stat), 1);
+      stat->timer = timer;
+      g_hash_table_replace (stats, g_strdup (name), stat);
+    }
+
+  stat->samples++;
+  stat->total += value;
+  stat->last = value;
+  stat->max  = MAX (stat->max, value);
+
+  g_mutex_unlock (&stats_mutex);
+}
+
+#ifdef HAVE_SYSPROF
+static gboolean
+trace_marks_enabled (void)
+{
+  static gsize    initialized = 0;
+  static gboolean enabled     = FALSE;
+
+  if (g_once_init_enter (&initialized))
+    {
+      enabled = g_getenv ("GCV_TRACE_MARKS") != NULL;
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return enabled;
+}
+#endif
+
+/* Must hold the lock */
+static GList *
+dup_sorted_names (void)
+{
+  if (stats == NULL)
+    return NULL;
+
+  return g_list_sort (
+      g_hash_table_get_keys (stats),
+      (GCompareFunc) g_strcmp0);
+}
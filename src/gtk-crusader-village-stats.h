@@ -0,0 +1,57 @@
+/* gtk-crusader-village-stats.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Recording is a no-op until enabled, calls nest */
+void
+gcv_stats_enable (void);
+
+void
+gcv_stats_disable (void);
+
+void
+gcv_stats_record_time (const char *name,
+                       gint64      begin_time);
+
+void
+gcv_stats_add_count (const char *name,
+                     gint64      amount);
+
+gboolean
+gcv_stats_lookup (const char *name,
+                  gint64     *samples,
+                  gint64     *total,
+                  gint64     *max);
+
+void
+gcv_stats_reset (void);
+
+char *
+gcv_stats_dump_text (void);
+
+char *
+gcv_stats_dump_json (void);
+
+G_END_DECLS
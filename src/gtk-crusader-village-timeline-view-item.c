@@ -23,6 +23,7 @@
 #include "gtk-crusader-village-item-stroke.h"
 #include "gtk-crusader-village-item.h"
 #include "gtk-crusader-village-timeline-view-item.h"
+#include "gtk-crusader-village-validator.h"
 
 struct _GcvTimelineViewItem
 {
@@ -35,9 +36,12 @@ struct _GcvTimelineViewItem
   gboolean inactive;
   gboolean insert_mode;
 
+  GcvDiagnosticKind problems;
+
   /* Template widgets */
   GtkImage *invisible_indicator;
   GtkImage *insert_indicator;
+  GtkImage *problem_indicator;
   GtkLabel *position_label;
   GtkLabel *left_label;
   GtkLabel *center_label;
@@ -56,6 +60,7 @@ enum
   PROP_SELECTED,
   PROP_INACTIVE,
   PROP_INSERT_MODE,
+  PROP_PROBLEMS,
 
   LAST_PROP
 };
@@ -100,6 +105,9 @@ gcv_timeline_view_item_get_property (GObject    *object,
     case PROP_INSERT_MODE:
       g_value_set_boolean (value, self->insert_mode);
       break;
+    case PROP_PROBLEMS:
+      g_value_set_flags (value, self->problems);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -193,6 +201,18 @@ gcv_timeline_view_item_set_property (GObject      *object,
       self->insert_mode = g_value_get_boolean (value);
       update_indicators (self);
       break;
+    case PROP_PROBLEMS:
+      {
+        g_autofree char *tooltip = NULL;
+
+        self->problems = g_value_get_flags (value);
+
+        if (self->problems != 0)
+          tooltip = gcv_diagnostic_kind_describe (self->problems);
+        gtk_widget_set_tooltip_text (GTK_WIDGET (self->problem_indicator), tooltip);
+        update_indicators (self);
+      }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -248,12 +268,22 @@ gcv_timeline_view_item_class_init (GcvTimelineViewItemClass *klass)
           FALSE,
           G_PARAM_READWRITE);
 
+  props[PROP_PROBLEMS] =
+      g_param_spec_flags (
+          "problems",
+          "Problems",
+          "The kinds of problems the validator found with the stroke",
+          GCV_TYPE_DIAGNOSTIC_KIND,
+          0,
+          G_PARAM_READWRITE);
+
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
   gtk_widget_class_set_template_from_resource (widget_class, "/am/kolunmi/Gcv/gtk-crusader-village-timeline-view-item.ui");
   gtk_widget_class_bind_template_child (widget_class, GcvTimelineViewItem, invisible_indicator);
   gtk_widget_class_bind_template_child (widget_class, GcvTimelineViewItem, position_label);
   gtk_widget_class_bind_template_child (widget_class, GcvTimelineViewItem, insert_indicator);
+  gtk_widget_class_bind_template_child (widget_class, GcvTimelineViewItem, problem_indicator);
   gtk_widget_class_bind_template_child (widget_class, GcvTimelineViewItem, left_label);
   gtk_widget_class_bind_template_child (widget_class, GcvTimelineViewItem, center_label);
   gtk_widget_class_bind_template_child (widget_class, GcvTimelineViewItem, right_label);
@@ -271,4 +301,5 @@ update_indicators (GcvTimelineViewItem *self)
 {
   gtk_widget_set_visible (GTK_WIDGET (self->invisible_indicator), self->inactive);
   gtk_widget_set_visible (GTK_WIDGET (self->insert_indicator), self->selected || self->insert_mode);
+  gtk_widget_set_visible (GTK_WIDGET (self->problem_indicator), self->problems != 0);
 }
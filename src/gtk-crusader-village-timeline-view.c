@@ -24,6 +24,7 @@
 #include "gtk-crusader-village-map-handle.h"
 #include "gtk-crusader-village-timeline-view-item.h"
 #include "gtk-crusader-village-timeline-view.h"
+#include "gtk-crusader-village-validator.h"
 
 struct _GcvTimelineView
 {
@@ -35,6 +36,7 @@ struct _GcvTimelineView
 
   GcvMapHandle *handle;
   GListModel   *model;
+  GcvValidator *validator;
 
   guint playback_handle;
 
@@ -53,6 +55,7 @@ enum
   PROP_0,
 
   PROP_MAP_HANDLE,
+  PROP_VALIDATOR,
 
   LAST_PROP
 };
@@ -79,6 +82,10 @@ listitem_cursor_changed (GcvMapHandle *handle,
                          GParamSpec   *pspec,
                          GtkListItem  *list_item);
 
+static void
+listitem_problems_changed (GcvValidator *validator,
+                           GtkListItem  *list_item);
+
 static GdkContentProvider *
 listitem_drag_prepare (GtkDragSource   *source,
                        double           x,
@@ -171,6 +178,7 @@ gcv_timeline_view_dispose (GObject *object)
           self->handle, lock_hint_changed, self);
     }
   g_clear_object (&self->handle);
+  g_clear_object (&self->validator);
 
   g_clear_handle_id (&self->playback_handle, g_source_remove);
 
@@ -190,6 +198,9 @@ gcv_timeline_view_get_property (GObject    *object,
     case PROP_MAP_HANDLE:
       g_value_set_object (value, self->handle);
       break;
+    case PROP_VALIDATOR:
+      g_value_set_object (value, self->validator);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -247,6 +258,14 @@ gcv_timeline_view_set_property (GObject      *object,
         update_ui (self);
       }
       break;
+    case PROP_VALIDATOR:
+      /* Rebind so list items connect to the new validator */
+      g_list_store_remove_all (self->wrapper_store);
+      g_clear_object (&self->validator);
+      self->validator = g_value_dup_object (value);
+      if (self->model != NULL)
+        g_list_store_append (self->wrapper_store, self->model);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -270,6 +289,14 @@ gcv_timeline_view_class_init (GcvTimelineViewClass *klass)
           GCV_TYPE_MAP_HANDLE,
           G_PARAM_READWRITE);
 
+  props[PROP_VALIDATOR] =
+      g_param_spec_object (
+          "validator",
+          "Validator",
+          "The validator whose findings are shown next to each stroke",
+          GCV_TYPE_VALIDATOR,
+          G_PARAM_READWRITE);
+
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
   gtk_widget_class_set_template_from_resource (widget_class, "/am/kolunmi/Gcv/gtk-crusader-village-timeline-view.ui");
@@ -395,6 +422,13 @@ bind_listitem (GtkListItemFactory *factory,
                         G_CALLBACK (listitem_cursor_changed), list_item);
       g_signal_connect (self->handle, "notify::cursor-len",
                         G_CALLBACK (listitem_cursor_changed), list_item);
+
+      if (self->validator != NULL)
+        {
+          listitem_problems_changed (self->validator, list_item);
+          g_signal_connect (self->validator, "changed",
+                            G_CALLBACK (listitem_problems_changed), list_item);
+        }
     }
 }
 
@@ -420,10 +454,14 @@ unbind_listitem (GtkListItemFactory *factory,
           "selected", FALSE,
           "inactive", FALSE,
           "insert-mode", FALSE,
+          "problems", 0,
           NULL);
 
       g_signal_handlers_disconnect_by_func (
           self->handle, listitem_cursor_changed, list_item);
+      if (self->validator != NULL)
+        g_signal_handlers_disconnect_by_func (
+            self->validator, listitem_problems_changed, list_item);
     }
 }
 
@@ -457,6 +495,20 @@ listitem_cursor_changed (GcvMapHandle *handle,
       NULL);
 }
 
+static void
+listitem_problems_changed (GcvValidator *validator,
+                           GtkListItem  *list_item)
+{
+  GtkWidget *view_item = NULL;
+
+  view_item = gtk_list_item_get_child (list_item);
+  g_object_set (
+      view_item,
+      "problems", gcv_validator_get_problems (
+          validator, gtk_list_item_get_position (list_item)),
+      NULL);
+}
+
 static GdkContentProvider *
 listitem_drag_prepare (GtkDragSource   *source,
                        double           x,
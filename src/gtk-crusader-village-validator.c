@@ -0,0 +1,942 @@
+/* gtk-crusader-village-validator.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "gtk-crusader-village-item-stroke.h"
+#include "gtk-crusader-village-item.h"
+#include "gtk-crusader-village-map.h"
+#include "gtk-crusader-village-stats.h"
+#include "gtk-crusader-village-validator.h"
+
+#define CANCEL_CHECK_INTERVAL 256
+
+/* Units may stand on buildings, so this is only
+ * set for the impassable parts of everything else
+ */
+#define TILE_IMPASSABLE (1 << 0)
+#define TILE_KEEP       (1 << 1)
+
+G_DEFINE_FLAGS_TYPE (
+    GcvDiagnosticKind,
+    gcv_diagnostic_kind,
+    G_DEFINE_ENUM_VALUE (GCV_DIAGNOSTIC_OVERLAP, "overlap"),
+    G_DEFINE_ENUM_VALUE (GCV_DIAGNOSTIC_OUT_OF_BOUNDS, "out-of-bounds"),
+    G_DEFINE_ENUM_VALUE (GCV_DIAGNOSTIC_INVALID_UNIT, "invalid-unit"),
+    G_DEFINE_ENUM_VALUE (GCV_DIAGNOSTIC_KEEP_BLOCKED, "keep-blocked"),
+    G_DEFINE_ENUM_VALUE (GCV_DIAGNOSTIC_EMPTY_STROKE, "empty-stroke"))
+
+/* Indices of the bits in GcvDiagnosticKind */
+enum
+{
+  FINDING_OVERLAP,
+  FINDING_OUT_OF_BOUNDS,
+  FINDING_INVALID_UNIT,
+  FINDING_KEEP_BLOCKED,
+  FINDING_EMPTY_STROKE,
+
+  N_FINDINGS
+};
+
+struct _GcvDiagnostic
+{
+  GObject parent_instance;
+
+  GcvDiagnosticKind kind;
+  guint             stroke;
+  int               x;
+  int               y;
+  guint             count;
+};
+
+G_DEFINE_FINAL_TYPE (GcvDiagnostic, gcv_diagnostic, G_TYPE_OBJECT)
+
+enum
+{
+  DIAGNOSTIC_PROP_0,
+
+  DIAGNOSTIC_PROP_KIND,
+  DIAGNOSTIC_PROP_STROKE,
+  DIAGNOSTIC_PROP_X,
+  DIAGNOSTIC_PROP_Y,
+  DIAGNOSTIC_PROP_COUNT,
+  DIAGNOSTIC_PROP_MESSAGE,
+
+  DIAGNOSTIC_LAST_PROP
+};
+
+static GParamSpec *diagnostic_props[DIAGNOSTIC_LAST_PROP] = { 0 };
+
+/* Worker side snapshot of one stroke. Strokes are not
+ * changed once they are in the timeline, so the instance
+ * array is shared rather than copied.
+ */
+typedef struct
+{
+  GArray     *instances;
+  GcvItemKind kind;
+  int         tile_width;
+  int         tile_height;
+  int         impassable_x;
+  int         impassable_y;
+  int         impassable_w;
+  int         impassable_h;
+} StrokeInput;
+
+/* What the strokes before `n_strokes` left on the map */
+typedef struct
+{
+  int      width;
+  int      height;
+  guint    n_strokes;
+  guint32 *owners;
+  guint8  *tiles;
+} ValidateState;
+
+typedef struct
+{
+  guint count;
+  int   x;
+  int   y;
+} Finding;
+
+typedef struct
+{
+  GcvDiagnosticKind kind;
+  guint             stroke;
+  int               x;
+  int               y;
+  guint             count;
+} DiagnosticData;
+
+typedef struct
+{
+  int            width;
+  int            height;
+  guint          first;
+  guint          from;
+  guint          n_strokes;
+  GArray        *strokes;
+  ValidateState *state;
+
+  GArray *diagnostics;
+  GArray *problems;
+} ValidateJob;
+
+struct _GcvValidator
+{
+  GObject parent_instance;
+
+  GcvMapHandle *handle;
+  GcvMap       *map;
+  GListModel   *model;
+
+  GListStore *diagnostics;
+  GArray     *problems;
+
+  ValidateState *state;
+  GCancellable  *cancellable;
+  guint          dirty_from;
+  guint          edited_from;
+};
+
+G_DEFINE_FINAL_TYPE (GcvValidator, gcv_validator, G_TYPE_OBJECT)
+
+enum
+{
+  PROP_0,
+
+  PROP_MAP_HANDLE,
+  PROP_DIAGNOSTICS,
+
+  LAST_PROP
+};
+
+static GParamSpec *props[LAST_PROP] = { 0 };
+
+enum
+{
+  SIGNAL_CHANGED,
+
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS] = { 0 };
+
+static void
+model_changed (GListModel   *model,
+               guint         position,
+               guint         removed,
+               guint         added,
+               GcvValidator *self);
+
+static void
+dimensions_changed (GcvMap       *map,
+                    GParamSpec   *pspec,
+                    GcvValidator *self);
+
+static void
+queue_validate (GcvValidator *self,
+                guint         position);
+
+static void
+start_job (GcvValidator *self);
+
+static void
+validate_async_thread (GTask        *task,
+                       gpointer      object,
+                       gpointer      task_data,
+                       GCancellable *cancellable);
+
+static void
+validate_done (GObject      *source_object,
+               GAsyncResult *res,
+               gpointer      data);
+
+static void
+check_stroke (ValidateJob   *job,
+              ValidateState *state,
+              guint          index,
+              gboolean       report);
+
+static void
+reset_state (ValidateState *state,
+             int            width,
+             int            height);
+
+static void
+destroy_state (gpointer ptr);
+
+static void
+destroy_job (gpointer ptr);
+
+static void
+clear_stroke_input (gpointer ptr);
+
+static void
+gcv_diagnostic_get_property (GObject    *object,
+                             guint       prop_id,
+                             GValue     *value,
+                             GParamSpec *pspec)
+{
+  GcvDiagnostic *self = GCV_DIAGNOSTIC (object);
+
+  switch (prop_id)
+    {
+    case DIAGNOSTIC_PROP_KIND:
+      g_value_set_flags (value, self->kind);
+      break;
+    case DIAGNOSTIC_PROP_STROKE:
+      g_value_set_uint (value, self->stroke);
+      break;
+    case DIAGNOSTIC_PROP_X:
+      g_value_set_int (value, self->x);
+      break;
+    case DIAGNOSTIC_PROP_Y:
+      g_value_set_int (value, self->y);
+      break;
+    case DIAGNOSTIC_PROP_COUNT:
+      g_value_set_uint (value, self->count);
+      break;
+    case DIAGNOSTIC_PROP_MESSAGE:
+      g_value_take_string (value, gcv_diagnostic_kind_describe (self->kind));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gcv_diagnostic_class_init (GcvDiagnosticClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = gcv_diagnostic_get_property;
+
+  diagnostic_props[DIAGNOSTIC_PROP_KIND] =
+      g_param_spec_flags (
+          "kind",
+          "Kind",
+          "What is wrong",
+          GCV_TYPE_DIAGNOSTIC_KIND,
+          GCV_DIAGNOSTIC_OVERLAP,
+          G_PARAM_READABLE);
+
+  diagnostic_props[DIAGNOSTIC_PROP_STROKE] =
+      g_param_spec_uint (
+          "stroke",
+          "Stroke",
+          "The position of the offending stroke in the timeline",
+          0, G_MAXUINT, 0,
+          G_PARAM_READABLE);
+
+  diagnostic_props[DIAGNOSTIC_PROP_X] =
+      g_param_spec_int (
+          "x",
+          "X",
+          "The first offending tile's x coordinate, or -1",
+          -1, G_MAXINT, -1,
+          G_PARAM_READABLE);
+
+  diagnostic_props[DIAGNOSTIC_PROP_Y] =
+      g_param_spec_int (
+          "y",
+          "Y",
+          "The first offending tile's y coordinate, or -1",
+          -1, G_MAXINT, -1,
+          G_PARAM_READABLE);
+
+  diagnostic_props[DIAGNOSTIC_PROP_COUNT] =
+      g_param_spec_uint (
+          "count",
+          "Count",
+          "How many tiles or instances are affected",
+          0, G_MAXUINT, 0,
+          G_PARAM_READABLE);
+
+  diagnostic_props[DIAGNOSTIC_PROP_MESSAGE] =
+      g_param_spec_string (
+          "message",
+          "Message",
+          "A human readable description of the problem",
+          NULL,
+          G_PARAM_READABLE);
+
+  g_object_class_install_properties (object_class, DIAGNOSTIC_LAST_PROP, diagnostic_props);
+}
+
+static void
+gcv_diagnostic_init (GcvDiagnostic *self)
+{
+  self->x = -1;
+  self->y = -1;
+}
+
+static void
+gcv_validator_dispose (GObject *object)
+{
+  GcvValidator *self = GCV_VALIDATOR (object);
+
+  if (self->cancellable != NULL)
+    g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+
+  if (self->model != NULL)
+    g_signal_handlers_disconnect_by_func (self->model, model_changed, self);
+  g_clear_object (&self->model);
+  if (self->map != NULL)
+    g_signal_handlers_disconnect_by_func (self->map, dimensions_changed, self);
+  g_clear_object (&self->map);
+  g_clear_object (&self->handle);
+
+  g_clear_object (&self->diagnostics);
+  g_clear_pointer (&self->problems, g_array_unref);
+  g_clear_pointer (&self->state, destroy_state);
+
+  G_OBJECT_CLASS (gcv_validator_parent_class)->dispose (object);
+}
+
+static void
+gcv_validator_get_property (GObject    *object,
+                            guint       prop_id,
+                            GValue     *value,
+                            GParamSpec *pspec)
+{
+  GcvValidator *self = GCV_VALIDATOR (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAP_HANDLE:
+      g_value_set_object (value, self->handle);
+      break;
+    case PROP_DIAGNOSTICS:
+      g_value_set_object (value, self->diagnostics);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gcv_validator_set_property (GObject      *object,
+                            guint         prop_id,
+                            const GValue *value,
+                            GParamSpec   *pspec)
+{
+  GcvValidator *self = GCV_VALIDATOR (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAP_HANDLE:
+      {
+        /* A job in flight belongs to the old map */
+        if (self->cancellable != NULL)
+          g_cancellable_cancel (self->cancellable);
+        g_clear_object (&self->cancellable);
+        g_clear_pointer (&self->state, destroy_state);
+
+        if (self->model != NULL)
+          g_signal_handlers_disconnect_by_func (self->model, model_changed, self);
+        g_clear_object (&self->model);
+        if (self->map != NULL)
+          g_signal_handlers_disconnect_by_func (self->map, dimensions_changed, self);
+        g_clear_object (&self->map);
+        g_clear_object (&self->handle);
+
+        g_list_store_remove_all (self->diagnostics);
+        g_array_set_size (self->problems, 0);
+
+        self->handle = g_value_dup_object (value);
+
+        if (self->handle != NULL)
+          {
+            g_object_get (
+                self->handle,
+                "map", &self->map,
+                "model", &self->model,
+                NULL);
+
+            if (self->map != NULL && self->model != NULL)
+              {
+                g_signal_connect (self->model, "items-changed",
+                                  G_CALLBACK (model_changed), self);
+                g_signal_connect (self->map, "notify::width",
+                                  G_CALLBACK (dimensions_changed), self);
+                g_signal_connect (self->map, "notify::height",
+                                  G_CALLBACK (dimensions_changed), self);
+
+                g_array_set_size (self->problems, g_list_model_get_n_items (self->model));
+                queue_validate (self, 0);
+              }
+          }
+
+        g_signal_emit (self, signals[SIGNAL_CHANGED], 0);
+      }
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gcv_validator_class_init (GcvValidatorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose      = gcv_validator_dispose;
+  object_class->get_property = gcv_validator_get_property;
+  object_class->set_property = gcv_validator_set_property;
+
+  props[PROP_MAP_HANDLE] =
+      g_param_spec_object (
+          "map-handle",
+          "Map Handle",
+          "The map handle whose strokes are validated",
+          GCV_TYPE_MAP_HANDLE,
+          G_PARAM_READWRITE);
+
+  props[PROP_DIAGNOSTICS] =
+      g_param_spec_object (
+          "diagnostics",
+          "Diagnostics",
+          "A list of `GcvDiagnostic`s ordered by stroke",
+          G_TYPE_LIST_MODEL,
+          G_PARAM_READABLE);
+
+  g_object_class_install_properties (object_class, LAST_PROP, props);
+
+  signals[SIGNAL_CHANGED] =
+      g_signal_new (
+          "changed",
+          G_TYPE_FROM_CLASS (klass),
+          G_SIGNAL_RUN_LAST,
+          0,
+          NULL, NULL, NULL,
+          G_TYPE_NONE, 0);
+}
+
+static void
+gcv_validator_init (GcvValidator *self)
+{
+  self->diagnostics = g_list_store_new (GCV_TYPE_DIAGNOSTIC);
+  self->problems    = g_array_new (FALSE, TRUE, sizeof (guint8));
+  self->dirty_from  = G_MAXUINT;
+  self->edited_from = G_MAXUINT;
+}
+
+GListModel *
+gcv_validator_get_diagnostics (GcvValidator *self)
+{
+  g_return_val_if_fail (GCV_IS_VALIDATOR (self), NULL);
+  return G_LIST_MODEL (self->diagnostics);
+}
+
+/* Results for a stroke are reset to nothing until the
+ * job covering its change comes back
+ */
+GcvDiagnosticKind
+gcv_validator_get_problems (GcvValidator *self,
+                            guint         position)
+{
+  g_return_val_if_fail (GCV_IS_VALIDATOR (self), 0);
+
+  if (position >= self->problems->len)
+    return 0;
+  return g_array_index (self->problems, guint8, position);
+}
+
+char *
+gcv_diagnostic_kind_describe (GcvDiagnosticKind kinds)
+{
+  g_autoptr (GStrvBuilder) builder = NULL;
+  g_auto (GStrv) lines             = NULL;
+
+  builder = g_strv_builder_new ();
+  if (kinds & GCV_DIAGNOSTIC_OVERLAP)
+    g_strv_builder_add (builder, "Overlaps earlier strokes");
+  if (kinds & GCV_DIAGNOSTIC_OUT_OF_BOUNDS)
+    g_strv_builder_add (builder, "Has instances outside of the map");
+  if (kinds & GCV_DIAGNOSTIC_INVALID_UNIT)
+    g_strv_builder_add (builder, "Places units on impassable tiles");
+  if (kinds & GCV_DIAGNOSTIC_KEEP_BLOCKED)
+    g_strv_builder_add (builder, "Blocks the keep");
+  if (kinds & GCV_DIAGNOSTIC_EMPTY_STROKE)
+    g_strv_builder_add (builder, "Is empty");
+  lines = g_strv_builder_end (builder);
+
+  return g_strjoinv ("\n", lines);
+}
+
+static void
+model_changed (GListModel   *model,
+               guint         position,
+               guint         removed,
+               guint         added,
+               GcvValidator *self)
+{
+  guint old_len = 0;
+
+  /* Keep the per stroke results lined up with the
+   * timeline until fresh ones arrive
+   */
+  g_array_remove_range (self->problems, position, MIN (removed, self->problems->len - position));
+  old_len = self->problems->len;
+  g_array_set_size (self->problems, old_len + added);
+  memmove (self->problems->data + position + added,
+           self->problems->data + position,
+           old_len - position);
+  memset (self->problems->data + position, 0, added);
+
+  self->edited_from = MIN (self->edited_from, position);
+  g_signal_emit (self, signals[SIGNAL_CHANGED], 0);
+  queue_validate (self, position);
+}
+
+static void
+dimensions_changed (GcvMap       *map,
+                    GParamSpec   *pspec,
+                    GcvValidator *self)
+{
+  self->edited_from = 0;
+  g_clear_pointer (&self->state, destroy_state);
+  queue_validate (self, 0);
+}
+
+static void
+queue_validate (GcvValidator *self,
+                guint         position)
+{
+  self->dirty_from = MIN (self->dirty_from, position);
+
+  /* Jobs run one at a time, the next one picks up
+   * whatever changed in the meantime
+   */
+  if (self->cancellable == NULL)
+    start_job (self);
+}
+
+static void
+start_job (GcvValidator *self)
+{
+  ValidateJob *job       = NULL;
+  gboolean     replay    = FALSE;
+  g_autoptr (GTask) task = NULL;
+
+  job            = g_new0 (typeof (*job), 1);
+  job->n_strokes = g_list_model_get_n_items (self->model);
+  job->from      = MIN (self->dirty_from, job->n_strokes);
+  g_object_get (
+      self->map,
+      "width", &job->width,
+      "height", &job->height,
+      NULL);
+
+  /* The planes can only be extended, an edit before their
+   * end means replaying everything in front of it
+   */
+  replay = self->state == NULL ||
+           self->state->width != job->width ||
+           self->state->height != job->height ||
+           self->state->n_strokes != job->from;
+  if (replay)
+    g_clear_pointer (&self->state, destroy_state);
+
+  job->state       = g_steal_pointer (&self->state);
+  job->first       = replay ? 0 : job->from;
+  job->strokes     = g_array_sized_new (FALSE, TRUE, sizeof (StrokeInput), job->n_strokes - job->first);
+  job->diagnostics = g_array_new (FALSE, FALSE, sizeof (DiagnosticData));
+  job->problems    = g_array_new (FALSE, TRUE, sizeof (guint8));
+  g_array_set_clear_func (job->strokes, clear_stroke_input);
+
+  for (guint i = job->first; i < job->n_strokes; i++)
+    {
+      g_autoptr (GcvItemStroke) stroke = NULL;
+      g_autoptr (GcvItem) item         = NULL;
+      StrokeInput input                = { 0 };
+
+      stroke = g_list_model_get_item (self->model, i);
+      g_object_get (
+          stroke,
+          "item", &item,
+          "instances", &input.instances,
+          NULL);
+
+      input.kind = GCV_ITEM_KIND_UNIT;
+      if (item != NULL)
+        {
+          const GcvItemInfo *info = NULL;
+
+          info               = gcv_item_get_info (item);
+          input.kind         = info->kind;
+          input.tile_width   = info->tile_width;
+          input.tile_height  = info->tile_height;
+          input.impassable_x = info->tile_impassable_rect_x;
+          input.impassable_y = info->tile_impassable_rect_y;
+          input.impassable_w = info->tile_impassable_rect_w;
+          input.impassable_h = info->tile_impassable_rect_h;
+        }
+      input.tile_width  = MAX (input.tile_width, 1);
+      input.tile_height = MAX (input.tile_height, 1);
+
+      g_array_append_val (job->strokes, input);
+    }
+
+  self->dirty_from  = G_MAXUINT;
+  self->edited_from = G_MAXUINT;
+  self->cancellable = g_cancellable_new ();
+
+  task = g_task_new (self, self->cancellable, validate_done, NULL);
+  g_task_set_source_tag (task, start_job);
+  g_task_set_task_data (task, job, destroy_job);
+  g_task_set_priority (task, G_PRIORITY_LOW);
+  g_task_run_in_thread (task, validate_async_thread);
+}
+
+static void
+validate_async_thread (GTask        *task,
+                       gpointer      object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
+{
+  ValidateJob *job        = task_data;
+  gint64       begin_time = 0;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  begin_time = g_get_monotonic_time ();
+
+  if (job->state == NULL)
+    {
+      job->state = g_new0 (typeof (*job->state), 1);
+      reset_state (job->state, job->width, job->height);
+    }
+
+  for (guint i = job->first; i < job->n_strokes; i++)
+    {
+      if ((i - job->first) % CANCEL_CHECK_INTERVAL == 0 &&
+          g_task_return_error_if_cancelled (task))
+        return;
+
+      check_stroke (job, job->state, i, i >= job->from);
+    }
+  job->state->n_strokes = job->n_strokes;
+
+  gcv_stats_add_count ("validator.replayed", job->from - job->first);
+  gcv_stats_add_count ("validator.checked", job->n_strokes - job->from);
+  gcv_stats_record_time ("validator.job", begin_time);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+validate_done (GObject      *source_object,
+               GAsyncResult *res,
+               gpointer      data)
+{
+  GcvValidator *self             = GCV_VALIDATOR (source_object);
+  ValidateJob  *job              = NULL;
+  g_autoptr (GError) local_error = NULL;
+  guint keep                     = 0;
+  guint n_diagnostics            = 0;
+  g_autoptr (GPtrArray) fresh    = NULL;
+
+  job = g_task_get_task_data (G_TASK (res));
+
+  /* Cancelled jobs were replaced when they were cancelled */
+  if (!g_task_propagate_boolean (G_TASK (res), &local_error))
+    return;
+
+  g_clear_object (&self->cancellable);
+
+  if (self->edited_from < job->n_strokes)
+    {
+      /* Something the job looked at changed under it */
+      self->dirty_from = MIN (self->dirty_from, job->from);
+      start_job (self);
+      return;
+    }
+
+  self->state = g_steal_pointer (&job->state);
+
+  for (guint i = 0; i < job->problems->len; i++)
+    g_array_index (self->problems, guint8, job->from + i) =
+        g_array_index (job->problems, guint8, i);
+
+  n_diagnostics = g_list_model_get_n_items (G_LIST_MODEL (self->diagnostics));
+  for (keep = n_diagnostics; keep > 0; keep--)
+    {
+      g_autoptr (GcvDiagnostic) diagnostic = NULL;
+
+      diagnostic = g_list_model_get_item (G_LIST_MODEL (self->diagnostics), keep - 1);
+      if (diagnostic->stroke < job->from)
+        break;
+    }
+
+  fresh = g_ptr_array_new_full (job->diagnostics->len, g_object_unref);
+  for (guint i = 0; i < job->diagnostics->len; i++)
+    {
+      DiagnosticData *diagnostic_data = NULL;
+      GcvDiagnostic  *diagnostic      = NULL;
+
+      diagnostic_data    = &g_array_index (job->diagnostics, DiagnosticData, i);
+      diagnostic         = g_object_new (GCV_TYPE_DIAGNOSTIC, NULL);
+      diagnostic->kind   = diagnostic_data->kind;
+      diagnostic->stroke = diagnostic_data->stroke;
+      diagnostic->x      = diagnostic_data->x;
+      diagnostic->y      = diagnostic_data->y;
+      diagnostic->count  = diagnostic_data->count;
+      g_ptr_array_add (fresh, diagnostic);
+    }
+
+  g_list_store_splice (self->diagnostics, keep, n_diagnostics - keep,
+                       fresh->pdata, fresh->len);
+  g_signal_emit (self, signals[SIGNAL_CHANGED], 0);
+
+  if (self->dirty_from != G_MAXUINT)
+    start_job (self);
+}
+
+static inline void
+note (Finding *finding,
+      int      x,
+      int      y)
+{
+  if (finding->count++ == 0)
+    {
+      finding->x = x;
+      finding->y = y;
+    }
+}
+
+static void
+check_stroke (ValidateJob   *job,
+              ValidateState *state,
+              guint          index,
+              gboolean       report)
+{
+  StrokeInput *input                = NULL;
+  Finding      findings[N_FINDINGS] = { 0 };
+  guint8       problems             = 0;
+
+  input = &g_array_index (job->strokes, StrokeInput, index - job->first);
+
+  if (input->instances == NULL || input->instances->len == 0)
+    note (&findings[FINDING_EMPTY_STROKE], -1, -1);
+
+  for (guint i = 0; input->instances != NULL && i < input->instances->len; i++)
+    {
+      GcvItemStrokeInstance instance = { 0 };
+
+      instance = g_array_index (input->instances, GcvItemStrokeInstance, i);
+
+      if (instance.x < 0 ||
+          instance.y < 0 ||
+          instance.x + input->tile_width > state->width ||
+          instance.y + input->tile_height > state->height)
+        {
+          note (&findings[FINDING_OUT_OF_BOUNDS], instance.x, instance.y);
+          continue;
+        }
+
+      if (input->kind == GCV_ITEM_KIND_UNIT)
+        {
+          /* Units don't take up space, they only need
+           * somewhere to stand
+           */
+          if (state->tiles[instance.y * state->width + instance.x] != 0)
+            note (&findings[FINDING_INVALID_UNIT], instance.x, instance.y);
+          continue;
+        }
+
+      for (int y = 0; y < input->tile_height; y++)
+        {
+          for (int x = 0; x < input->tile_width; x++)
+            {
+              guint    idx        = 0;
+              gboolean impassable = FALSE;
+
+              idx = (instance.y + y) * state->width + (instance.x + x);
+
+              if (state->owners[idx] != 0)
+                note (&findings[FINDING_OVERLAP], instance.x + x, instance.y + y);
+              else
+                state->owners[idx] = index + 1;
+
+              if (state->tiles[idx] & TILE_KEEP)
+                note (&findings[FINDING_KEEP_BLOCKED], instance.x + x, instance.y + y);
+
+              impassable = input->kind != GCV_ITEM_KIND_BUILDING &&
+                           (input->kind == GCV_ITEM_KIND_MOAT ||
+                            (x >= input->impassable_x &&
+                             y >= input->impassable_y &&
+                             x < input->impassable_x + input->impassable_w &&
+                             y < input->impassable_y + input->impassable_h));
+              if (impassable)
+                state->tiles[idx] |= TILE_IMPASSABLE;
+            }
+        }
+    }
+
+  if (!report)
+    return;
+
+  for (guint i = 0; i < N_FINDINGS; i++)
+    {
+      DiagnosticData diagnostic = { 0 };
+
+      if (findings[i].count == 0)
+        continue;
+
+      diagnostic.kind   = 1 << i;
+      diagnostic.stroke = index;
+      diagnostic.x      = findings[i].x;
+      diagnostic.y      = findings[i].y;
+      diagnostic.count  = findings[i].count;
+      g_array_append_val (job->diagnostics, diagnostic);
+
+      problems |= 1 << i;
+    }
+
+  g_array_append_val (job->problems, problems);
+}
+
+static void
+reset_state (ValidateState *state,
+             int            width,
+             int            height)
+{
+  gsize                   size           = 0;
+  const GcvMapKeepCorner *keep_outline   = NULL;
+  guint                   n_keep_corners = 0;
+  int                     keep_x0        = 0;
+  int                     keep_y0        = 0;
+  int                     keep_x1        = 0;
+  int                     keep_y1        = 0;
+
+  size = (gsize) MAX (width, 0) * MAX (height, 0);
+
+  g_clear_pointer (&state->owners, g_free);
+  g_clear_pointer (&state->tiles, g_free);
+  state->width     = MAX (width, 0);
+  state->height    = MAX (height, 0);
+  state->n_strokes = 0;
+  state->owners    = g_new0 (guint32, size);
+  state->tiles     = g_new0 (guint8, size);
+
+  keep_outline = gcv_map_get_keep_outline (&n_keep_corners);
+  for (guint i = 0; i < n_keep_corners; i++)
+    {
+      keep_x0 = MIN (keep_x0, keep_outline[i].x);
+      keep_y0 = MIN (keep_y0, keep_outline[i].y);
+      keep_x1 = MAX (keep_x1, keep_outline[i].x);
+      keep_y1 = MAX (keep_y1, keep_outline[i].y);
+    }
+
+  for (int y = keep_y0; y < keep_y1; y++)
+    {
+      for (int x = keep_x0; x < keep_x1; x++)
+        {
+          int tile_x = 0;
+          int tile_y = 0;
+
+          if (!gcv_map_is_keep_tile (x, y))
+            continue;
+
+          tile_x = state->width / 2 + x;
+          tile_y = state->height / 2 + y;
+          if (tile_x < 0 || tile_y < 0 ||
+              tile_x >= state->width || tile_y >= state->height)
+            continue;
+
+          state->tiles[tile_y * state->width + tile_x] |= TILE_KEEP;
+        }
+    }
+}
+
+static void
+destroy_state (gpointer ptr)
+{
+  ValidateState *self = ptr;
+
+  g_clear_pointer (&self->owners, g_free);
+  g_clear_pointer (&self->tiles, g_free);
+  g_free (self);
+}
+
+static void
+destroy_job (gpointer ptr)
+{
+  ValidateJob *self = ptr;
+
+  g_clear_pointer (&self->strokes, g_array_unref);
+  g_clear_pointer (&self->state, destroy_state);
+  g_clear_pointer (&self->diagnostics, g_array_unref);
+  g_clear_pointer (&self->problems, g_array_unref);
+  g_free (self);
+}
+
+static void
+clear_stroke_input (gpointer ptr)
+{
+  StrokeInput *self = ptr;
+
+  g_clear_pointer (&self->instances, g_array_unref);
+}
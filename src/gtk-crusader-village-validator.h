@@ -0,0 +1,59 @@
+/* gtk-crusader-village-validator.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#include "gtk-crusader-village-map-handle.h"
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GCV_DIAGNOSTIC_OVERLAP       = 1 << 0,
+  GCV_DIAGNOSTIC_OUT_OF_BOUNDS = 1 << 1,
+  GCV_DIAGNOSTIC_INVALID_UNIT  = 1 << 2,
+  GCV_DIAGNOSTIC_KEEP_BLOCKED  = 1 << 3,
+  GCV_DIAGNOSTIC_EMPTY_STROKE  = 1 << 4,
+} GcvDiagnosticKind;
+
+GType gcv_diagnostic_kind_get_type (void);
+#define GCV_TYPE_DIAGNOSTIC_KIND (gcv_diagnostic_kind_get_type ())
+
+#define GCV_TYPE_DIAGNOSTIC (gcv_diagnostic_get_type ())
+
+G_DECLARE_FINAL_TYPE (GcvDiagnostic, gcv_diagnostic, GCV, DIAGNOSTIC, GObject)
+
+#define GCV_TYPE_VALIDATOR (gcv_validator_get_type ())
+
+G_DECLARE_FINAL_TYPE (GcvValidator, gcv_validator, GCV, VALIDATOR, GObject)
+
+GListModel *
+gcv_validator_get_diagnostics (GcvValidator *self);
+
+GcvDiagnosticKind
+gcv_validator_get_problems (GcvValidator *self,
+                            guint         position);
+
+char *
+gcv_diagnostic_kind_describe (GcvDiagnosticKind kinds);
+
+G_END_DECLS
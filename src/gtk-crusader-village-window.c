@@ -30,6 +30,7 @@
 #include "gtk-crusader-village-map.h"
 #include "gtk-crusader-village-theme-utils.h"
 #include "gtk-crusader-village-timeline-view.h"
+#include "gtk-crusader-village-validator.h"
 #include "gtk-crusader-village-window.h"
 
 struct _GcvWindow
@@ -40,16 +41,19 @@ struct _GcvWindow
 
   GcvItemStore *item_store;
   GListStore   *brush_store;
+  GListStore   *stamp_store;
   GcvMap       *map;
   GcvMapHandle *map_handle;
+  GcvValidator *validator;
 
   /* Template widgets */
-  GcvMapEditor       *map_editor;
-  GcvMapEditorStatus *map_editor_status;
-  GcvItemArea        *item_area;
-  GcvTimelineView    *timeline_view;
-  GcvBrushArea       *brush_area;
-  GtkWidget          *busy;
+  GcvMapEditorOverlay *overlay;
+  GcvMapEditor        *map_editor;
+  GcvMapEditorStatus  *map_editor_status;
+  GcvItemArea         *item_area;
+  GcvTimelineView     *timeline_view;
+  GcvBrushArea        *brush_area;
+  GtkWidget           *busy;
 };
 
 G_DEFINE_FINAL_TYPE (GcvWindow, gcv_window, GTK_TYPE_APPLICATION_WINDOW)
@@ -60,6 +64,7 @@ enum
 
   PROP_ITEM_STORE,
   PROP_BRUSH_STORE,
+  PROP_STAMP_STORE,
   PROP_MAP,
   PROP_SETTINGS,
   PROP_BUSY,
@@ -77,8 +82,10 @@ gcv_window_dispose (GObject *object)
   g_clear_object (&self->settings);
   g_clear_object (&self->item_store);
   g_clear_object (&self->brush_store);
+  g_clear_object (&self->stamp_store);
   g_clear_object (&self->map);
   g_clear_object (&self->map_handle);
+  g_clear_object (&self->validator);
 
   G_OBJECT_CLASS (gcv_window_parent_class)->dispose (object);
 }
@@ -99,6 +106,9 @@ gcv_window_get_property (GObject    *object,
     case PROP_BRUSH_STORE:
       g_value_set_object (value, self->brush_store);
       break;
+    case PROP_STAMP_STORE:
+      g_value_set_object (value, self->stamp_store);
+      break;
     case PROP_MAP:
       g_value_set_object (value, self->map);
       break;
@@ -139,6 +149,14 @@ gcv_window_set_property (GObject      *object,
           "brush-store", self->brush_store,
           NULL);
       break;
+    case PROP_STAMP_STORE:
+      g_clear_object (&self->stamp_store);
+      self->stamp_store = g_value_dup_object (value);
+      g_object_set (
+          self->overlay,
+          "stamp-store", self->stamp_store,
+          NULL);
+      break;
     case PROP_MAP:
       g_clear_object (&self->map);
       g_clear_object (&self->map_handle);
@@ -155,6 +173,10 @@ gcv_window_set_property (GObject      *object,
           self->timeline_view,
           "map-handle", self->map_handle,
           NULL);
+      g_object_set (
+          self->validator,
+          "map-handle", self->map_handle,
+          NULL);
       break;
     case PROP_SETTINGS:
       g_clear_object (&self->settings);
@@ -202,6 +224,14 @@ gcv_window_class_init (GcvWindowClass *klass)
           G_TYPE_LIST_STORE,
           G_PARAM_READWRITE);
 
+  props[PROP_STAMP_STORE] =
+      g_param_spec_object (
+          "stamp-store",
+          "Stamp Store",
+          "The stamp library for this window",
+          G_TYPE_LIST_STORE,
+          G_PARAM_READWRITE);
+
   props[PROP_MAP] =
       g_param_spec_object (
           "map",
@@ -236,6 +266,7 @@ gcv_window_class_init (GcvWindowClass *klass)
   g_type_ensure (GCV_TYPE_BRUSH_AREA);
 
   gtk_widget_class_set_template_from_resource (widget_class, "/am/kolunmi/Gcv/gtk-crusader-village-window.ui");
+  gtk_widget_class_bind_template_child (widget_class, GcvWindow, overlay);
   gtk_widget_class_bind_template_child (widget_class, GcvWindow, map_editor);
   gtk_widget_class_bind_template_child (widget_class, GcvWindow, map_editor_status);
   gtk_widget_class_bind_template_child (widget_class, GcvWindow, item_area);
@@ -258,16 +289,22 @@ gcv_window_init (GcvWindow *self)
       GCV_TYPE_MAP_HANDLE,
       "map", self->map,
       NULL);
+  self->validator = g_object_new (
+      GCV_TYPE_VALIDATOR,
+      "map-handle", self->map_handle,
+      NULL);
 
   g_object_set (
       self->map_editor,
       "map-handle", self->map_handle,
       "item-area", self->item_area,
       "brush-area", self->brush_area,
+      "diagnostics", gcv_validator_get_diagnostics (self->validator),
       NULL);
   g_object_set (
       self->timeline_view,
       "map-handle", self->map_handle,
+      "validator", self->validator,
       NULL);
 
   g_object_set (
@@ -294,6 +331,43 @@ gcv_window_redo (GcvWindow *self)
     gcv_map_handle_redo (self->map_handle);
 }
 
+void
+gcv_window_copy (GcvWindow *self)
+{
+  g_return_if_fail (GCV_IS_WINDOW (self));
+
+  gcv_map_editor_copy_cursor (self->map_editor);
+}
+
+void
+gcv_window_paste (GcvWindow *self)
+{
+  g_autoptr (GListModel) stamp = NULL;
+
+  g_return_if_fail (GCV_IS_WINDOW (self));
+
+  g_object_get (
+      self->map_editor,
+      "stamp", &stamp,
+      NULL);
+  if (stamp == NULL)
+    return;
+
+  g_object_set (
+      self->map_editor,
+      "tool", GCV_MAP_EDITOR_TOOL_STAMP,
+      NULL);
+}
+
+void
+gcv_window_compact (GcvWindow *self)
+{
+  g_return_if_fail (GCV_IS_WINDOW (self));
+
+  if (self->map != NULL)
+    gcv_map_handle_compact (self->map_handle);
+}
+
 void
 gcv_window_add_subwindow_viewport (GcvWindow *self)
 {
@@ -318,6 +392,7 @@ gcv_window_add_subwindow_viewport (GcvWindow *self)
   g_object_bind_property (self->map_editor, "map-handle", editor, "map-handle", G_BINDING_SYNC_CREATE);
   g_object_bind_property (self->map_editor, "item-area", editor, "item-area", G_BINDING_SYNC_CREATE);
   g_object_bind_property (self->map_editor, "brush-area", editor, "brush-area", G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self->map_editor, "diagnostics", editor, "diagnostics", G_BINDING_SYNC_CREATE);
   gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (scrolled_window), GTK_WIDGET (editor));
 
   g_object_set (
@@ -34,6 +34,15 @@ gcv_window_undo (GcvWindow *self);
 void
 gcv_window_redo (GcvWindow *self);
 
+void
+gcv_window_copy (GcvWindow *self);
+
+void
+gcv_window_paste (GcvWindow *self);
+
+void
+gcv_window_compact (GcvWindow *self);
+
 void
 gcv_window_add_subwindow_viewport (GcvWindow *self);
 
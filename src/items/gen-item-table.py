@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+#
+# gen-item-table.py
+#
+# Copyright 2025 Adam Masciola
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+# Compiles the item specs in this directory into a static C table so
+# the item store doesn't have to parse GVariant text at startup.
+#
+# usage: gen-item-table.py OUTPUT SPEC...
+
+import json
+import os
+import re
+import sys
+
+STRING_KEYS = [
+    'name',
+    'description',
+    'thumbnail-resource',
+    'section-icon-resource',
+    'tile-resource',
+]
+
+# Missing keys fall back to the GcvItem property defaults
+INT_KEYS = {
+    'id': 0,
+    'tile-width': 1,
+    'tile-height': 1,
+    'tile-offset-x': 0,
+    'tile-offset-y': 0,
+    'tile-impassable-rect-x': 0,
+    'tile-impassable-rect-y': 0,
+    'tile-impassable-rect-w': 0,
+    'tile-impassable-rect-h': 0,
+}
+
+KINDS = [
+    'building',
+    'unit',
+    'wall',
+    'gatehouse-ns',
+    'gatehouse-ew',
+    'moat',
+]
+
+ENTRY_RE = re.compile(r'^\s*"([a-z-]+)"\s*:\s*<(.*)>\s*,?\s*$')
+
+
+def fail(path, message):
+    sys.exit(f'{path}: {message}')
+
+
+def parse_spec(path):
+    spec = {}
+
+    with open(path, encoding='utf-8') as f:
+        for line in f:
+            line = line.strip()
+            if line in ('', '{', '}'):
+                continue
+
+            match = ENTRY_RE.match(line)
+            if match is None:
+                fail(path, f'cannot parse line: {line}')
+
+            key, value = match.groups()
+            if key in spec:
+                fail(path, f'duplicate key {key}')
+
+            if key in STRING_KEYS or key == 'kind':
+                if not value.startswith('"'):
+                    fail(path, f'{key} must be a string')
+                spec[key] = json.loads(value)
+            elif key in INT_KEYS:
+                try:
+                    spec[key] = int(value, 0)
+                except ValueError:
+                    fail(path, f'{key} must be an int32')
+            else:
+                fail(path, f'unknown key {key}')
+
+    if 'id' not in spec:
+        fail(path, 'missing id')
+
+    kind = spec.get('kind', 'building')
+    if kind not in KINDS:
+        fail(path, f'unknown kind {kind}')
+    for key in INT_KEYS:
+        if not -2**31 <= spec.get(key, 0) < 2**31:
+            fail(path, f'{key} must be an int32')
+
+    return spec
+
+
+def c_string(value):
+    if value is None:
+        return 'NULL'
+
+    out = '"'
+    for byte in value.encode('utf-8'):
+        char = chr(byte)
+        if char in '"\\':
+            out += '\\' + char
+        elif 0x20 <= byte < 0x7f:
+            out += char
+        else:
+            out += f'\\{byte:03o}'
+    return out + '"'
+
+
+def main():
+    output = sys.argv[1]
+    specs = sorted(sys.argv[2:], key=os.path.basename)
+
+    lines = [
+        '/* Generated by gen-item-table.py, do not edit */',
+        '',
+        '#pragma once',
+        '',
+        '#include "gtk-crusader-village-item.h"',
+        '',
+        'typedef struct',
+        '{',
+        '  int         id;',
+        '  const char *name;',
+        '  const char *description;',
+        '  const char *thumbnail_resource;',
+        '  const char *section_icon_resource;',
+        '  const char *tile_resource;',
+        '  GcvItemKind kind;',
+        '  int         tile_width;',
+        '  int         tile_height;',
+        '  int         tile_offset_x;',
+        '  int         tile_offset_y;',
+        '  int         tile_impassable_rect_x;',
+        '  int         tile_impassable_rect_y;',
+        '  int         tile_impassable_rect_w;',
+        '  int         tile_impassable_rect_h;',
+        '} GcvItemTableEntry;',
+        '',
+        'static const GcvItemTableEntry gcv_item_table[] = {',
+    ]
+
+    for path in specs:
+        spec = parse_spec(path)
+
+        kind = 'GCV_ITEM_KIND_' + spec.get('kind', 'building').upper().replace('-', '_')
+        fields = [str(spec['id'])]
+        fields += [c_string(spec.get(key)) for key in STRING_KEYS]
+        fields += [kind]
+        fields += [str(spec.get(key, INT_KEYS[key])) for key in list(INT_KEYS)[1:]]
+
+        lines.append(f'  /* {os.path.basename(path)} */')
+        lines.append('  { ' + ', '.join(fields) + ' },')
+
+    lines.append('};')
+    lines.append('')
+
+    with open(output, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(lines))
+
+
+if __name__ == '__main__':
+    main()